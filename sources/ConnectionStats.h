@@ -0,0 +1,87 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef CONNECTIONSTATS_H
+#define CONNECTIONSTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace rcp
+{
+
+    /* counters of a server connection.
+     * base of every websocketpp server connection (see WebsocketConfig.h),
+     * updated on the io thread and read from the main thread.
+     */
+    class ConnectionStats
+    {
+    public:
+        std::atomic<uint64_t> bytesIn{0};
+        std::atomic<uint64_t> bytesOut{0};
+        std::atomic<uint64_t> messagesIn{0};
+        std::atomic<uint64_t> messagesOut{0};
+        // last ping round trip in microseconds - -1: not measured yet
+        std::atomic<int64_t> rtt{-1};
+        // last time anything was received in microseconds (keepalive)
+        std::atomic<int64_t> lastSeen{0};
+        // counted against the client limit (admission control)
+        std::atomic<bool> admitted{false};
+        std::chrono::steady_clock::time_point openTime;
+    };
+
+    // snapshot of a connection for output
+    struct ConnectionInfo
+    {
+        std::string address;
+        // milliseconds - negative: not measured yet
+        double rtt{-1};
+        uint64_t bytesIn{0};
+        uint64_t bytesOut{0};
+        uint64_t messagesIn{0};
+        uint64_t messagesOut{0};
+        // queued for sending, not yet written to the socket
+        size_t buffered{0};
+        // seconds since the connection opened
+        double connected{0};
+    };
+
+}
+
+#endif // CONNECTIONSTATS_H
@@ -49,12 +49,18 @@ namespace rcp
 {
     class ParameterServer;
     class ParameterClient;
+    class ParameterRelay;
+    class ParameterReceive;
+    class ParameterSend;
+    class ServerParameter;
     class PdWebsocketServer;
     class PdWebsocketClient;
+    class PdRabbitholeRelay;
     class RcpDebug;
     class RcpFormat;
     class RcpParse;
     class SizePrefixer;
+    class SizePrefixParser;
     class SPPParser;
     class SlipDecoder;
     class SlipEncoder;
@@ -66,14 +72,20 @@ namespace rcp
         // call the objects' setup routines
         FLEXT_SETUP(ParameterServer);
         FLEXT_SETUP(ParameterClient);
+        FLEXT_SETUP(ParameterRelay);
+        FLEXT_SETUP(ParameterReceive);
+        FLEXT_SETUP(ParameterSend);
+        FLEXT_SETUP(ServerParameter);
         FLEXT_SETUP(RcpDebug);
         FLEXT_SETUP(RcpFormat);
         FLEXT_SETUP(RcpParse);
 
         FLEXT_SETUP(PdWebsocketServer);
         FLEXT_SETUP(PdWebsocketClient);
+        FLEXT_SETUP(PdRabbitholeRelay);
 
         FLEXT_SETUP(SizePrefixer);
+        FLEXT_SETUP(SizePrefixParser);
         FLEXT_SETUP(SPPParser);
         FLEXT_SETUP(SlipDecoder);
         FLEXT_SETUP(SlipEncoder);
@@ -55,6 +55,11 @@ namespace rcp
         virtual void close() = 0;
         virtual void pushData(char* /*data*/, size_t /*size*/) const {}
 
+        // stop all calls into rcp_client and the listener without
+        // blocking on network threads. returns true if the transporter
+        // may then be destroyed on any thread (see Reaper).
+        virtual bool detach() { return false; }
+
     };
 
 }
@@ -39,9 +39,12 @@
 #define ISERVERTRANSPORTER_H
 
 #include <cstdint>
+#include <vector>
 
 #include <rcp_server_transporter.h>
 
+#include "ConnectionStats.h"
+
 namespace rcp
 {
     class ParameterServer;
@@ -57,6 +60,18 @@ namespace rcp
         virtual void pushData(char* /*data*/, size_t /*size*/) const {}
         virtual uint16_t port() const = 0;
         virtual bool isListening() const = 0;
+
+        // stop all calls into rcp_server and the listener without
+        // blocking on network threads. returns true if the transporter
+        // may then be destroyed on any thread (see Reaper).
+        virtual bool detach() { return false; }
+
+        // per client counters - appends one entry per connection
+        virtual void stats(std::vector<ConnectionInfo>& /*out*/) {}
+        // measure round trip times - show up in the next stats
+        virtual void ping() {}
+        // connections refused by admission control
+        virtual void rejected(uint64_t& full, uint64_t& limited) const { full = 0; limited = 0; }
     };
 
 }
@@ -0,0 +1,321 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef MESSAGEPOOL_H
+#define MESSAGEPOOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <websocketpp/common/memory.hpp>
+#include <websocketpp/frame.hpp>
+
+// payload size classes of pooled messages
+#ifndef RCP_MSG_POOL_SMALL
+#define RCP_MSG_POOL_SMALL 512
+#endif
+#ifndef RCP_MSG_POOL_MEDIUM
+#define RCP_MSG_POOL_MEDIUM 8192
+#endif
+#ifndef RCP_MSG_POOL_LARGE
+#define RCP_MSG_POOL_LARGE 65536
+#endif
+
+// max free messages kept per size class
+#ifndef RCP_MSG_POOL_DEPTH
+#define RCP_MSG_POOL_DEPTH 64
+#endif
+
+namespace rcp
+{
+
+    /* free list of fixed size blocks
+     * one per type - used for the shared_ptr control blocks of pooled messages
+     */
+    template <typename T>
+    class BlockFreeList
+    {
+    public:
+        static BlockFreeList& instance()
+        {
+            // NOTE: never destroyed - blocks may be returned during static destruction
+            static BlockFreeList* list = new BlockFreeList();
+            return *list;
+        }
+
+        void* get()
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (!m_blocks.empty())
+                {
+                    void* block = m_blocks.back();
+                    m_blocks.pop_back();
+                    return block;
+                }
+            }
+
+            return ::operator new(sizeof(T));
+        }
+
+        void put(void* block)
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (m_blocks.size() < m_blocks.capacity())
+                {
+                    m_blocks.push_back(block);
+                    return;
+                }
+            }
+
+            ::operator delete(block);
+        }
+
+    private:
+        BlockFreeList()
+        {
+            m_blocks.reserve(RCP_MSG_POOL_DEPTH * 3);
+        }
+
+        std::mutex m_lock;
+        std::vector<void*> m_blocks;
+    };
+
+    template <typename T>
+    struct BlockAllocator
+    {
+        typedef T value_type;
+
+        BlockAllocator() {}
+        template <typename U> BlockAllocator(const BlockAllocator<U>&) {}
+
+        T* allocate(std::size_t n)
+        {
+            if (n != 1)
+            {
+                return static_cast<T*>(::operator new(n * sizeof(T)));
+            }
+            return static_cast<T*>(BlockFreeList<T>::instance().get());
+        }
+
+        void deallocate(T* p, std::size_t n)
+        {
+            if (n != 1)
+            {
+                ::operator delete(p);
+                return;
+            }
+            BlockFreeList<T>::instance().put(p);
+        }
+    };
+
+    template <typename T, typename U>
+    bool operator==(const BlockAllocator<T>&, const BlockAllocator<U>&) { return true; }
+    template <typename T, typename U>
+    bool operator!=(const BlockAllocator<T>&, const BlockAllocator<U>&) { return false; }
+
+
+    /* recycles websocketpp messages in three payload size classes.
+     * a released message keeps the capacity of its payload, so
+     * steady receive and send traffic does not allocate.
+     * messages bigger than the largest class are not pooled.
+     */
+    template <typename message>
+    class MessagePool
+    {
+    public:
+        typedef typename message::ptr message_ptr;
+        typedef typename message::con_msg_man_ptr con_msg_man_ptr;
+
+        static MessagePool& instance()
+        {
+            // NOTE: never destroyed - messages may be released during static destruction
+            static MessagePool* pool = new MessagePool();
+            return *pool;
+        }
+
+        message_ptr get(con_msg_man_ptr manager, websocketpp::frame::opcode::value op, size_t size)
+        {
+            int cls = sizeClass(size);
+            if (cls < 0)
+            {
+                return websocketpp::lib::make_shared<message>(manager, op, size);
+            }
+
+            message* msg = nullptr;
+
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (!m_free[cls].empty())
+                {
+                    msg = m_free[cls].back();
+                    m_free[cls].pop_back();
+                }
+            }
+
+            if (msg)
+            {
+                reset(msg, op);
+            }
+            else
+            {
+                msg = new message(manager, op, classSize(cls));
+            }
+
+            return message_ptr(msg, recycler(this, cls), BlockAllocator<message>());
+        }
+
+    private:
+        struct recycler
+        {
+            recycler(MessagePool* p, int c) : pool(p), cls(c) {}
+
+            void operator()(message* msg) const
+            {
+                pool->release(msg, cls);
+            }
+
+            MessagePool* pool;
+            int cls;
+        };
+
+        MessagePool()
+        {
+            for (int i=0; i<3; i++)
+            {
+                m_free[i].reserve(RCP_MSG_POOL_DEPTH);
+            }
+        }
+
+        static int sizeClass(size_t size)
+        {
+            if (size <= RCP_MSG_POOL_SMALL) return 0;
+            if (size <= RCP_MSG_POOL_MEDIUM) return 1;
+            if (size <= RCP_MSG_POOL_LARGE) return 2;
+            return -1;
+        }
+
+        static size_t classSize(int cls)
+        {
+            static const size_t sizes[3] = { RCP_MSG_POOL_SMALL, RCP_MSG_POOL_MEDIUM, RCP_MSG_POOL_LARGE };
+            return sizes[cls];
+        }
+
+        static void reset(message* msg, websocketpp::frame::opcode::value op)
+        {
+            msg->get_raw_payload().clear();
+            msg->set_header(std::string());
+            msg->set_opcode(op);
+            msg->set_prepared(false);
+            msg->set_fin(true);
+            msg->set_compressed(false);
+            msg->set_terminal(false);
+        }
+
+        void release(message* msg, int cls)
+        {
+            // do not keep payloads which grew far beyond their class
+            if (msg->get_raw_payload().capacity() <= 2 * classSize(cls))
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (m_free[cls].size() < RCP_MSG_POOL_DEPTH)
+                {
+                    m_free[cls].push_back(msg);
+                    return;
+                }
+            }
+
+            delete msg;
+        }
+
+    private:
+        std::mutex m_lock;
+        std::vector<message*> m_free[3];
+    };
+
+
+    /* websocketpp con_msg_manager handing out pooled messages
+     * drop-in for websocketpp::message_buffer::alloc::con_msg_manager
+     */
+    template <typename message>
+    class pooled_con_msg_manager
+            : public websocketpp::lib::enable_shared_from_this<pooled_con_msg_manager<message> >
+    {
+    public:
+        typedef pooled_con_msg_manager<message> type;
+        typedef websocketpp::lib::shared_ptr<pooled_con_msg_manager> ptr;
+        typedef websocketpp::lib::weak_ptr<pooled_con_msg_manager> weak_ptr;
+
+        typedef typename message::ptr message_ptr;
+
+        message_ptr get_message()
+        {
+            return message_ptr(websocketpp::lib::make_shared<message>(type::shared_from_this()));
+        }
+
+        message_ptr get_message(websocketpp::frame::opcode::value op, size_t size)
+        {
+            return MessagePool<message>::instance().get(type::shared_from_this(), op, size);
+        }
+
+        bool recycle(message* /*msg*/)
+        {
+            // pooled messages are returned by their deleter
+            return false;
+        }
+    };
+
+    // one manager per connection - the pool is shared
+    template <typename con_msg_manager>
+    class pooled_endpoint_msg_manager
+    {
+    public:
+        typedef typename con_msg_manager::ptr con_msg_man_ptr;
+
+        con_msg_man_ptr get_manager() const
+        {
+            return con_msg_man_ptr(websocketpp::lib::make_shared<con_msg_manager>());
+        }
+    };
+
+}
+
+#endif // MESSAGEPOOL_H
@@ -0,0 +1,120 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "ParameterBinding.h"
+
+#include <rcp_parameter.h>
+#include <rcp_typedefinition.h>
+
+namespace rcp
+{
+
+    void ParameterBinding::addValueMethods()
+    {
+        FLEXT_ADDBANG(0, m_bang);
+        FLEXT_ADDMETHOD(0, m_float);
+        FLEXT_ADDMETHOD(0, m_symbol);
+    }
+
+    // input
+
+    void ParameterBinding::m_bang()
+    {
+        // host checks the type
+        if (m_parameter)
+        {
+            sendBang();
+        }
+    }
+
+    void ParameterBinding::m_float(float f)
+    {
+        t_atom atom;
+        SetFloat(atom, f);
+        _send(atom);
+    }
+
+    void ParameterBinding::m_symbol(const t_symbol* s)
+    {
+        t_atom atom;
+        SetSymbol(atom, s);
+        _send(atom);
+    }
+
+    void ParameterBinding::_send(t_atom& atom)
+    {
+        if (m_parameter == nullptr)
+        {
+            // not bound (yet)
+            return;
+        }
+
+        sendValue(atom);
+    }
+
+    // output
+
+    void ParameterBinding::outputValue(rcp_parameter* parameter)
+    {
+        rcp_datatype type = rcp_typedefinition_get_type_id(rcp_parameter_get_typedefinition(parameter));
+
+        switch (type)
+        {
+        case DATATYPE_BOOLEAN:
+            ToOutInt(0, rcp_parameter_get_value_bool(RCP_VALUE_PARAMETER(parameter)) ? 1 : 0);
+            break;
+        case DATATYPE_INT32:
+            ToOutInt(0, rcp_parameter_get_value_int32(RCP_VALUE_PARAMETER(parameter)));
+            break;
+        case DATATYPE_FLOAT32:
+            ToOutFloat(0, rcp_parameter_get_value_float(RCP_VALUE_PARAMETER(parameter)));
+            break;
+        case DATATYPE_STRING:
+        {
+            const char* value = rcp_parameter_get_value_string(RCP_VALUE_PARAMETER(parameter));
+            ToOutSymbol(0, MakeSymbol(value != NULL ? value : ""));
+            break;
+        }
+        case DATATYPE_BANG:
+            ToOutBang(0);
+            break;
+        default:
+            break;
+        }
+    }
+
+}
@@ -0,0 +1,92 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef PARAMETERBINDING_H
+#define PARAMETERBINDING_H
+
+#include <atomic>
+
+#include <flext.h>
+
+#include <rcp_parameter_type.h>
+
+namespace rcp
+{
+
+    /* base for objects bound to a single parameter
+     * ([rcp.param], [rcp.send], [rcp.receive]).
+     * converts bang, float and symbol input into values for the host
+     * and outputs values on outlet 0.
+     */
+    class ParameterBinding : public flext_base
+    {
+        FLEXT_HEADER(ParameterBinding, flext_base)
+
+    public:
+        rcp_parameter* parameter() const { return m_parameter; }
+
+    protected:
+        // bang, float and symbol on inlet 0
+        void addValueMethods();
+
+        // hand input to the host - only called while bound
+        virtual void sendValue(t_atom& atom) = 0;
+        // host ignores it for non-bang parameters
+        virtual void sendBang() = 0;
+
+        // current value to outlet 0
+        void outputValue(rcp_parameter* parameter);
+
+        void m_bang();
+        void m_float(float f);
+        void m_symbol(const t_symbol* s);
+
+    protected:
+        // NOTE: client bindings get bound on the network thread
+        std::atomic<rcp_parameter*> m_parameter{nullptr};
+
+    private:
+        FLEXT_CALLBACK(m_bang)
+        FLEXT_CALLBACK_F(m_float)
+        FLEXT_CALLBACK_S(m_symbol)
+
+        void _send(t_atom& atom);
+    };
+
+}
+
+#endif // PARAMETERBINDING_H
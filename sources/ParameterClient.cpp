@@ -38,13 +38,19 @@
 #include "ParameterClient.h"
 
 #include <vector>
+#include <algorithm>
 
 #include <rcp_parameter.h>
 #include <rcp_typedefinition.h>
 #include <rcp_logging.h>
+#include <rcp_manager.h>
 
 #include "WebsocketClientTransporter.h"
 #include "PdClientTransporter.h"
+#include "ShmClientTransporter.h"
+#include "TcpClientTransporter.h"
+#include "ParameterClientBinding.h"
+#include "Reaper.h"
 
 namespace rcp
 {
@@ -93,7 +99,19 @@ namespace rcp
         , m_client(nullptr)
         , m_transporter(nullptr)
     {
+        // [rcp.client] - client without name
+        // [rcp.client symbol] - client with name "symbol" for [rcp.receive] and [rcp.send]
+        //
+        // option symbol: -raw - creates a raw-transporter
+        // option symbol: -poll - no network threads, io is polled from the scheduler
+        // option symbol: -shm - connect to a server on this machine via shared memory
+        //      open with the name of the server's shm segment
+        // option symbol: -tcp - plain tcp with size prefixed frames, open with host:port
+
         bool is_raw = false;
+        bool is_polled = false;
+        bool is_shm = false;
+        bool is_tcp = false;
 
         for (int i=0; i<argc; i++)
         {
@@ -104,6 +122,29 @@ namespace rcp
                     is_raw = true;
                     continue;
                 }
+
+                if (std::string(GetString(argv[i])) == "-poll")
+                {
+                    is_polled = true;
+                    continue;
+                }
+
+                if (std::string(GetString(argv[i])) == "-shm")
+                {
+                    is_shm = true;
+                    continue;
+                }
+
+                if (std::string(GetString(argv[i])) == "-tcp")
+                {
+                    is_tcp = true;
+                    continue;
+                }
+
+                if (m_name == nullptr)
+                {
+                    m_name = GetSymbol(argv[i]);
+                }
             }
         }
 
@@ -117,9 +158,17 @@ namespace rcp
 
             m_transporter = new PdClientTransporter(this);
         }
+        else if (is_shm)
+        {
+            m_transporter = new ShmClientTransporter(this);
+        }
+        else if (is_tcp)
+        {
+            m_transporter = new TcpClientTransporter(this, is_polled);
+        }
         else
         {
-            m_transporter = new WebsocketClientTransporter(this);
+            m_transporter = new WebsocketClientTransporter(this, is_polled);
         }
 
         if (m_transporter)
@@ -136,10 +185,47 @@ namespace rcp
                 rcp_client_set_parameter_removed_cb(m_client, client_parameter_removed_cb);
             }
         }
+
+        if (m_name)
+        {
+            if (ClientRegistry::addHost(m_name, this))
+            {
+                for (ParameterClientBinding* binding : ClientRegistry::bindings(m_name))
+                {
+                    addBinding(binding);
+                }
+            }
+            else
+            {
+                error("rcp.client: name '%s' is already in use", GetString(m_name));
+                m_name = nullptr;
+            }
+        }
     }
 
     ParameterClient::~ParameterClient()
     {
+        if (m_name)
+        {
+            ClientRegistry::removeHost(m_name, this);
+        }
+
+        {
+            // NOTE: not held while detaching, a running callback may wait for it
+            std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+            for (auto& it : m_bindingsByPath)
+            {
+                it.second->detach();
+            }
+            m_bindings.clear();
+            m_bindingsByPath.clear();
+            m_bindingsById.clear();
+        }
+
+        // stop callbacks before the client goes away
+        bool detached = m_transporter && m_transporter->detach();
+
         if (m_client)
         {
             rcp_client_free(m_client);
@@ -148,7 +234,15 @@ namespace rcp
 
         if (m_transporter)
         {
-            delete m_transporter;
+            if (detached)
+            {
+                // network threads finish shutting down in the background
+                Reaper::dispose(std::shared_ptr<IClientTransporter>(m_transporter));
+            }
+            else
+            {
+                delete m_transporter;
+            }
             m_transporter = nullptr;
         }
     }
@@ -177,6 +271,121 @@ namespace rcp
         }
     }
 
+    // udp
+
+    void ParameterClient::setUdp(const bool& b)
+    {
+        // applies on next connect
+        WebsocketClientTransporter* transporter = dynamic_cast<WebsocketClientTransporter*>(m_transporter);
+        if (transporter)
+        {
+            transporter->setUdp(b);
+        }
+    }
+
+    void ParameterClient::getUdp(bool& b)
+    {
+        WebsocketClientTransporter* transporter = dynamic_cast<WebsocketClientTransporter*>(m_transporter);
+        b = transporter && transporter->udp();
+    }
+
+
+
+    // socket options
+
+    void ParameterClient::setNodelay(const bool& b)
+    {
+        m_socketOptions.noDelay = b;
+        applySocketOptions();
+    }
+
+    void ParameterClient::getNodelay(bool& b)
+    {
+        b = m_socketOptions.noDelay;
+    }
+
+    void ParameterClient::setSndbuf(const int& i)
+    {
+        m_socketOptions.sendBuffer = i > 0 ? i : 0;
+        applySocketOptions();
+    }
+
+    void ParameterClient::getSndbuf(int& i)
+    {
+        i = m_socketOptions.sendBuffer;
+    }
+
+    void ParameterClient::setRcvbuf(const int& i)
+    {
+        m_socketOptions.receiveBuffer = i > 0 ? i : 0;
+        applySocketOptions();
+    }
+
+    void ParameterClient::getRcvbuf(int& i)
+    {
+        i = m_socketOptions.receiveBuffer;
+    }
+
+    void ParameterClient::setTos(const int& i)
+    {
+        if (i < 0 || i > 255)
+        {
+            error("invalid tos: %d", i);
+            return;
+        }
+
+        m_socketOptions.tos = i;
+        applySocketOptions();
+    }
+
+    void ParameterClient::getTos(int& i)
+    {
+        i = m_socketOptions.tos;
+    }
+
+    // keepalive
+
+    void ParameterClient::setPingInterval(const float& f)
+    {
+        m_pingInterval = f > 0 ? f : 0;
+        applyKeepalive();
+    }
+
+    void ParameterClient::getPingInterval(float& f)
+    {
+        f = m_pingInterval;
+    }
+
+    void ParameterClient::setPingTimeout(const float& f)
+    {
+        m_pingTimeout = f > 0 ? f : 0;
+        applyKeepalive();
+    }
+
+    void ParameterClient::getPingTimeout(float& f)
+    {
+        f = m_pingTimeout;
+    }
+
+    void ParameterClient::applyKeepalive()
+    {
+        WebsocketClientTransporter* transporter = dynamic_cast<WebsocketClientTransporter*>(m_transporter);
+        if (transporter)
+        {
+            transporter->setKeepalive(uint32_t(m_pingInterval * 1000), uint32_t(m_pingTimeout * 1000));
+        }
+    }
+
+    void ParameterClient::applySocketOptions()
+    {
+        // applies on next connect
+        WebsocketClientTransporter* transporter = dynamic_cast<WebsocketClientTransporter*>(m_transporter);
+        if (transporter)
+        {
+            transporter->setSocketOptions(m_socketOptions);
+        }
+    }
+
 
 
     void ParameterClient::parameterAdded(rcp_parameter* parameter)
@@ -262,6 +471,27 @@ namespace rcp
 
         ToOutInt(1, id);
         ToOutList(0, i, list.data());
+
+        // resolve bindings waiting for this parameter
+        if (type != DATATYPE_GROUP)
+        {
+            std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+            std::vector<ParameterClientBinding*> waiting;
+            auto range = m_bindingsByPath.equal_range(pathKey(parameter));
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                waiting.push_back(it->second);
+            }
+
+            for (ParameterClientBinding* binding : waiting)
+            {
+                if (isAttached(binding))
+                {
+                    bindParameter(binding, parameter);
+                }
+            }
+        }
     }
 
     void ParameterClient::parameterRemoved(rcp_parameter* parameter)
@@ -269,6 +499,26 @@ namespace rcp
         const char* label = rcp_parameter_get_label(parameter);
         uint16_t id = rcp_parameter_get_id(parameter);
 
+        {
+            std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+            auto bound = m_bindingsById.find(id);
+            if (bound != m_bindingsById.end())
+            {
+                std::vector<ParameterClientBinding*> bindings;
+                bindings.swap(bound->second);
+                m_bindingsById.erase(bound);
+
+                for (ParameterClientBinding* binding : bindings)
+                {
+                    if (isAttached(binding))
+                    {
+                        binding->unbound();
+                    }
+                }
+            }
+        }
+
         // get the parents
         std::vector<std::string> groups = getParents(parameter);
 
@@ -297,6 +547,179 @@ namespace rcp
     }
 
 
+    void ParameterClient::outputUpdate(rcp_parameter* parameter)
+    {
+        ParameterServerClientBase::outputUpdate(parameter);
+
+        std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+        auto bound = m_bindingsById.find(rcp_parameter_get_id(parameter));
+        if (bound == m_bindingsById.end())
+        {
+            return;
+        }
+
+        // NOTE: copy - polled, an output may add or remove bindings
+        std::vector<ParameterClientBinding*> bindings = bound->second;
+        for (ParameterClientBinding* binding : bindings)
+        {
+            if (isAttached(binding) &&
+                    binding->parameter() == parameter)
+            {
+                binding->valueUpdated(parameter);
+            }
+        }
+    }
+
+    // bindings
+
+    void ParameterClient::addBinding(ParameterClientBinding* binding)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+        binding->attach(this);
+        m_bindings.insert(binding);
+        m_bindingsByPath.insert(std::make_pair(binding->path(), binding));
+
+        if (m_manager == nullptr)
+        {
+            return;
+        }
+
+        // resolve path now if parameter is already known
+        rcp_parameter* parameter = nullptr;
+        rcp_group_parameter* last_group = nullptr;
+
+        for (const std::string& part : binding->pathParts())
+        {
+            parameter = rcp_manager_find_parameter(m_manager, part.c_str(), last_group);
+            if (parameter == nullptr)
+            {
+                return;
+            }
+
+            if (rcp_parameter_is_group(parameter))
+            {
+                last_group = RCP_GROUP_PARAMETER(parameter);
+            }
+        }
+
+        if (parameter &&
+                !rcp_parameter_is_group(parameter))
+        {
+            bindParameter(binding, parameter);
+        }
+    }
+
+    void ParameterClient::removeBinding(ParameterClientBinding* binding)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+        m_bindings.erase(binding);
+
+        auto range = m_bindingsByPath.equal_range(binding->path());
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second == binding)
+            {
+                m_bindingsByPath.erase(it);
+                break;
+            }
+        }
+
+        if (binding->parameter())
+        {
+            auto bound = m_bindingsById.find(rcp_parameter_get_id(binding->parameter()));
+            if (bound != m_bindingsById.end())
+            {
+                std::vector<ParameterClientBinding*>& list = bound->second;
+                list.erase(std::remove(list.begin(), list.end(), binding), list.end());
+
+                if (list.empty())
+                {
+                    m_bindingsById.erase(bound);
+                }
+            }
+        }
+
+        binding->detach();
+    }
+
+    void ParameterClient::sendValue(ParameterClientBinding* binding, t_atom& atom)
+    {
+        // NOTE: the network thread may unbind and free the parameter meanwhile
+        std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+        rcp_parameter* parameter = binding->parameter();
+        if (parameter &&
+                setValue(parameter, atom))
+        {
+            updateManager();
+        }
+    }
+
+    void ParameterClient::sendBang(ParameterClientBinding* binding)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+        rcp_parameter* parameter = binding->parameter();
+        if (parameter &&
+                rcp_parameter_is_type(parameter, DATATYPE_BANG))
+        {
+            rcp_manager_set_dirty(m_manager, parameter);
+            updateManager();
+        }
+    }
+
+    std::string ParameterClient::pathKey(rcp_parameter* parameter)
+    {
+        std::vector<std::string> groups = getParents(parameter);
+        const char* label = rcp_parameter_get_label(parameter);
+
+        std::string key;
+        for (std::vector<std::string>::reverse_iterator rit = groups.rbegin();
+            rit != groups.rend(); ++rit)
+        {
+            key += *rit;
+            key += "/";
+        }
+        key += (label != NULL ? label : "");
+
+        return key;
+    }
+
+    // NOTE: binding lock held
+    void ParameterClient::bindParameter(ParameterClientBinding* binding, rcp_parameter* parameter)
+    {
+        m_bindingsById[rcp_parameter_get_id(parameter)].push_back(binding);
+        binding->bound(parameter);
+    }
+
+    void ParameterClient::unbindAll()
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+        std::unordered_map<int16_t, std::vector<ParameterClientBinding*> > bound;
+        bound.swap(m_bindingsById);
+
+        for (auto& it : bound)
+        {
+            for (ParameterClientBinding* binding : it.second)
+            {
+                if (isAttached(binding))
+                {
+                    binding->unbound();
+                }
+            }
+        }
+    }
+
+    // NOTE: binding lock held. does not touch the binding, it may be gone
+    bool ParameterClient::isAttached(ParameterClientBinding* binding) const
+    {
+        return m_bindings.count(binding) > 0;
+    }
+
     // IWebsocketClientListener
     void ParameterClient::connected()
     {
@@ -305,6 +728,7 @@ namespace rcp
 
     void ParameterClient::failed(uint16_t code)
     {
+        unbindAll();
         ToOutInt(2, 0);
     }
 
@@ -314,6 +738,7 @@ namespace rcp
         // client manager was re-created: get the new one
 //        m_manager = client_get_manager(m_client);
 
+        unbindAll();
         ToOutInt(2, 0);
     }
 
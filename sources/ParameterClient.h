@@ -38,14 +38,22 @@
 #ifndef PARAMETERCLIENT_H
 #define PARAMETERCLIENT_H
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include <rcp_client.h>
 
 #include "ParameterServerClientBase.h"
 #include "IClientTransporter.h"
 #include "websocketClient.h"
+#include "SocketOptions.h"
 
 namespace rcp
 {
+    class ParameterClientBinding;
 
     class ParameterClient : public ParameterServerClientBase, public IWebsocketClientListener
     {
@@ -58,6 +66,12 @@ namespace rcp
         void parameterAdded(rcp_parameter* parameter);
         void parameterRemoved(rcp_parameter* parameter);
 
+        // bindings: [rcp.receive] / [rcp.send]
+        void addBinding(ParameterClientBinding* binding);
+        void removeBinding(ParameterClientBinding* binding);
+        void sendValue(ParameterClientBinding* binding, t_atom& atom);
+        void sendBang(ParameterClientBinding* binding);
+
     public:
         // IWebsocketClientListener
         void connected() override;
@@ -71,20 +85,90 @@ namespace rcp
         {            
             FLEXT_CADDMETHOD_(c, 0, "open", m_open);
             FLEXT_CADDMETHOD_(c, 0, "close", m_close);
+            FLEXT_CADDATTR_VAR(c, "coalesce", getCoalesce, setCoalesce);
+            FLEXT_CADDATTR_VAR(c, "udp", getUdp, setUdp);
+            // socket options
+            FLEXT_CADDATTR_VAR(c, "nodelay", getNodelay, setNodelay);
+            FLEXT_CADDATTR_VAR(c, "sndbuf", getSndbuf, setSndbuf);
+            FLEXT_CADDATTR_VAR(c, "rcvbuf", getRcvbuf, setRcvbuf);
+            FLEXT_CADDATTR_VAR(c, "tos", getTos, setTos);
+            // keepalive
+            FLEXT_CADDATTR_VAR(c, "ping_interval", getPingInterval, setPingInterval);
+            FLEXT_CADDATTR_VAR(c, "ping_timeout", getPingTimeout, setPingTimeout);
         }
 
         void handle_raw_data(char* /*data*/, size_t /*size*/) override;
+        void outputUpdate(rcp_parameter* parameter) override;
 
         void m_open(const t_symbol *d);
         void m_close();
+        // udp
+        void setUdp(const bool& b);
+        void getUdp(bool& b);
+        // socket options
+        void setNodelay(const bool& b);
+        void getNodelay(bool& b);
+        void setSndbuf(const int& i);
+        void getSndbuf(int& i);
+        void setRcvbuf(const int& i);
+        void getRcvbuf(int& i);
+        void setTos(const int& i);
+        void getTos(int& i);
+        // keepalive
+        void setPingInterval(const float& f);
+        void getPingInterval(float& f);
+        void setPingTimeout(const float& f);
+        void getPingTimeout(float& f);
 
     private:
         FLEXT_CALLBACK_S(m_open)
         FLEXT_CALLBACK(m_close)        
+        FLEXT_CALLSET_B(setUdp)
+        FLEXT_CALLGET_B(getUdp)
+        // socket options
+        FLEXT_CALLSET_B(setNodelay)
+        FLEXT_CALLGET_B(getNodelay)
+        FLEXT_CALLSET_I(setSndbuf)
+        FLEXT_CALLGET_I(getSndbuf)
+        FLEXT_CALLSET_I(setRcvbuf)
+        FLEXT_CALLGET_I(getRcvbuf)
+        FLEXT_CALLSET_I(setTos)
+        FLEXT_CALLGET_I(getTos)
+        // keepalive
+        FLEXT_CALLSET_F(setPingInterval)
+        FLEXT_CALLGET_F(getPingInterval)
+        FLEXT_CALLSET_F(setPingTimeout)
+        FLEXT_CALLGET_F(getPingTimeout)
+
+    private:
+        std::string pathKey(rcp_parameter* parameter);
+        void bindParameter(ParameterClientBinding* binding, rcp_parameter* parameter);
+        void unbindAll();
+        bool isAttached(ParameterClientBinding* binding) const;
+        void applySocketOptions();
+        void applyKeepalive();
 
     private:
         rcp_client* m_client{nullptr};
         IClientTransporter* m_transporter{nullptr};
+        // websocket tcp options
+        SocketOptions m_socketOptions;
+        // keepalive in seconds - interval 0: off
+        float m_pingInterval{0};
+        float m_pingTimeout{5};
+
+        // named client
+        const t_symbol* m_name{nullptr};
+        // bindings get added and removed on the main thread, bound and
+        // updated on the network thread.
+        // recursive: when polled a binding's output may add or remove bindings
+        std::recursive_mutex m_bindingLock;
+        // attached bindings - checked before calling into one
+        std::unordered_set<ParameterClientBinding*> m_bindings;
+        // bindings by path: group/group/label
+        std::unordered_multimap<std::string, ParameterClientBinding*> m_bindingsByPath;
+        // bound bindings by parameter id
+        std::unordered_map<int16_t, std::vector<ParameterClientBinding*> > m_bindingsById;
     };
 
 }
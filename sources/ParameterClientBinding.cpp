@@ -0,0 +1,147 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "ParameterClientBinding.h"
+
+#include <stdexcept>
+
+#include "ParameterClient.h"
+
+namespace rcp
+{
+
+    ParameterClientBinding::ParameterClientBinding(int argc, t_atom *argv)
+    {
+        // <client> <group> <group> ... <label>
+
+        if (argc < 2 ||
+                !IsSymbol(argv[0]))
+        {
+            throw std::runtime_error("please provide a client name and a parameter path");
+        }
+
+        m_clientName = GetSymbol(argv[0]);
+
+        for (int i=1; i<argc; i++)
+        {
+            std::string part;
+            if (IsString(argv[i]))
+            {
+                part = GetString(argv[i]);
+            }
+            else if (CanbeInt(argv[i]))
+            {
+                part = std::to_string(GetAInt(argv[i]));
+            }
+
+            if (part.empty())
+            {
+                throw std::runtime_error("invalid parameter path");
+            }
+
+            m_pathParts.push_back(part);
+            if (!m_path.empty()) m_path += "/";
+            m_path += part;
+        }
+    }
+
+    bool ParameterClientBinding::Init()
+    {
+        if (!flext_base::Init())
+        {
+            return false;
+        }
+
+        ClientRegistry::addBinding(m_clientName, this);
+
+        ParameterClient* client = ClientRegistry::host(m_clientName);
+        if (client)
+        {
+            client->addBinding(this);
+        }
+
+        return true;
+    }
+
+    ParameterClientBinding::~ParameterClientBinding()
+    {
+        if (m_client)
+        {
+            m_client->removeBinding(this);
+        }
+
+        ClientRegistry::removeBinding(m_clientName, this);
+    }
+
+    void ParameterClientBinding::attach(ParameterClient* client)
+    {
+        m_client = client;
+    }
+
+    void ParameterClientBinding::detach()
+    {
+        unbound();
+        m_client = nullptr;
+    }
+
+    void ParameterClientBinding::sendValue(t_atom& atom)
+    {
+        if (m_client)
+        {
+            m_client->sendValue(this, atom);
+        }
+    }
+
+    void ParameterClientBinding::sendBang()
+    {
+        if (m_client)
+        {
+            m_client->sendBang(this);
+        }
+    }
+
+    void ParameterClientBinding::bound(rcp_parameter* parameter)
+    {
+        m_parameter = parameter;
+    }
+
+    void ParameterClientBinding::unbound()
+    {
+        m_parameter = nullptr;
+    }
+
+}
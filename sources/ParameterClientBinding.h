@@ -0,0 +1,98 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef PARAMETERCLIENTBINDING_H
+#define PARAMETERCLIENTBINDING_H
+
+#include <string>
+#include <vector>
+
+#include <rcp_parameter_type.h>
+
+#include "ParameterBinding.h"
+#include "Registry.h"
+
+namespace rcp
+{
+    class ParameterClient;
+    class ParameterClientBinding;
+
+    typedef Registry<ParameterClient, ParameterClientBinding> ClientRegistry;
+
+    /* base for objects bound to one parameter of a named rcp.client
+     * [rcp.receive <client> <group> ... <label>]
+     * [rcp.send <client> <group> ... <label>]
+     */
+    class ParameterClientBinding : public ParameterBinding
+    {
+        FLEXT_HEADER(ParameterClientBinding, flext_base)
+
+    public:
+        ParameterClientBinding(int argc, t_atom *argv);
+        ~ParameterClientBinding();
+
+        const std::vector<std::string>& pathParts() const { return m_pathParts; }
+        const std::string& path() const { return m_path; }
+
+        // called by ParameterClient
+        void attach(ParameterClient* client);
+        void detach();
+        virtual void bound(rcp_parameter* parameter);
+        virtual void unbound();
+        virtual void valueUpdated(rcp_parameter* /*parameter*/) {}
+
+    protected:
+        // flext: called after construction, binds to the client.
+        // bound() must not run from the base constructor
+        bool Init() override;
+
+        // ParameterBinding
+        void sendValue(t_atom& atom) override;
+        void sendBang() override;
+
+    protected:
+        ParameterClient* m_client{nullptr};
+
+    private:
+        const t_symbol* m_clientName{nullptr};
+        std::vector<std::string> m_pathParts;
+        std::string m_path;
+    };
+
+}
+
+#endif // PARAMETERCLIENTBINDING_H
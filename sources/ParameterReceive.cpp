@@ -0,0 +1,69 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "ParameterReceive.h"
+
+#include <rcp_parameter.h>
+
+namespace rcp
+{
+
+    ParameterReceive::ParameterReceive(int argc, t_atom *argv)
+        : ParameterClientBinding(argc, argv)
+    {
+        AddInAnything();
+        AddOutAnything();
+    }
+
+    void ParameterReceive::bound(rcp_parameter* parameter)
+    {
+        ParameterClientBinding::bound(parameter);
+
+        // output current value
+        if (rcp_parameter_is_value(parameter))
+        {
+            outputValue(parameter);
+        }
+    }
+
+    void ParameterReceive::valueUpdated(rcp_parameter* parameter)
+    {
+        outputValue(parameter);
+    }
+
+    FLEXT_LIB_V("rcp.receive", ParameterReceive);
+}
@@ -0,0 +1,541 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "ParameterRelay.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <rcp_manager.h>
+#include <rcp_parameter.h>
+#include <rcp_typedefinition.h>
+
+#include "WebsocketClientTransporter.h"
+#include "WebsocketServerTransporter.h"
+#include "Reaper.h"
+
+namespace rcp
+{
+
+    static void relay_parameter_added_cb(rcp_parameter* parameter, void* user)
+    {
+        if (user)
+        {
+            ((ParameterRelay*)user)->upstreamAdded(parameter);
+        }
+    }
+
+    static void relay_parameter_removed_cb(rcp_parameter* parameter, void* user)
+    {
+        if (user)
+        {
+            ((ParameterRelay*)user)->upstreamRemoved(parameter);
+        }
+    }
+
+    static void upstreamValueUpdatedCb(rcp_value_parameter* parameter, void* user)
+    {
+        if (user)
+        {
+            ((ParameterRelay*)user)->upstreamUpdated(RCP_PARAMETER(parameter));
+        }
+    }
+
+    static void upstreamBangCb(rcp_bang_parameter* parameter, void* user)
+    {
+        if (user)
+        {
+            ((ParameterRelay*)user)->upstreamUpdated(RCP_PARAMETER(parameter));
+        }
+    }
+
+    static void downstreamValueUpdatedCb(rcp_value_parameter* parameter, void* user)
+    {
+        if (user)
+        {
+            ((ParameterRelay*)user)->downstreamUpdated(RCP_PARAMETER(parameter));
+        }
+    }
+
+    static void downstreamBangCb(rcp_bang_parameter* parameter, void* user)
+    {
+        if (user)
+        {
+            ((ParameterRelay*)user)->downstreamUpdated(RCP_PARAMETER(parameter));
+        }
+    }
+
+
+
+    ParameterRelay::ParameterRelay(int argc, t_atom *argv)
+    {
+        // [rcp.relay] - open <upstream-uri>, listen <port>
+        //
+        // option symbol: -poll - no network threads, io is polled from the scheduler
+
+        for (int i=0; i<argc; i++)
+        {
+            if (IsString(argv[i]) &&
+                    std::string(GetString(argv[i])) == "-poll")
+            {
+                m_polled = true;
+            }
+        }
+
+        AddInAnything();
+
+        // upstream connected
+        AddOutInt();
+        // downstream client count
+        AddOutInt();
+
+        // downstream
+        m_server = rcp_server_create(NULL);
+
+        if (m_server == nullptr)
+        {
+            throw std::runtime_error("could not create rcp server");
+        }
+
+        m_localManager = rcp_server_get_manager(m_server);
+        rcp_server_set_id(m_server, "pd rcp relay");
+
+        // upstream
+        m_upstream = new WebsocketClientTransporter(this, m_polled);
+        m_client = rcp_client_create(m_upstream->transporter());
+
+        if (m_client == nullptr)
+        {
+            delete m_upstream;
+            m_upstream = nullptr;
+            rcp_server_free(m_server);
+            m_server = nullptr;
+
+            throw std::runtime_error("could not create rcp client");
+        }
+
+        m_upstreamManager = rcp_client_get_manager(m_client);
+        rcp_client_set_id(m_client, "pd rcp relay");
+
+        rcp_client_set_user(m_client, this);
+        rcp_client_set_parameter_added_cb(m_client, relay_parameter_added_cb);
+        rcp_client_set_parameter_removed_cb(m_client, relay_parameter_removed_cb);
+    }
+
+    ParameterRelay::~ParameterRelay()
+    {
+        // stop callbacks before client and server go away
+        bool detached = m_upstream->detach();
+        disposeTransporter();
+
+        rcp_client_free(m_client);
+        m_client = nullptr;
+
+        if (detached)
+        {
+            // network threads finish shutting down in the background
+            Reaper::dispose(std::shared_ptr<IClientTransporter>(m_upstream));
+        }
+        else
+        {
+            delete m_upstream;
+        }
+        m_upstream = nullptr;
+
+        rcp_server_free(m_server);
+    }
+
+    void ParameterRelay::disposeTransporter()
+    {
+        if (!m_transporter)
+        {
+            return;
+        }
+
+        if (m_transporter->detach())
+        {
+            Reaper::dispose(m_transporter);
+        }
+
+        m_transporter.reset();
+    }
+
+    // upstream
+
+    void ParameterRelay::m_open(const t_symbol *d)
+    {
+        m_upstream->open(std::string(GetString(d)));
+    }
+
+    void ParameterRelay::m_close()
+    {
+        m_upstream->close();
+    }
+
+    void ParameterRelay::connected()
+    {
+        ToOutInt(0, 1);
+    }
+
+    void ParameterRelay::failed(uint16_t code)
+    {
+        error("rcp.relay: could not connect upstream: %d", code);
+        ToOutInt(0, 0);
+    }
+
+    void ParameterRelay::disconnected(uint16_t /*code*/)
+    {
+        // downstream clients lose the mirrored tree with the upstream
+        removeAllMirrors();
+        ToOutInt(0, 0);
+    }
+
+    // downstream
+
+    void ParameterRelay::getPort(int& p)
+    {
+        p = m_transporter ? m_transporter->port() : 0;
+    }
+
+    void ParameterRelay::listen(int& p)
+    {
+        if (m_transporter &&
+                m_transporter->isListening() &&
+                p == m_transporter->port())
+        {
+            // port not changed
+            return;
+        }
+
+        if (p > (int)UINT16_MAX)
+        {
+            error("invalid port: %d", p);
+            return;
+        }
+
+        disposeTransporter();
+
+        m_clientCount = 0;
+        ToOutInt(1, m_clientCount);
+
+        if (p > 0)
+        {
+            m_transporter = std::make_shared<WebsocketServerTransporter>(m_server, this, m_polled);
+            m_transporter->bind(p);
+        }
+    }
+
+    void ParameterRelay::connected(void* /*client*/)
+    {
+        m_clientCount++;
+        ToOutInt(1, m_clientCount);
+    }
+
+    void ParameterRelay::disconnected(void* /*client*/)
+    {
+        m_clientCount--;
+        if (m_clientCount < 0)
+        {
+            error("client count < 0!");
+            m_clientCount = 0;
+        }
+
+        ToOutInt(1, m_clientCount);
+    }
+
+    // mirroring
+
+    void ParameterRelay::upstreamAdded(rcp_parameter* parameter)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_lock);
+
+        if (mirror(parameter))
+        {
+            rcp_server_update(m_server);
+        }
+    }
+
+    void ParameterRelay::upstreamRemoved(rcp_parameter* parameter)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_lock);
+
+        removeMirror(rcp_parameter_get_id(parameter));
+        rcp_server_update(m_server);
+    }
+
+    void ParameterRelay::upstreamUpdated(rcp_parameter* parameter)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_lock);
+
+        if (m_forwarding)
+        {
+            return;
+        }
+
+        auto it = m_local.find(rcp_parameter_get_id(parameter));
+        if (it == m_local.end())
+        {
+            return;
+        }
+
+        // fan out to all downstream clients
+        copyValue(parameter, it->second, m_localManager);
+        rcp_server_update(m_server);
+    }
+
+    void ParameterRelay::downstreamUpdated(rcp_parameter* parameter)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_lock);
+
+        if (m_forwarding)
+        {
+            return;
+        }
+
+        auto it = m_remote.find(rcp_parameter_get_id(parameter));
+        if (it == m_remote.end())
+        {
+            return;
+        }
+
+        rcp_parameter* upstream = rcp_manager_get_parameter(m_upstreamManager, it->second);
+        if (upstream == NULL)
+        {
+            return;
+        }
+
+        // the server already sent the value to the other downstream clients
+        copyValue(parameter, upstream, m_upstreamManager);
+        rcp_manager_update(m_upstreamManager);
+    }
+
+    rcp_parameter* ParameterRelay::mirror(rcp_parameter* parameter)
+    {
+        int16_t id = rcp_parameter_get_id(parameter);
+
+        auto it = m_local.find(id);
+        if (it != m_local.end())
+        {
+            return it->second;
+        }
+
+        // parents first - a group may arrive after its children
+        rcp_group_parameter* group = nullptr;
+        rcp_group_parameter* parent = rcp_parameter_get_parent(parameter);
+        if (parent != NULL)
+        {
+            group = RCP_GROUP_PARAMETER(mirror(RCP_PARAMETER(parent)));
+        }
+
+        const char* label = rcp_parameter_get_label(parameter);
+        if (label == NULL)
+        {
+            label = "";
+        }
+
+        rcp_parameter* local = nullptr;
+
+        if (rcp_parameter_is_group(parameter))
+        {
+            local = RCP_PARAMETER(rcp_server_create_group(m_server, label, group));
+        }
+        else
+        {
+            switch (RCP_TYPE_ID(parameter))
+            {
+            case DATATYPE_FLOAT32:
+                local = RCP_PARAMETER(rcp_server_expose_f32(m_server, label, group));
+                break;
+            case DATATYPE_INT32:
+                local = RCP_PARAMETER(rcp_server_expose_i32(m_server, label, group));
+                break;
+            case DATATYPE_BOOLEAN:
+                local = RCP_PARAMETER(rcp_server_expose_bool(m_server, label, group));
+                break;
+            case DATATYPE_STRING:
+                local = RCP_PARAMETER(rcp_server_expose_string(m_server, label, group));
+                break;
+            case DATATYPE_BANG:
+                local = RCP_PARAMETER(rcp_server_expose_bang(m_server, label, group));
+                break;
+            default:
+                // not supported by rcp.server either
+                break;
+            }
+        }
+
+        if (local == nullptr)
+        {
+            return nullptr;
+        }
+
+        rcp_parameter_set_readonly(local, rcp_parameter_get_readonly(parameter));
+        rcp_parameter_set_order(local, rcp_parameter_get_order(parameter));
+
+        if (rcp_parameter_is_value(parameter))
+        {
+            rcp_typedefinition* td = rcp_parameter_get_typedefinition(parameter);
+            rcp_datatype type = RCP_TYPE_ID(parameter);
+
+            if (type == DATATYPE_FLOAT32)
+            {
+                if (rcp_typedefinition_has_option(td, NUMBER_OPTIONS_MINIMUM)) rcp_parameter_set_min_float(RCP_VALUE_PARAMETER(local), rcp_parameter_get_min_float(RCP_VALUE_PARAMETER(parameter)));
+                if (rcp_typedefinition_has_option(td, NUMBER_OPTIONS_MAXIMUM)) rcp_parameter_set_max_float(RCP_VALUE_PARAMETER(local), rcp_parameter_get_max_float(RCP_VALUE_PARAMETER(parameter)));
+            }
+            else if (type == DATATYPE_INT32)
+            {
+                if (rcp_typedefinition_has_option(td, NUMBER_OPTIONS_MINIMUM)) rcp_parameter_set_min_int32(RCP_VALUE_PARAMETER(local), rcp_parameter_get_min_int32(RCP_VALUE_PARAMETER(parameter)));
+                if (rcp_typedefinition_has_option(td, NUMBER_OPTIONS_MAXIMUM)) rcp_parameter_set_max_int32(RCP_VALUE_PARAMETER(local), rcp_parameter_get_max_int32(RCP_VALUE_PARAMETER(parameter)));
+            }
+
+            copyValue(parameter, local, m_localManager);
+
+            rcp_parameter_set_user(local, this);
+            rcp_parameter_set_value_updated_cb(RCP_VALUE_PARAMETER(local), downstreamValueUpdatedCb);
+
+            rcp_parameter_set_user(parameter, this);
+            rcp_parameter_set_value_updated_cb(RCP_VALUE_PARAMETER(parameter), upstreamValueUpdatedCb);
+        }
+        else if (rcp_parameter_is_type(parameter, DATATYPE_BANG))
+        {
+            rcp_parameter_set_user(local, this);
+            rcp_bang_parameter_set_bang_cb(RCP_BANG_PARAMETER(local), downstreamBangCb);
+
+            rcp_parameter_set_user(parameter, this);
+            rcp_bang_parameter_set_bang_cb(RCP_BANG_PARAMETER(parameter), upstreamBangCb);
+        }
+
+        m_local[id] = local;
+        m_remote[rcp_parameter_get_id(local)] = id;
+
+        return local;
+    }
+
+    void ParameterRelay::copyValue(rcp_parameter* from, rcp_parameter* to, rcp_manager* manager)
+    {
+        // setting a value must not bounce back to where it came from
+        m_forwarding = true;
+
+        switch (RCP_TYPE_ID(from))
+        {
+        case DATATYPE_FLOAT32:
+            rcp_parameter_set_value_float(RCP_VALUE_PARAMETER(to), rcp_parameter_get_value_float(RCP_VALUE_PARAMETER(from)));
+            break;
+        case DATATYPE_INT32:
+            rcp_parameter_set_value_int32(RCP_VALUE_PARAMETER(to), rcp_parameter_get_value_int32(RCP_VALUE_PARAMETER(from)));
+            break;
+        case DATATYPE_BOOLEAN:
+            rcp_parameter_set_value_bool(RCP_VALUE_PARAMETER(to), rcp_parameter_get_value_bool(RCP_VALUE_PARAMETER(from)));
+            break;
+        case DATATYPE_STRING:
+        {
+            const char* value = rcp_parameter_get_value_string(RCP_VALUE_PARAMETER(from));
+            rcp_parameter_set_value_string(RCP_VALUE_PARAMETER(to), value != NULL ? value : "");
+            break;
+        }
+        case DATATYPE_BANG:
+            rcp_manager_set_dirty(manager, to);
+            break;
+        default:
+            break;
+        }
+
+        m_forwarding = false;
+    }
+
+    void ParameterRelay::removeMirror(int16_t upstreamId)
+    {
+        auto it = m_local.find(upstreamId);
+        if (it == m_local.end())
+        {
+            return;
+        }
+
+        int16_t id = rcp_parameter_get_id(it->second);
+        m_local.erase(it);
+        m_remote.erase(id);
+
+        rcp_server_remove_parameter_id(m_server, id);
+
+        // removing a group removes its children
+        for (auto child = m_remote.begin(); child != m_remote.end(); )
+        {
+            if (rcp_manager_get_parameter(m_localManager, child->first) == NULL)
+            {
+                m_local.erase(child->second);
+                child = m_remote.erase(child);
+            }
+            else
+            {
+                ++child;
+            }
+        }
+    }
+
+    void ParameterRelay::removeAllMirrors()
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_lock);
+
+        if (m_local.empty())
+        {
+            return;
+        }
+
+        std::vector<int16_t> ids;
+        ids.reserve(m_remote.size());
+
+        for (auto& it : m_remote)
+        {
+            ids.push_back(it.first);
+        }
+
+        m_local.clear();
+        m_remote.clear();
+
+        for (int16_t id : ids)
+        {
+            // children of already removed groups are gone
+            rcp_server_remove_parameter_id(m_server, id);
+        }
+
+        rcp_server_update(m_server);
+    }
+
+    FLEXT_LIB_V("rcp.relay", ParameterRelay);
+
+}
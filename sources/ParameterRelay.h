@@ -0,0 +1,150 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef PARAMETERRELAY_H
+#define PARAMETERRELAY_H
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <flext.h>
+
+#include <rcp_server.h>
+#include <rcp_client.h>
+#include <rcp_manager_type.h>
+
+#include "websocketServer.h"
+#include "websocketClient.h"
+
+namespace rcp
+{
+    class WebsocketClientTransporter;
+    class WebsocketServerTransporter;
+
+    /* mirrors the parameter tree of an upstream server and exposes it
+     * to downstream clients on a local port.
+     * upstream sees a single client no matter how many clients connect downstream.
+     */
+    class ParameterRelay
+            : public flext_base
+            , public IWebsocketServerListener
+            , public IWebsocketClientListener
+    {
+        FLEXT_HEADER_S(ParameterRelay, flext_base, setup)
+
+    public:
+        ParameterRelay(int argc, t_atom *argv);
+        ~ParameterRelay();
+
+        // upstream
+        void upstreamAdded(rcp_parameter* parameter);
+        void upstreamRemoved(rcp_parameter* parameter);
+        void upstreamUpdated(rcp_parameter* parameter);
+        // downstream
+        void downstreamUpdated(rcp_parameter* parameter);
+
+    public:
+        // IWebsocketServerListener
+        void connected(void* client) override;
+        void disconnected(void* client) override;
+        void received(char* /*data*/, size_t /*size*/, void* /*id*/) override {}
+        void socketerror(const char* /*reason*/) override {}
+
+        // IWebsocketClientListener
+        void connected() override;
+        void failed(uint16_t code) override;
+        void disconnected(uint16_t code) override;
+        void received(char* /*data*/, size_t /*size*/) override {}
+        void received(const std::string& /*msg*/) override {}
+
+    protected:
+        static void setup(t_classid c)
+        {
+            // upstream
+            FLEXT_CADDMETHOD_(c, 0, "open", m_open);
+            FLEXT_CADDMETHOD_(c, 0, "close", m_close);
+            // downstream
+            FLEXT_CADDATTR_GET(c, "port", getPort);
+            FLEXT_CADDMETHOD_I(c, 0, "listen", listen);
+        }
+
+        void m_open(const t_symbol *d);
+        void m_close();
+        void getPort(int& p);
+        void listen(int& p);
+
+    private:
+        FLEXT_CALLBACK_S(m_open)
+        FLEXT_CALLBACK(m_close)
+        FLEXT_CALLGET_I(getPort)
+        FLEXT_CALLBACK_I(listen)
+
+    private:
+        rcp_parameter* mirror(rcp_parameter* parameter);
+        void copyValue(rcp_parameter* from, rcp_parameter* to, rcp_manager* manager);
+        void removeMirror(int16_t upstreamId);
+        void removeAllMirrors();
+        void disposeTransporter();
+
+    private:
+        rcp_server* m_server{nullptr};
+        rcp_manager* m_localManager{nullptr};
+        std::shared_ptr<WebsocketServerTransporter> m_transporter;
+
+        rcp_client* m_client{nullptr};
+        rcp_manager* m_upstreamManager{nullptr};
+        WebsocketClientTransporter* m_upstream{nullptr};
+
+        bool m_polled{false};
+        int m_clientCount{0};
+
+        // upstream id -> local parameter
+        std::unordered_map<int16_t, rcp_parameter*> m_local;
+        // local id -> upstream id
+        // NOTE: upstream parameters are looked up by id, they go away with the connection
+        std::unordered_map<int16_t, int16_t> m_remote;
+
+        // upstream and downstream run on different io threads
+        std::recursive_mutex m_lock;
+        // set while applying a value to the other side
+        bool m_forwarding{false};
+    };
+
+}
+
+#endif // PARAMETERRELAY_H
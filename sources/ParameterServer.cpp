@@ -38,16 +38,24 @@
 #include "ParameterServer.h"
 
 #include <string>
+#include <utility>
 #include <vector>
+#include <cmath>
 
 #include <rcp_manager.h>
 #include <rcp_parameter.h>
 #include <rcp_typedefinition.h>
 
 #include "RabbitholeServerTransporter.h"
+#include "RabbitholeMuxServerTransporter.h"
 #include "WebsocketServerTransporter.h"
+#include "SharedWebsocketServerTransporter.h"
 #include "PdServerTransporter.h"
-#include "Optional.h"
+#include "ShmServerTransporter.h"
+#include "TcpServerTransporter.h"
+#include "ServerParameter.h"
+#include "Poller.h"
+#include "Reaper.h"
 
 namespace rcp
 {
@@ -67,6 +75,30 @@ namespace rcp
             x->parameterUpdate(RCP_PARAMETER(param));
         }
     }
+    static void updateTimerCb(void* user)
+    {
+        if (user)
+        {
+            ParameterServer* x = static_cast<ParameterServer*>(user);
+            x->flushUpdate();
+        }
+    }
+    static void deadbandTimerCb(void* user)
+    {
+        if (user)
+        {
+            ParameterServer* x = static_cast<ParameterServer*>(user);
+            x->deadbandRefresh();
+        }
+    }
+    static void statsTimerCb(void* user)
+    {
+        if (user)
+        {
+            ParameterServer* x = static_cast<ParameterServer*>(user);
+            x->outputStats();
+        }
+    }
 
 	ParameterServer::ParameterServer(int argc, t_atom *argv)
 		: ParameterServerClientBase()
@@ -77,10 +109,12 @@ namespace rcp
         , m_clientCount(0)
 	{
         // [rcp.server] - server without name and default port 10000
-        // [rcp.server symbol] - server with name "symbol" and default port 10000
+        // [rcp.server symbol] - server with name "symbol" for [rcp.param] and default port 10000
         //
         // option symbol: -raw - creates a raw-transporter (sending must be done in pd)
         //      per default internal websocket server is used
+        // option symbol: -poll - no network threads, io is polled from the scheduler
+        // option symbol: -tcp - listen with plain tcp and size prefixed frames instead of websockets
 
         for (int i=0; i<argc; i++)
         {
@@ -91,6 +125,23 @@ namespace rcp
                     m_raw = true;
                     continue;
                 }
+
+                if (std::string(GetString(argv[i])) == "-poll")
+                {
+                    m_polled = true;
+                    continue;
+                }
+
+                if (std::string(GetString(argv[i])) == "-tcp")
+                {
+                    m_tcp = true;
+                    continue;
+                }
+
+                if (m_name == nullptr)
+                {
+                    m_name = GetSymbol(argv[i]);
+                }
             }
         }
 
@@ -116,22 +167,56 @@ namespace rcp
 
         // set application id
         rcp_server_set_id(m_server, "pd rcp server ");
+
+        m_updateTimer.SetCallback(updateTimerCb);
+        m_deadbandTimer.SetCallback(deadbandTimerCb);
+        m_statsTimer.SetCallback(statsTimerCb);
+
+        if (m_name)
+        {
+            if (ServerRegistry::addHost(m_name, this))
+            {
+                for (ServerParameter* binding : ServerRegistry::bindings(m_name))
+                {
+                    addBinding(binding);
+                }
+            }
+            else
+            {
+                error("rcp.server: name '%s' is already in use", GetString(m_name));
+                m_name = nullptr;
+            }
+        }
 	}
 
 	ParameterServer::~ParameterServer()
 	{
-		// free resources
-		if (m_transporter)
-		{
-			m_transporter->unbind();
-			m_transporter.reset();
-		}
+        m_updateTimer.Reset();
+        m_deadbandTimer.Reset();
+        m_statsTimer.Reset();
 
-        if (m_rabbitholeTransporter)
         {
-            m_rabbitholeTransporter.reset();
+            // NOTE: not held while disposing, a running callback may wait for it
+            std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+            if (m_name)
+            {
+                ServerRegistry::removeHost(m_name, this);
+
+                for (ServerParameter* binding : ServerRegistry::bindings(m_name))
+                {
+                    binding->detach();
+                }
+            }
+            m_bindings.clear();
         }
 
+		// free resources
+        disposeTransporter();
+        dispose(std::move(m_rabbitholeTransporter));
+        dispose(std::move(m_rabbitholeMuxTransporter));
+        dispose(std::move(m_shmTransporter));
+
         rcp_server_free(m_server);
 	}
 
@@ -153,6 +238,31 @@ namespace rcp
         ToOutInt(2, m_clientCount);
     }
 
+    void ParameterServer::disposeTransporter()
+    {
+        // moves the last reference out
+        dispose(std::move(m_transporter));
+    }
+
+    void ParameterServer::dispose(std::shared_ptr<IServerTransporter> transporter)
+    {
+        if (!transporter)
+        {
+            return;
+        }
+
+        if (transporter->detach())
+        {
+            // network threads finish shutting down in the background
+            Reaper::dispose(std::move(transporter));
+        }
+        else
+        {
+            // polled: we may be inside the transporter's poll()
+            Poller::release(std::move(transporter));
+        }
+    }
+
     void ParameterServer::handle_raw_data(char* data, size_t size)
     {
         if (m_transporter)
@@ -200,12 +310,32 @@ namespace rcp
         if (p > 0)
         {
             // create new transporter
-            std::shared_ptr<IServerTransporter> new_transporter = std::make_shared<WebsocketServerTransporter>(m_server, this);
+            std::shared_ptr<IServerTransporter> new_transporter;
+
+            if (m_tcp)
+            {
+                new_transporter = std::make_shared<TcpServerTransporter>(m_server, this, m_polled);
+            }
+            else if (m_path.empty())
+            {
+                std::shared_ptr<WebsocketServerTransporter> ws_transporter = std::make_shared<WebsocketServerTransporter>(m_server, this, m_polled);
+                if (ws_transporter)
+                {
+                    setupTransporter(ws_transporter.get());
+                }
+                new_transporter = ws_transporter;
+            }
+            else
+            {
+                // listener is shared with other servers on this port
+                new_transporter = std::make_shared<SharedWebsocketServerTransporter>(m_server, this, m_path, m_polled);
+            }
 
             if (new_transporter)
             {
                 // set new transporter
-                m_transporter = new_transporter;                
+                disposeTransporter();
+                m_transporter = new_transporter;
                 m_transporter->bind(p);
 
                 // reset connected clients
@@ -220,19 +350,446 @@ namespace rcp
         else if (m_transporter)
         {
             // just remove this transporter
-            // NOTE: transporter gets removed from rcp_server in desctructor
-            m_transporter.reset();
+            disposeTransporter();
+        }
+    }
+
+    // shared port
+
+    void ParameterServer::setPath(const t_symbol*& path)
+    {
+        std::string p = GetAString(path);
+        if (!p.empty())
+        {
+            p = SharedWebsocketServer::normalizePath(p);
+        }
+
+        if (p == m_path)
+        {
+            return;
+        }
+
+        m_path = p;
+
+        if (!m_raw &&
+                m_transporter &&
+                m_transporter->isListening())
+        {
+            // re-listen on the same port
+            int port = m_transporter->port();
+            disposeTransporter();
+            listen(port);
+        }
+    }
+
+    void ParameterServer::getPath(const t_symbol*& path)
+    {
+        path = MakeSymbol(m_path.c_str());
+    }
+
+    // udp
+
+    void ParameterServer::setUdp(const int& port)
+    {
+        if (port < 0 ||
+                port > (int)UINT16_MAX)
+        {
+            error("invalid udp port: %d", port);
+            return;
+        }
+
+        if (port == m_udpPort)
+        {
+            return;
+        }
+
+        m_udpPort = port;
+
+        if (!m_raw &&
+                m_transporter &&
+                m_transporter->isListening())
+        {
+            // udp socket is opened before listening - re-listen
+            int p = m_transporter->port();
+            disposeTransporter();
+            listen(p);
+        }
+    }
+
+    void ParameterServer::getUdp(int& port)
+    {
+        port = m_udpPort;
+    }
+
+    void ParameterServer::setupTransporter(WebsocketServerTransporter* transporter)
+    {
+        transporter->setAsync(m_async);
+        transporter->setUdpPort((uint16_t)m_udpPort);
+        transporter->setDirect(m_direct);
+        transporter->set_threads((unsigned)m_threads);
+        transporter->set_socket_options(m_socketOptions);
+        transporter->set_keepalive(uint32_t(m_pingInterval * 1000), uint32_t(m_pingTimeout * 1000));
+        transporter->set_max_clients((uint32_t)m_maxClients);
+        transporter->set_connect_rate(m_maxRate);
+    }
+
+    void ParameterServer::applySocketOptions()
+    {
+        // for connections accepted from now on
+        std::shared_ptr<WebsocketServerTransporter> transporter = std::dynamic_pointer_cast<WebsocketServerTransporter>(m_transporter);
+        if (transporter)
+        {
+            transporter->set_socket_options(m_socketOptions);
+        }
+    }
+
+    // direct dispatch
+
+    void ParameterServer::setDirect(const bool& b)
+    {
+        if (b == m_direct)
+        {
+            return;
+        }
+
+        m_direct = b;
+
+        if (!m_raw &&
+                !m_polled &&
+                m_transporter &&
+                m_transporter->isListening())
+        {
+            // dispatch mode is set before listening - re-listen
+            int p = m_transporter->port();
+            disposeTransporter();
+            listen(p);
+        }
+    }
+
+    void ParameterServer::getDirect(bool& b)
+    {
+        b = m_direct;
+    }
+
+    // io threads
+
+    void ParameterServer::setThreads(const int& i)
+    {
+        int threads = i > 1 ? i : 1;
+        if (threads == m_threads)
+        {
+            return;
+        }
+
+        m_threads = threads;
+
+        if (!m_raw &&
+                !m_polled &&
+                m_transporter &&
+                m_transporter->isListening())
+        {
+            // threads are started when listening - re-listen
+            int p = m_transporter->port();
+            disposeTransporter();
+            listen(p);
+        }
+    }
+
+    void ParameterServer::getThreads(int& i)
+    {
+        i = m_threads;
+    }
+
+    // async
+
+    void ParameterServer::setAsync(const bool& b)
+    {
+        m_async = b;
+
+        std::shared_ptr<WebsocketServerTransporter> transporter = std::dynamic_pointer_cast<WebsocketServerTransporter>(m_transporter);
+        if (transporter)
+        {
+            setupTransporter(transporter.get());
+        }
+
+        if (!m_async)
+        {
+            // send out pending changes
+            flushUpdate();
+        }
+    }
+
+    void ParameterServer::getAsync(bool& b)
+    {
+        b = m_async;
+    }
+
+    void ParameterServer::updateManager()
+    {
+        if (!m_async)
+        {
+            updateServer();
+            return;
+        }
+
+        // values are marked dirty in the manager already
+        // build packets once per scheduler tick
+        if (!m_updatePending)
+        {
+            m_updatePending = true;
+            m_updateTimer.Delay(0, this);
+        }
+    }
+
+    void ParameterServer::updateValue(rcp_parameter* parameter)
+    {
+        // the encoder only feeds the websocket transporter.
+        // with other transporters attached rcp_server_update sends to all
+        std::shared_ptr<WebsocketServerTransporter> transporter = std::dynamic_pointer_cast<WebsocketServerTransporter>(m_transporter);
+        if (m_async &&
+                transporter &&
+                !m_rabbitholeTransporter &&
+                !m_rabbitholeMuxTransporter &&
+                !m_shmTransporter)
+        {
+            // cheap copy on the pd thread - serialized on the encoder thread
+            transporter->snapshot(parameter);
+            return;
+        }
+
+        ParameterServerClientBase::updateValue(parameter);
+    }
+
+    void ParameterServer::flushUpdate()
+    {
+        m_updateTimer.Reset();
+        m_updatePending = false;
+
+        updateServer();
+    }
+
+    void ParameterServer::updateServer()
+    {
+        // older snapshots must not overtake the values in the tree
+        std::shared_ptr<WebsocketServerTransporter> transporter = std::dynamic_pointer_cast<WebsocketServerTransporter>(m_transporter);
+        if (transporter)
+        {
+            transporter->flushSnapshots();
+        }
+
+        rcp_server_update(m_server);
+    }
+
+    // socket options
+
+    void ParameterServer::setNodelay(const bool& b)
+    {
+        m_socketOptions.noDelay = b;
+        applySocketOptions();
+    }
+
+    void ParameterServer::getNodelay(bool& b)
+    {
+        b = m_socketOptions.noDelay;
+    }
+
+    void ParameterServer::setSndbuf(const int& i)
+    {
+        m_socketOptions.sendBuffer = i > 0 ? i : 0;
+        applySocketOptions();
+    }
+
+    void ParameterServer::getSndbuf(int& i)
+    {
+        i = m_socketOptions.sendBuffer;
+    }
+
+    void ParameterServer::setRcvbuf(const int& i)
+    {
+        m_socketOptions.receiveBuffer = i > 0 ? i : 0;
+        applySocketOptions();
+    }
+
+    void ParameterServer::getRcvbuf(int& i)
+    {
+        i = m_socketOptions.receiveBuffer;
+    }
+
+    void ParameterServer::setTos(const int& i)
+    {
+        if (i < 0 || i > 255)
+        {
+            error("invalid tos: %d", i);
+            return;
         }
+
+        m_socketOptions.tos = i;
+        applySocketOptions();
+    }
+
+    void ParameterServer::getTos(int& i)
+    {
+        i = m_socketOptions.tos;
+    }
+
+    // admission control
+
+    void ParameterServer::setMaxClients(const int& i)
+    {
+        m_maxClients = i > 0 ? i : 0;
+        applyAdmission();
+    }
+
+    void ParameterServer::getMaxClients(int& i)
+    {
+        i = m_maxClients;
+    }
+
+    void ParameterServer::setMaxRate(const float& f)
+    {
+        m_maxRate = f > 0 ? f : 0;
+        applyAdmission();
+    }
+
+    void ParameterServer::getMaxRate(float& f)
+    {
+        f = m_maxRate;
+    }
+
+    void ParameterServer::applyAdmission()
+    {
+        std::shared_ptr<WebsocketServerTransporter> transporter = std::dynamic_pointer_cast<WebsocketServerTransporter>(m_transporter);
+        if (transporter)
+        {
+            transporter->set_max_clients((uint32_t)m_maxClients);
+            transporter->set_connect_rate(m_maxRate);
+        }
+    }
+
+    // keepalive
+
+    void ParameterServer::setPingInterval(const float& f)
+    {
+        m_pingInterval = f > 0 ? f : 0;
+        applyKeepalive();
+    }
+
+    void ParameterServer::getPingInterval(float& f)
+    {
+        f = m_pingInterval;
+    }
+
+    void ParameterServer::setPingTimeout(const float& f)
+    {
+        m_pingTimeout = f > 0 ? f : 0;
+        applyKeepalive();
+    }
+
+    void ParameterServer::getPingTimeout(float& f)
+    {
+        f = m_pingTimeout;
+    }
+
+    void ParameterServer::applyKeepalive()
+    {
+        std::shared_ptr<WebsocketServerTransporter> transporter = std::dynamic_pointer_cast<WebsocketServerTransporter>(m_transporter);
+        if (transporter)
+        {
+            transporter->set_keepalive(uint32_t(m_pingInterval * 1000), uint32_t(m_pingTimeout * 1000));
+        }
+    }
+
+    // connection statistics
+
+    void ParameterServer::m_stats()
+    {
+        outputStats();
+    }
+
+    void ParameterServer::outputStats()
+    {
+        if (!m_transporter)
+        {
+            return;
+        }
+
+        std::vector<ConnectionInfo> stats;
+        m_transporter->stats(stats);
+
+        // stats <address> <rtt-ms> <kb-in> <kb-out> <messages-in> <messages-out> <kb-buffered> <seconds-connected>
+        // NOTE: kilobytes - pd floats do not hold big byte counts
+        t_atom list[9];
+        for (const ConnectionInfo& info : stats)
+        {
+            SetSymbol(list[0], MakeSymbol("stats"));
+            SetSymbol(list[1], MakeSymbol(info.address.c_str()));
+            SetFloat(list[2], (float)info.rtt);
+            SetFloat(list[3], (float)(info.bytesIn / 1024.0));
+            SetFloat(list[4], (float)(info.bytesOut / 1024.0));
+            SetFloat(list[5], (float)info.messagesIn);
+            SetFloat(list[6], (float)info.messagesOut);
+            SetFloat(list[7], (float)(info.buffered / 1024.0));
+            SetFloat(list[8], (float)info.connected);
+
+            ToOutList(3, 9, list);
+        }
+
+        // rejected <refused-full> <refused-rate-limited>
+        uint64_t full = 0;
+        uint64_t limited = 0;
+        m_transporter->rejected(full, limited);
+
+        SetSymbol(list[0], MakeSymbol("rejected"));
+        SetFloat(list[1], (float)full);
+        SetFloat(list[2], (float)limited);
+        ToOutList(3, 3, list);
+
+        // round trip times for the next output
+        m_transporter->ping();
+    }
+
+    void ParameterServer::setStatsInterval(const float& f)
+    {
+        m_statsInterval = f > 0 ? f : 0;
+
+        if (m_statsInterval > 0)
+        {
+            m_statsTimer.Periodic(m_statsInterval, this);
+        }
+        else
+        {
+            m_statsTimer.Reset();
+        }
+    }
+
+    void ParameterServer::getStatsInterval(float& f)
+    {
+        f = m_statsInterval;
     }
 
     // rabbithole
 
     void ParameterServer::setRabbithole(const t_symbol*& uri)
     {
+        if (m_rabbitholeMux)
+        {
+            if (m_server &&
+                    !m_rabbitholeMuxTransporter)
+            {
+                m_rabbitholeMuxTransporter = std::make_shared<RabbitholeMuxServerTransporter>(m_server, m_polled);
+            }
+
+            if (m_rabbitholeMuxTransporter)
+            {
+                m_rabbitholeMuxTransporter->connect(std::string(GetAString(uri)));
+            }
+            return;
+        }
+
         if (m_server &&
                 !m_rabbitholeTransporter)
         {
-            m_rabbitholeTransporter = std::make_shared<RabbitHoleServerTransporter>(m_server);
+            m_rabbitholeTransporter = std::make_shared<RabbitHoleServerTransporter>(m_server, m_polled);
         }
 
         if (m_rabbitholeTransporter)
@@ -242,86 +799,179 @@ namespace rcp
     }
     void ParameterServer::getRabbithole(const t_symbol*& uri)
     {
-        if (m_rabbitholeTransporter)
+        if (m_rabbitholeMuxTransporter)
+        {
+            uri = MakeSymbol(m_rabbitholeMuxTransporter->uri().c_str());
+        }
+        else if (m_rabbitholeTransporter)
         {
             uri = MakeSymbol(m_rabbitholeTransporter->uri().c_str());
         }
-    }
+    }
+
+    void ParameterServer::setRabbitholeInterval(const int& i)
+    {
+        if (m_rabbitholeTransporter)
+        {
+            m_rabbitholeTransporter->setInterval(i);
+        }
+
+        if (m_rabbitholeMuxTransporter)
+        {
+            m_rabbitholeMuxTransporter->setInterval(i);
+        }
+    }
+    void ParameterServer::getRabbitholeInterval(int& i)
+    {
+        if (m_rabbitholeMuxTransporter)
+        {
+            i = m_rabbitholeMuxTransporter->interval();
+        }
+        else if (m_rabbitholeTransporter)
+        {
+            i = m_rabbitholeTransporter->interval();
+        }
+    }
+
+    void ParameterServer::setRabbitholeMux(const bool& b)
+    {
+        if (b == m_rabbitholeMux)
+        {
+            return;
+        }
+
+        // move an open tunnel over
+        const t_symbol* uri = nullptr;
+        getRabbithole(uri);
+
+        m_rabbitholeMux = b;
+
+        dispose(std::move(m_rabbitholeMuxTransporter));
+        dispose(std::move(m_rabbitholeTransporter));
+
+        if (uri &&
+                *GetString(uri) != 0)
+        {
+            setRabbithole(uri);
+        }
+    }
+
+    void ParameterServer::getRabbitholeMux(bool& b)
+    {
+        b = m_rabbitholeMux;
+    }
+
+    // shared memory
+
+    void ParameterServer::setShm(const t_symbol*& name)
+    {
+        std::string n = GetAString(name);
+
+        if (m_shmTransporter &&
+                m_shmTransporter->name() == n)
+        {
+            return;
+        }
+
+        // one segment per server - close the old one
+        if (m_shmTransporter)
+        {
+            // the reader thread is joined on the reaper
+            m_shmTransporter->detach();
+            bool was_connected = m_shmTransporter->peerConnected();
+
+            Reaper::dispose(std::move(m_shmTransporter));
+
+            if (was_connected)
+            {
+                disconnected(nullptr);
+            }
+        }
+
+        if (n.empty() ||
+                !m_server)
+        {
+            return;
+        }
 
-    void ParameterServer::setRabbitholeInterval(const int& i)
-    {
-        if (m_rabbitholeTransporter)
+        m_shmTransporter = std::make_shared<ShmServerTransporter>(m_server, this);
+
+        if (!m_shmTransporter->open(n))
         {
-            m_rabbitholeTransporter->setInterval(i);
+            error("rcp.server: could not open shared memory '%s'", n.c_str());
+            m_shmTransporter.reset();
         }
     }
-    void ParameterServer::getRabbitholeInterval(int& i)
+    void ParameterServer::getShm(const t_symbol*& name)
     {
-        if (m_rabbitholeTransporter)
-        {
-            i = m_rabbitholeTransporter->interval();
-        }
+        name = MakeSymbol(m_shmTransporter ? m_shmTransporter->name().c_str() : "");
     }
 
     // parameter
-    void ParameterServer::exposeParameter(int argc, t_atom* argv)
+    rcp_datatype ParameterServer::parseType(const t_atom& atom)
     {
-        // <type> <group> <group> ... <label>
-        // options: @min @max @readonly @order
-
-        if (argc < 2)
+        if (!IsString(atom))
         {
-            post("not enough arguments to expose parameter");
-            return;
-        }
-
-        // check type
-        rcp_datatype datatype = DATATYPE_INVALID;
-        if (!IsString(argv[0]))
-        {
-            post("please provide a valid type (f, i, t, b, s)");
-            return;
+            return DATATYPE_INVALID;
         }
 
-        //
-        const char* type_str = GetString(argv[0]);
+        const char* type_str = GetString(atom);
 
         if (*type_str == 'f' || *type_str == 'F')
         {
             // TODO check pd/max float size!
-            datatype = DATATYPE_FLOAT32;
+            return DATATYPE_FLOAT32;
         }
         else if (*type_str == 'i' || *type_str == 'I')
         {
-            datatype = DATATYPE_INT32;
+            return DATATYPE_INT32;
         }
         else if (*type_str == 't' || *type_str == 'T')
         {
-            datatype = DATATYPE_BOOLEAN;
+            return DATATYPE_BOOLEAN;
         }
         else if (*type_str == 'b' || *type_str == 'B')
         {
-            datatype = DATATYPE_BANG;
+            return DATATYPE_BANG;
         }
         else if (*type_str == 's' || *type_str == 'S')
         {
-            datatype = DATATYPE_STRING;
+            return DATATYPE_STRING;
+        }
+
+        return DATATYPE_INVALID;
+    }
+
+    void ParameterServer::exposeParameter(int argc, t_atom* argv)
+    {
+        // <type> <group> <group> ... <label>
+        // options: @min @max @readonly @order @deadband
+
+        if (argc < 2)
+        {
+            post("not enough arguments to expose parameter");
+            return;
+        }
+
+        // check type
+        if (!IsString(argv[0]))
+        {
+            post("please provide a valid type (f, i, t, b, s)");
+            return;
         }
 
+        rcp_datatype datatype = parseType(argv[0]);
 
         // check datatype
         if (datatype == DATATYPE_INVALID)
         {
-            post("unknown datatype: %s", type_str);
+            post("unknown datatype: %s", GetString(argv[0]));
             return;
         }
 
 
         // arguments
-        Optional<float> min;
-        Optional<float> max;
-        Optional<bool> readonly;
-        Optional<int> order;
+        ParameterOptions options;
 
         // get options - look for first atom starting with @
         int args_index = argc;
@@ -343,7 +993,7 @@ namespace rcp
 
                         if (CanbeFloat(argv[i]))
                         {
-                            min.set(GetAFloat(argv[i]));
+                            options.min.set(GetAFloat(argv[i]));
                         }
                         else
                         {
@@ -358,7 +1008,7 @@ namespace rcp
 
                         if (CanbeFloat(argv[i]))
                         {
-                            max.set(GetAFloat(argv[i]));
+                            options.max.set(GetAFloat(argv[i]));
                         }
                         else
                         {
@@ -373,7 +1023,7 @@ namespace rcp
 
                         if (CanbeInt(argv[i]))
                         {
-                            order.set(GetAInt(argv[i]));
+                            options.order.set(GetAInt(argv[i]));
                         }                        
                         else
                         {
@@ -381,23 +1031,45 @@ namespace rcp
                             error("can not set argument order!");
                         }
                     }
+                    else if (t == "@deadband")
+                    {
+                        i++;
+                        if (i >= argc) break;
+
+                        if (CanbeFloat(argv[i]))
+                        {
+                            options.deadband.set(GetAFloat(argv[i]));
+                        }
+                        else
+                        {
+                            // error
+                            error("can not set argument deadband!");
+                        }
+                    }
                     else if (t == "@readonly")
                     {
-                        readonly.set(true);
+                        options.readonly.set(true);
                     }
                 }
             }
         }
 
+        expose(datatype, args_index-1, argv+1, options);
+    }
+
+    rcp_parameter* ParameterServer::expose(rcp_datatype datatype, int argc, t_atom* argv, const ParameterOptions& options)
+    {
+        // argv: <group> <group> ... <label>
+
         // create necessary groups
         std::string label;
-        rcp_group_parameter* group = createGroups(args_index-1, argv+1, label);
+        rcp_group_parameter* group = createGroups(argc, argv, label);
 
         if (label.empty())
         {
             // no label - can not create parameter
             error("please provide a label to expose a parameter");
-            return;
+            return nullptr;
         }
 
         // check if this label already exists in group
@@ -405,7 +1077,7 @@ namespace rcp
         if (param != NULL)
         {
             error("parameter '%s' already exists", label.c_str());
-            return;
+            return nullptr;
         }
 
 
@@ -418,18 +1090,10 @@ namespace rcp
             setupValueParameter(p);
             if (p != NULL)
             {
-                if (min.isSet()) rcp_parameter_set_min_float(p, min.get());
-                if (max.isSet()) rcp_parameter_set_max_float(p, max.get());
-                if (order.isSet()) rcp_parameter_set_order(RCP_PARAMETER(p), order.get());
-                if (readonly.isSet()) rcp_parameter_set_readonly(RCP_PARAMETER(p), readonly.get() > 0);
-
                 // set default value
                 rcp_parameter_set_value_float(p, 0);
             }
-            else
-            {
-                post("could not create parameter");
-            }
+            param = RCP_PARAMETER(p);
             break;
         }
         case DATATYPE_INT32:
@@ -438,18 +1102,10 @@ namespace rcp
             setupValueParameter(p);
             if (p != NULL)
             {
-                if (min.isSet()) rcp_parameter_set_min_int32(p, (int32_t)min.get());
-                if (max.isSet()) rcp_parameter_set_max_int32(p, (int32_t)max.get());
-                if (order.isSet()) rcp_parameter_set_order(RCP_PARAMETER(p), order.get());
-                if (readonly.isSet()) rcp_parameter_set_readonly(RCP_PARAMETER(p), readonly.get() > 0);
-
                 // set default value
                 rcp_parameter_set_value_int32(p, 0);
             }
-            else
-            {
-                post("could not create parameter");
-            }
+            param = RCP_PARAMETER(p);
             break;
         }
         case DATATYPE_BOOLEAN:
@@ -458,16 +1114,10 @@ namespace rcp
             setupValueParameter(p);
             if (p != NULL)
             {
-                if (order.isSet()) rcp_parameter_set_order(RCP_PARAMETER(p), order.get());
-                if (readonly.isSet()) rcp_parameter_set_readonly(RCP_PARAMETER(p), readonly.get() > 0);
-
                 // set default value
                 rcp_parameter_set_value_bool(p, false);
             }
-            else
-            {
-                post("could not create parameter");
-            }
+            param = RCP_PARAMETER(p);
             break;
         }
         case DATATYPE_STRING:
@@ -476,16 +1126,10 @@ namespace rcp
             setupValueParameter(p);
             if (p != NULL)
             {
-                if (order.isSet()) rcp_parameter_set_order(RCP_PARAMETER(p), order.get());
-                if (readonly.isSet()) rcp_parameter_set_readonly(RCP_PARAMETER(p), readonly.get() > 0);
-
                 // set default value
                 rcp_parameter_set_value_string(p, "");
             }
-            else
-            {
-                post("could not create parameter");
-            }
+            param = RCP_PARAMETER(p);
             break;
         }
         case DATATYPE_BANG:
@@ -493,21 +1137,48 @@ namespace rcp
             rcp_bang_parameter* p = rcp_server_expose_bang(m_server, label.c_str(), group);
             if (p != NULL)
             {
-                if (order.isSet()) rcp_parameter_set_order(RCP_PARAMETER(p), order.get());
-                if (readonly.isSet()) rcp_parameter_set_readonly(RCP_PARAMETER(p), readonly.get() > 0);
-
                 rcp_parameter_set_user(RCP_PARAMETER(p), this);
                 rcp_bang_parameter_set_bang_cb(p, bangCb);
             }
-            else
-            {
-                post("could not create parameter");
-            }
+            param = RCP_PARAMETER(p);
+            break;
+        }
+        default:
             break;
         }
+
+        if (param == NULL)
+        {
+            post("could not create parameter");
+            return nullptr;
         }
 
-        rcp_server_update(m_server);
+        applyOptions(param, options);
+
+        updateServer();
+
+        return param;
+    }
+
+    void ParameterServer::applyOptions(rcp_parameter* parameter, const ParameterOptions& options)
+    {
+        rcp_datatype type = RCP_TYPE_ID(parameter);
+
+        if (type == DATATYPE_FLOAT32)
+        {
+            if (options.min.isSet()) rcp_parameter_set_min_float(RCP_VALUE_PARAMETER(parameter), options.min.get());
+            if (options.max.isSet()) rcp_parameter_set_max_float(RCP_VALUE_PARAMETER(parameter), options.max.get());
+            if (options.deadband.isSet()) setDeadband(parameter, options.deadband.get());
+        }
+        else if (type == DATATYPE_INT32)
+        {
+            if (options.min.isSet()) rcp_parameter_set_min_int32(RCP_VALUE_PARAMETER(parameter), (int32_t)options.min.get());
+            if (options.max.isSet()) rcp_parameter_set_max_int32(RCP_VALUE_PARAMETER(parameter), (int32_t)options.max.get());
+            if (options.deadband.isSet()) setDeadband(parameter, options.deadband.get());
+        }
+
+        if (options.order.isSet()) rcp_parameter_set_order(parameter, options.order.get());
+        if (options.readonly.isSet()) rcp_parameter_set_readonly(parameter, options.readonly.get());
     }
 
 
@@ -544,6 +1215,9 @@ namespace rcp
     {
         if (parameter)
         {
+            // ids can be reused - forget old deadband
+            m_deadbands.erase(rcp_parameter_get_id(RCP_PARAMETER(parameter)));
+
             rcp_parameter_set_user(RCP_PARAMETER(parameter), this);
             rcp_parameter_set_value_updated_cb(parameter, parameterValueUpdatedCb);
         }
@@ -551,9 +1225,12 @@ namespace rcp
 
     void ParameterServer::removeParameter(int id)
     {
+        m_deadbands.erase(id);
+        unbindParameters(id);
+
         if (rcp_server_remove_parameter_id(m_server, id))
         {
-            rcp_server_update(m_server);
+            updateServer();
         }
     }
 
@@ -578,7 +1255,7 @@ namespace rcp
         if (parameter)
         {
             rcp_parameter_set_readonly(parameter, GetAInt(argv[argc-1]) > 0);
-            rcp_server_update(m_server);
+            updateServer();
         }
     }
 
@@ -594,7 +1271,7 @@ namespace rcp
         if (parameter)
         {
             rcp_parameter_set_order(parameter, GetAInt(argv[argc-1]));
-            rcp_server_update(m_server);
+            updateServer();
         }
     }
 
@@ -609,7 +1286,7 @@ namespace rcp
                 if (CanbeFloat(argv[argc-1]))
                 {
                     rcp_parameter_set_min_float(RCP_VALUE_PARAMETER(parameter), GetAFloat(argv[argc-1]));
-                    rcp_server_update(m_server);
+                    updateServer();
                 }
             }
             else if (type == DATATYPE_INT32)
@@ -617,7 +1294,7 @@ namespace rcp
                 if (CanbeInt(argv[argc-1]))
                 {
                     rcp_parameter_set_min_int32(RCP_VALUE_PARAMETER(parameter), GetAInt(argv[argc-1]));
-                    rcp_server_update(m_server);
+                    updateServer();
                 }
             }
         }
@@ -634,7 +1311,7 @@ namespace rcp
                 if (CanbeFloat(argv[argc-1]))
                 {
                     rcp_parameter_set_max_float(RCP_VALUE_PARAMETER(parameter), GetAFloat(argv[argc-1]));
-                    rcp_server_update(m_server);
+                    updateServer();
                 }
             }
             else if (type == DATATYPE_INT32)
@@ -642,7 +1319,7 @@ namespace rcp
                 if (CanbeInt(argv[argc-1]))
                 {
                     rcp_parameter_set_max_int32(RCP_VALUE_PARAMETER(parameter), GetAInt(argv[argc-1]));
-                    rcp_server_update(m_server);
+                    updateServer();
                 }
             }
         }
@@ -666,14 +1343,303 @@ namespace rcp
             {
                 rcp_parameter_set_min_float(RCP_VALUE_PARAMETER(parameter), GetAFloat(argv[argc-2]));
                 rcp_parameter_set_max_float(RCP_VALUE_PARAMETER(parameter), GetAFloat(argv[argc-1]));
-                rcp_server_update(m_server);
+                updateServer();
             }
             else if (type == DATATYPE_INT32)
             {
                 rcp_parameter_set_min_int32(RCP_VALUE_PARAMETER(parameter), GetAInt(argv[argc-2]));
                 rcp_parameter_set_max_int32(RCP_VALUE_PARAMETER(parameter), GetAInt(argv[argc-1]));
-                rcp_server_update(m_server);
+                updateServer();
+            }
+        }
+    }
+
+    // bindings
+
+    void ParameterServer::addBinding(ServerParameter* binding)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+        binding->attach(this);
+
+        std::vector<t_atom>& path = binding->path();
+        rcp_parameter* parameter = expose(binding->type(), (int)path.size(), path.data(), binding->options());
+
+        if (parameter)
+        {
+            m_bindings.insert(std::make_pair(rcp_parameter_get_id(parameter), binding));
+            binding->bound(parameter);
+        }
+    }
+
+    void ParameterServer::removeBinding(ServerParameter* binding)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+        rcp_parameter* parameter = binding->parameter();
+        binding->detach();
+
+        if (parameter)
+        {
+            int16_t id = rcp_parameter_get_id(parameter);
+
+            auto range = m_bindings.equal_range(id);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (it->second == binding)
+                {
+                    m_bindings.erase(it);
+                    break;
+                }
+            }
+
+            // keep the parameter while another [rcp.param] uses it
+            if (m_bindings.count(id) == 0)
+            {
+                removeParameter(id);
+            }
+        }
+    }
+
+    void ParameterServer::sendValue(rcp_parameter* parameter, t_atom& atom)
+    {
+        if (setValue(parameter, atom))
+        {
+            updateValue(parameter);
+        }
+    }
+
+    void ParameterServer::sendBang(rcp_parameter* parameter)
+    {
+        if (rcp_parameter_is_type(parameter, DATATYPE_BANG))
+        {
+            updateValue(parameter);
+        }
+    }
+
+    void ParameterServer::updateOptions(rcp_parameter* parameter, const ParameterOptions& options)
+    {
+        applyOptions(parameter, options);
+        updateServer();
+    }
+
+    void ParameterServer::outputUpdate(rcp_parameter* parameter)
+    {
+        {
+            std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+            // bound parameters only go to their [rcp.param]
+            int16_t id = rcp_parameter_get_id(parameter);
+            auto range = m_bindings.equal_range(id);
+            if (range.first != range.second)
+            {
+                // NOTE: copy - polled, an output may add or remove bindings
+                std::vector<ServerParameter*> bindings;
+                for (auto it = range.first; it != range.second; ++it)
+                {
+                    bindings.push_back(it->second);
+                }
+
+                for (ServerParameter* binding : bindings)
+                {
+                    if (isBound(id, binding))
+                    {
+                        binding->valueUpdated(parameter);
+                    }
+                }
+                return;
+            }
+        }
+
+        ParameterServerClientBase::outputUpdate(parameter);
+    }
+
+    void ParameterServer::unbindParameters(int16_t id)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_bindingLock);
+
+        // unbind the parameter itself and all children if it is a group
+        for (auto it = m_bindings.begin(); it != m_bindings.end();)
+        {
+            bool removed = false;
+
+            rcp_parameter* parameter = it->second->parameter();
+            while (parameter)
+            {
+                if (rcp_parameter_get_id(parameter) == id)
+                {
+                    removed = true;
+                    break;
+                }
+
+                parameter = RCP_PARAMETER(rcp_parameter_get_parent(parameter));
+            }
+
+            if (removed)
+            {
+                it->second->unbound();
+                it = m_bindings.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    // NOTE: binding lock held. does not touch the binding, it may be gone
+    bool ParameterServer::isBound(int16_t id, ServerParameter* binding) const
+    {
+        auto range = m_bindings.equal_range(id);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second == binding)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // deadband
+
+    void ParameterServer::setDeadband(rcp_parameter* parameter, float deadband)
+    {
+        rcp_datatype type = RCP_TYPE_ID(parameter);
+        if (type != DATATYPE_FLOAT32 &&
+                type != DATATYPE_INT32)
+        {
+            error("deadband only applies to float and int parameters");
+            return;
+        }
+
+        int16_t id = rcp_parameter_get_id(parameter);
+
+        if (deadband <= 0)
+        {
+            m_deadbands.erase(id);
+            return;
+        }
+
+        Deadband& db = m_deadbands[id];
+        db.band = deadband;
+        db.pending = false;
+    }
+
+    void ParameterServer::parameterSetDeadband(int argc, t_atom* argv)
+    {
+        if (argc < 2 ||
+                !CanbeFloat(argv[argc-1]))
+        {
+            error("rcp set deadband - invalid data");
+            return;
+        }
+
+        rcp_parameter* parameter = getParameter(argc-1, argv);
+        if (parameter)
+        {
+            setDeadband(parameter, GetAFloat(argv[argc-1]));
+        }
+    }
+
+    void ParameterServer::setDeadbandRefresh(const float& f)
+    {
+        m_deadbandRefresh = f;
+
+        if (m_deadbandRefresh > 0)
+        {
+            m_deadbandTimer.Periodic(m_deadbandRefresh, this);
+        }
+        else
+        {
+            m_deadbandTimer.Reset();
+        }
+    }
+
+    void ParameterServer::getDeadbandRefresh(float& f)
+    {
+        f = m_deadbandRefresh;
+    }
+
+    bool ParameterServer::setValue(rcp_parameter* parameter, t_atom& atom)
+    {
+        if (parameter == nullptr ||
+                m_deadbands.empty())
+        {
+            return ParameterServerClientBase::setValue(parameter, atom);
+        }
+
+        auto it = m_deadbands.find(rcp_parameter_get_id(parameter));
+        if (it == m_deadbands.end() ||
+                !CanbeFloat(atom))
+        {
+            return ParameterServerClientBase::setValue(parameter, atom);
+        }
+
+        Deadband& db = it->second;
+        float value = GetAFloat(atom);
+        float current = 0;
+
+        rcp_datatype type = RCP_TYPE_ID(parameter);
+        if (type == DATATYPE_FLOAT32)
+        {
+            current = rcp_parameter_get_value_float(RCP_VALUE_PARAMETER(parameter));
+        }
+        else if (type == DATATYPE_INT32)
+        {
+            value = (float)GetAInt(atom);
+            current = (float)rcp_parameter_get_value_int32(RCP_VALUE_PARAMETER(parameter));
+        }
+        else
+        {
+            return ParameterServerClientBase::setValue(parameter, atom);
+        }
+
+        if (std::fabs(value - current) < db.band)
+        {
+            // suppress - keep for refresh
+            db.pending = (value != current);
+            db.value = value;
+            return false;
+        }
+
+        db.pending = false;
+        return ParameterServerClientBase::setValue(parameter, atom);
+    }
+
+    void ParameterServer::deadbandRefresh()
+    {
+        for (auto it = m_deadbands.begin(); it != m_deadbands.end();)
+        {
+            Deadband& db = it->second;
+
+            rcp_parameter* parameter = rcp_manager_get_parameter(m_manager, it->first);
+            if (parameter == nullptr)
+            {
+                // parameter is gone
+                it = m_deadbands.erase(it);
+                continue;
+            }
+
+            if (db.pending)
+            {
+                db.pending = false;
+
+                rcp_datatype type = RCP_TYPE_ID(parameter);
+                if (type == DATATYPE_FLOAT32)
+                {
+                    rcp_parameter_set_value_float(RCP_VALUE_PARAMETER(parameter), db.value);
+                    updateValue(parameter);
+                }
+                else if (type == DATATYPE_INT32)
+                {
+                    rcp_parameter_set_value_int32(RCP_VALUE_PARAMETER(parameter), (int32_t)db.value);
+                    updateValue(parameter);
+                }
             }
+
+            ++it;
         }
     }
 
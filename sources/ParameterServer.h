@@ -39,6 +39,9 @@
 #define PARAMETERSERVER_H
 
 #include <vector>
+#include <map>
+#include <mutex>
+#include <unordered_map>
 
 #include <rcp_server.h>
 
@@ -46,6 +49,8 @@
 #include "PdServerTransporter.h"
 #include "IServerTransporter.h"
 #include "websocketServer.h"
+#include "Optional.h"
+#include "SocketOptions.h"
 
 #define RCP_WS_DEFAULT_PORT 10000
 
@@ -54,7 +59,20 @@ namespace rcp
 
     class ParameterBase;
     class RabbitHoleServerTransporter;
+    class RabbitholeMuxServerTransporter;
+    class ShmServerTransporter;
+    class WebsocketServerTransporter;
+    class ServerParameter;
 
+    // options for exposing a parameter
+    struct ParameterOptions
+    {
+        Optional<float> min;
+        Optional<float> max;
+        Optional<bool> readonly;
+        Optional<int> order;
+        Optional<float> deadband;
+    };
 
     class ParameterServer : public ParameterServerClientBase, public IWebsocketServerListener
     {
@@ -67,6 +85,21 @@ namespace rcp
 
         rcp_server* server() const { return m_server; }
 
+        void flushUpdate();
+        // send pending snapshots, then everything dirty
+        void updateServer();
+        void outputStats();
+        void deadbandRefresh();
+
+        // bindings: [rcp.param]
+        void addBinding(ServerParameter* binding);
+        void removeBinding(ServerParameter* binding);
+        void sendValue(rcp_parameter* parameter, t_atom& atom);
+        void sendBang(rcp_parameter* parameter);
+        void updateOptions(rcp_parameter* parameter, const ParameterOptions& options);
+
+        static rcp_datatype parseType(const t_atom& atom);
+
     public:
         // IWebsocketServerListener
         void connected(void* client) override;
@@ -80,9 +113,32 @@ namespace rcp
             // server
             FLEXT_CADDATTR_GET(c, "port", getPort);
             FLEXT_CADDMETHOD_I(c, 0, "listen", listen);
+            FLEXT_CADDATTR_VAR(c, "path", getPath, setPath);
+            FLEXT_CADDATTR_VAR(c, "udp", getUdp, setUdp);
+            FLEXT_CADDATTR_VAR(c, "direct", getDirect, setDirect);
+            FLEXT_CADDATTR_VAR(c, "threads", getThreads, setThreads);
+            FLEXT_CADDATTR_VAR(c, "async", getAsync, setAsync);
+            FLEXT_CADDATTR_VAR(c, "coalesce", getCoalesce, setCoalesce);
+            // socket options
+            FLEXT_CADDATTR_VAR(c, "nodelay", getNodelay, setNodelay);
+            FLEXT_CADDATTR_VAR(c, "sndbuf", getSndbuf, setSndbuf);
+            FLEXT_CADDATTR_VAR(c, "rcvbuf", getRcvbuf, setRcvbuf);
+            FLEXT_CADDATTR_VAR(c, "tos", getTos, setTos);
+            // admission control
+            FLEXT_CADDATTR_VAR(c, "maxclients", getMaxClients, setMaxClients);
+            FLEXT_CADDATTR_VAR(c, "maxrate", getMaxRate, setMaxRate);
+            // keepalive
+            FLEXT_CADDATTR_VAR(c, "ping_interval", getPingInterval, setPingInterval);
+            FLEXT_CADDATTR_VAR(c, "ping_timeout", getPingTimeout, setPingTimeout);
+            // connection statistics
+            FLEXT_CADDMETHOD_(c, 0, "stats", m_stats);
+            FLEXT_CADDATTR_VAR(c, "stats_interval", getStatsInterval, setStatsInterval);
             // rabbithole
             FLEXT_CADDATTR_VAR(c, "rabbithole", getRabbithole, setRabbithole);
             FLEXT_CADDATTR_VAR(c, "rabbithole_interval", getRabbitholeInterval, setRabbitholeInterval);
+            FLEXT_CADDATTR_VAR(c, "rabbithole_mux", getRabbitholeMux, setRabbitholeMux);
+            // shared memory
+            FLEXT_CADDATTR_VAR(c, "shm", getShm, setShm);
 
             // parameter
             FLEXT_CADDMETHOD_(c, 0, "expose", exposeParameter);
@@ -95,18 +151,68 @@ namespace rcp
             FLEXT_CADDMETHOD_(c, 0, "setmin", parameterSetMin);
             FLEXT_CADDMETHOD_(c, 0, "setmax", parameterSetMax);
             FLEXT_CADDMETHOD_(c, 0, "setminmax", parameterSetMinMax);
+            // deadband
+            FLEXT_CADDMETHOD_(c, 0, "setdeadband", parameterSetDeadband);
+            FLEXT_CADDATTR_VAR(c, "deadband_refresh", getDeadbandRefresh, setDeadbandRefresh);
         }
 
         void handle_raw_data(char* /*data*/, size_t /*size*/) override;
+        bool setValue(rcp_parameter* parameter, t_atom& atom) override;
+        void updateManager() override;
+        void updateValue(rcp_parameter* parameter) override;
+        void outputUpdate(rcp_parameter* parameter) override;
 
         // port
         void getPort(int& p);
         void listen(int& p);
+        // shared port
+        void setPath(const t_symbol *&d);
+        void getPath(const t_symbol *&d);
+        // udp
+        void setUdp(const int& port);
+        void getUdp(int& port);
+        // direct dispatch
+        void setDirect(const bool& b);
+        void getDirect(bool& b);
+        // io threads
+        void setThreads(const int& i);
+        void getThreads(int& i);
+        // async
+        void setAsync(const bool& b);
+        void getAsync(bool& b);
+        // socket options
+        void setNodelay(const bool& b);
+        void getNodelay(bool& b);
+        void setSndbuf(const int& i);
+        void getSndbuf(int& i);
+        void setRcvbuf(const int& i);
+        void getRcvbuf(int& i);
+        void setTos(const int& i);
+        void getTos(int& i);
+        // admission control
+        void setMaxClients(const int& i);
+        void getMaxClients(int& i);
+        void setMaxRate(const float& f);
+        void getMaxRate(float& f);
+        // keepalive
+        void setPingInterval(const float& f);
+        void getPingInterval(float& f);
+        void setPingTimeout(const float& f);
+        void getPingTimeout(float& f);
+        // connection statistics
+        void m_stats();
+        void setStatsInterval(const float& f);
+        void getStatsInterval(float& f);
         // rabbithole
         void setRabbithole(const t_symbol *&d);
         void getRabbithole(const t_symbol *&d);
         void setRabbitholeInterval(const int &i);
         void getRabbitholeInterval(int &i);
+        void setRabbitholeMux(const bool& b);
+        void getRabbitholeMux(bool& b);
+        // shared memory
+        void setShm(const t_symbol *&d);
+        void getShm(const t_symbol *&d);
         // parameter
         void exposeParameter(int argc, t_atom* argv);
         void removeParameter(int id);
@@ -118,20 +224,78 @@ namespace rcp
         void parameterSetMin(int argc, t_atom* argv);
         void parameterSetMax(int argc, t_atom* argv);
         void parameterSetMinMax(int argc, t_atom* argv);
+        // deadband
+        void parameterSetDeadband(int argc, t_atom* argv);
+        void setDeadbandRefresh(const float& f);
+        void getDeadbandRefresh(float& f);
 
     private:
+        rcp_parameter* expose(rcp_datatype datatype, int argc, t_atom* argv, const ParameterOptions& options);
+        void applyOptions(rcp_parameter* parameter, const ParameterOptions& options);
         rcp_group_parameter* createGroups(int argc, t_atom* argv, std::string& outLabel);
         void setupValueParameter(rcp_value_parameter* parameter);
+        void setupTransporter(WebsocketServerTransporter* transporter);
+        void applySocketOptions();
+        void applyKeepalive();
+        void applyAdmission();
+        void disposeTransporter();
+        static void dispose(std::shared_ptr<IServerTransporter> transporter);
+        void setDeadband(rcp_parameter* parameter, float deadband);
+        void unbindParameters(int16_t id);
+        bool isBound(int16_t id, ServerParameter* binding) const;
 
     private:
         // port
         FLEXT_CALLGET_I(getPort)
         FLEXT_CALLBACK_I(listen)
+        // shared port
+        FLEXT_CALLSET_S(setPath)
+        FLEXT_CALLGET_S(getPath)
+        // udp
+        FLEXT_CALLSET_I(setUdp)
+        FLEXT_CALLGET_I(getUdp)
+        // direct dispatch
+        FLEXT_CALLSET_B(setDirect)
+        FLEXT_CALLGET_B(getDirect)
+        // io threads
+        FLEXT_CALLSET_I(setThreads)
+        FLEXT_CALLGET_I(getThreads)
+        // async
+        FLEXT_CALLSET_B(setAsync)
+        FLEXT_CALLGET_B(getAsync)
+        // socket options
+        FLEXT_CALLSET_B(setNodelay)
+        FLEXT_CALLGET_B(getNodelay)
+        FLEXT_CALLSET_I(setSndbuf)
+        FLEXT_CALLGET_I(getSndbuf)
+        FLEXT_CALLSET_I(setRcvbuf)
+        FLEXT_CALLGET_I(getRcvbuf)
+        FLEXT_CALLSET_I(setTos)
+        FLEXT_CALLGET_I(getTos)
+        // admission control
+        FLEXT_CALLSET_I(setMaxClients)
+        FLEXT_CALLGET_I(getMaxClients)
+        FLEXT_CALLSET_F(setMaxRate)
+        FLEXT_CALLGET_F(getMaxRate)
+        // keepalive
+        FLEXT_CALLSET_F(setPingInterval)
+        FLEXT_CALLGET_F(getPingInterval)
+        FLEXT_CALLSET_F(setPingTimeout)
+        FLEXT_CALLGET_F(getPingTimeout)
+        // connection statistics
+        FLEXT_CALLBACK(m_stats)
+        FLEXT_CALLSET_F(setStatsInterval)
+        FLEXT_CALLGET_F(getStatsInterval)
         // rabbithole
         FLEXT_CALLSET_S(setRabbithole)
         FLEXT_CALLGET_S(getRabbithole)
         FLEXT_CALLSET_I(setRabbitholeInterval)
         FLEXT_CALLGET_I(getRabbitholeInterval)
+        FLEXT_CALLSET_B(setRabbitholeMux)
+        FLEXT_CALLGET_B(getRabbitholeMux)
+        // shared memory
+        FLEXT_CALLSET_S(setShm)
+        FLEXT_CALLGET_S(getShm)
         // parameter
         FLEXT_CALLBACK_V(exposeParameter)
         FLEXT_CALLBACK_I(removeParameter)
@@ -143,14 +307,76 @@ namespace rcp
         FLEXT_CALLBACK_V(parameterSetMin)
         FLEXT_CALLBACK_V(parameterSetMax)
         FLEXT_CALLBACK_V(parameterSetMinMax)
+        // deadband
+        FLEXT_CALLBACK_V(parameterSetDeadband)
+        FLEXT_CALLSET_F(setDeadbandRefresh)
+        FLEXT_CALLGET_F(getDeadbandRefresh)
 
     private:
+        struct Deadband
+        {
+            float band{0};
+            // last suppressed value
+            bool pending{false};
+            float value{0};
+        };
+
         rcp_server* m_server{nullptr};
         std::shared_ptr<IServerTransporter> m_transporter;
         std::shared_ptr<RabbitHoleServerTransporter> m_rabbitholeTransporter;
+        std::shared_ptr<RabbitholeMuxServerTransporter> m_rabbitholeMuxTransporter;
+        std::shared_ptr<ShmServerTransporter> m_shmTransporter;
 
         bool m_raw;
         int m_clientCount;
+        // no network threads
+        bool m_polled{false};
+        // plain tcp instead of websocket
+        bool m_tcp{false};
+        // path on a shared listener - empty: own listener
+        std::string m_path;
+        // udp side channel port - 0: off
+        int m_udpPort{0};
+        // handle websocket events on the io thread
+        bool m_direct{false};
+        // threads running the websocket io loop
+        int m_threads{1};
+        // share the relay connection with other servers
+        bool m_rabbitholeMux{false};
+        // websocket tcp options
+        SocketOptions m_socketOptions;
+        // admission control - 0: no limit
+        int m_maxClients{0};
+        // new connections per second and address
+        float m_maxRate{0};
+        // keepalive in seconds - interval 0: off
+        float m_pingInterval{0};
+        float m_pingTimeout{5};
+
+        // named server
+        const t_symbol* m_name{nullptr};
+        // bindings get added and removed on the main thread, updated on the
+        // network thread.
+        // recursive: when polled a binding's output may add or remove bindings
+        std::recursive_mutex m_bindingLock;
+        // bound [rcp.param] by parameter id - several may share a path
+        std::unordered_multimap<int16_t, ServerParameter*> m_bindings;
+
+        // async: pd only snapshots values, a background encoder serializes
+        // them and hands them to the io thread.
+        // everything else is batched once per tick
+        bool m_async{false};
+        bool m_updatePending{false};
+        flext::Timer m_updateTimer;
+
+        // deadband per parameter id
+        std::map<int16_t, Deadband> m_deadbands;
+        float m_deadbandRefresh{0};
+        flext::Timer m_deadbandTimer;
+
+        // push connection statistics every interval seconds - 0: off
+        float m_statsInterval{0};
+        flext::Timer m_statsTimer;
     };
 
 }
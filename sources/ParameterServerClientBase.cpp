@@ -143,6 +143,15 @@ namespace rcp
         return "unknown";
     }
 
+    static void coalesceTimerCb(void* user)
+    {
+        if (user)
+        {
+            ParameterServerClientBase* x = static_cast<ParameterServerClientBase*>(user);
+            x->flushCoalesced();
+        }
+    }
+
 
     ParameterServerClientBase::ParameterServerClientBase() :
         m_manager(nullptr)
@@ -169,6 +178,13 @@ namespace rcp
         AddOutInt();
         // add info outlet
         AddOutAnything();
+
+        m_coalesceTimer.SetCallback(coalesceTimerCb);
+    }
+
+    ParameterServerClientBase::~ParameterServerClientBase()
+    {
+        m_coalesceTimer.Reset();
     }
 
 
@@ -203,19 +219,38 @@ namespace rcp
             }
             else if (rcp_parameter_is_type(parameter, DATATYPE_BANG))
             {
-                rcp_manager_set_dirty(m_manager, parameter);
-                rcp_manager_update(m_manager);
+                updateValue(parameter);
                 return;
             }
 
             // set value
-            if (setAtomValue(parameter, argv[argc-1]))
+            if (setValue(parameter, argv[argc-1]))
             {
-                rcp_manager_update(m_manager);
+                updateValue(parameter);
             }
         }
     }
 
+    bool ParameterServerClientBase::setValue(rcp_parameter* parameter, t_atom& atom)
+    {
+        return setAtomValue(parameter, atom);
+    }
+
+    void ParameterServerClientBase::updateManager()
+    {
+        rcp_manager_update(m_manager);
+    }
+
+    void ParameterServerClientBase::updateValue(rcp_parameter* parameter)
+    {
+        if (rcp_parameter_is_type(parameter, DATATYPE_BANG))
+        {
+            rcp_manager_set_dirty(m_manager, parameter);
+        }
+
+        updateManager();
+    }
+
     void ParameterServerClientBase::m_list(int argc, t_atom* argv)
     {
         // <id> <value>
@@ -234,9 +269,9 @@ namespace rcp
             rcp_parameter* p = rcp_manager_get_parameter(m_manager, id);
             // TODO: check for group and bang parameter
 
-            if (setAtomValue(p, argv[argc-1]))
+            if (setValue(p, argv[argc-1]))
             {
-                rcp_manager_update(m_manager);
+                updateValue(p);
                 return;
             }
         }
@@ -657,6 +692,79 @@ namespace rcp
     }
 
     void ParameterServerClientBase::parameterUpdate(rcp_parameter* parameter)
+    {
+        if (m_coalesce &&
+                !rcp_parameter_is_type(parameter, DATATYPE_BANG))
+        {
+            // remember parameter, value gets read when flushing
+            std::lock_guard<std::mutex> guard(m_coalesceLock);
+
+            // may have been switched off meanwhile
+            if (m_coalesce)
+            {
+                int16_t id = rcp_parameter_get_id(parameter);
+                if (m_coalesceSet.insert(id).second)
+                {
+                    m_coalesceIds.push_back(id);
+                }
+
+                return;
+            }
+        }
+
+        outputUpdate(parameter);
+    }
+
+    void ParameterServerClientBase::flushCoalesced()
+    {
+        std::vector<int16_t> ids;
+
+        {
+            std::lock_guard<std::mutex> guard(m_coalesceLock);
+            if (m_coalesceIds.empty())
+            {
+                return;
+            }
+
+            ids.swap(m_coalesceIds);
+            m_coalesceSet.clear();
+        }
+
+        for (int16_t id : ids)
+        {
+            // parameter might have been removed meanwhile
+            rcp_parameter* parameter = rcp_manager_get_parameter(m_manager, id);
+            if (parameter)
+            {
+                outputUpdate(parameter);
+            }
+        }
+    }
+
+    void ParameterServerClientBase::setCoalesce(const bool& b)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_coalesceLock);
+            m_coalesce = b;
+        }
+
+        if (m_coalesce)
+        {
+            m_coalesceTimer.Periodic(RCP_COALESCE_INTERVAL, this);
+        }
+        else
+        {
+            m_coalesceTimer.Reset();
+            flushCoalesced();
+        }
+    }
+
+    void ParameterServerClientBase::getCoalesce(bool& b)
+    {
+        b = m_coalesce;
+    }
+
+    void ParameterServerClientBase::outputUpdate(rcp_parameter* parameter)
     {
         const char* label = rcp_parameter_get_label(parameter);
         int16_t id = rcp_parameter_get_id(parameter);
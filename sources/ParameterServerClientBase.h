@@ -38,14 +38,22 @@
 #ifndef PARAMETERSERVERCLIENTBASE_H
 #define PARAMETERSERVERCLIENTBASE_H
 
+#include <atomic>
 #include <vector>
 #include <string>
+#include <mutex>
+#include <unordered_set>
 
 #include <flext.h>
 
 #include <rcp_parameter_type.h>
 #include <rcp_manager_type.h>
 
+// coalesce flush interval in seconds - effectively once per scheduler tick
+#ifndef RCP_COALESCE_INTERVAL
+#define RCP_COALESCE_INTERVAL 0.001
+#endif
+
 namespace rcp
 {
     class ParameterServerClientBase : public flext_base
@@ -54,8 +62,10 @@ namespace rcp
 
     public:
         ParameterServerClientBase();
+        ~ParameterServerClientBase();
 
         void parameterUpdate(rcp_parameter* parameter);
+        void flushCoalesced();
 
         void dataOut(char* data, size_t size) const;
 
@@ -76,6 +86,21 @@ namespace rcp
         FLEXT_CALLBACK_V(raw_data_list)
         virtual void handle_raw_data(char* /*data*/, size_t /*size*/) = 0;
 
+        // set value from pd - returns true if value was set
+        virtual bool setValue(rcp_parameter* parameter, t_atom& atom);
+        // called after values were set from pd
+        virtual void updateManager();
+        // called after the value of one parameter was set (or banged) from pd
+        virtual void updateValue(rcp_parameter* parameter);
+        // output parameter value to pd
+        virtual void outputUpdate(rcp_parameter* parameter);
+
+        // coalesce
+        void setCoalesce(const bool& b);
+        void getCoalesce(bool& b);
+        FLEXT_CALLSET_B(setCoalesce)
+        FLEXT_CALLGET_B(getCoalesce)
+
 
     protected:
         std::string GetAsString(const t_atom &a);
@@ -99,6 +124,16 @@ namespace rcp
     private:         
         void _outputInfo(rcp_parameter* parameter, int argc, t_atom* argv);
         void _input(rcp_parameter* parameter, int argc, t_atom* argv);
+
+    private:
+        // coalesce: only output the latest value per parameter once per tick
+        // NOTE: updates may arrive on network threads - the timer only
+        // gets armed from the main thread (setCoalesce) and runs periodically
+        std::atomic<bool> m_coalesce{false};
+        std::vector<int16_t> m_coalesceIds;
+        std::unordered_set<int16_t> m_coalesceSet;
+        std::mutex m_coalesceLock;
+        flext::Timer m_coalesceTimer;
     };
 
 }
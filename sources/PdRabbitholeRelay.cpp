@@ -0,0 +1,176 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "PdRabbitholeRelay.h"
+
+#include <string>
+
+#include "Reaper.h"
+
+namespace rcp
+{
+
+    PdRabbitholeRelay::PdRabbitholeRelay(int argc, t_atom *argv)
+    {
+        // tunnels
+        AddOutInt(0);
+        // connections
+        AddOutInt(1);
+
+        // [rcp.rabbithole <port>]
+        // option symbol: -poll - no network threads, io is polled from the scheduler
+
+        uint16_t port = 0;
+        for (int i=0; i<argc; i++)
+        {
+            if (IsString(argv[i]))
+            {
+                if (std::string(GetString(argv[i])) == "-poll")
+                {
+                    m_polled = true;
+                }
+            }
+            else if (port == 0 &&
+                     CanbeInt(argv[i]))
+            {
+                int p = GetAInt(argv[i], -1);
+
+                if (p > 0 &&
+                        p <= (int)UINT16_MAX)
+                {
+                    port = p;
+                }
+            }
+        }
+
+        if (port > 0)
+        {
+            m_relay = std::make_shared<RabbitholeRelay>(this, m_polled);
+            m_relay->run(port);
+        }
+    }
+
+    PdRabbitholeRelay::~PdRabbitholeRelay()
+    {
+        disposeRelay();
+    }
+
+    void PdRabbitholeRelay::disposeRelay()
+    {
+        if (!m_relay)
+        {
+            return;
+        }
+
+        if (!m_polled)
+        {
+            // no more calls to us - threads finish shutting down in the background
+            m_relay->detach_events();
+            Reaper::dispose(m_relay);
+        }
+
+        m_relay.reset();
+    }
+
+    void PdRabbitholeRelay::outputCounts()
+    {
+        ToOutInt(1, m_relay->connections());
+        ToOutInt(0, m_relay->tunnels());
+    }
+
+    // IWebsocketServerListener
+    void PdRabbitholeRelay::connected(void* /*client*/)
+    {
+        outputCounts();
+    }
+
+    void PdRabbitholeRelay::disconnected(void* /*client*/)
+    {
+        outputCounts();
+    }
+
+    void PdRabbitholeRelay::socketerror(const char* reason)
+    {
+        error("rcp.rabbithole: could not bind to port %d: %s", m_relay->port(), reason);
+    }
+
+
+
+    void PdRabbitholeRelay::m_listen(int& port)
+    {
+        int p = port;
+        if (p > (int)UINT16_MAX)
+        {
+            return;
+        }
+
+        if (m_relay && p == m_relay->port())
+        {
+            return;
+        }
+
+        disposeRelay();
+
+        if (p > 0)
+        {
+            m_relay = std::make_shared<RabbitholeRelay>(this, m_polled);
+            m_relay->setPublicSession(m_publicSession);
+            m_relay->run(p);
+        }
+
+        ToOutInt(1, 0);
+        ToOutInt(0, 0);
+    }
+
+    void PdRabbitholeRelay::setPublicSession(const int& s)
+    {
+        // applies to servers connecting from now on
+        m_publicSession = s > 0 ? s : 0;
+
+        if (m_relay)
+        {
+            m_relay->setPublicSession(m_publicSession);
+        }
+    }
+
+    void PdRabbitholeRelay::getPublicSession(int& s)
+    {
+        s = m_publicSession;
+    }
+
+    FLEXT_LIB_V("rcp.rabbithole", PdRabbitholeRelay);
+}
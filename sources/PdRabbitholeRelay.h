@@ -0,0 +1,93 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef PDRABBITHOLERELAY_H
+#define PDRABBITHOLERELAY_H
+
+#include <memory>
+
+#include <flext.h>
+
+#include "RabbitholeRelay.h"
+
+namespace rcp
+{
+
+    class PdRabbitholeRelay : public flext_base, public IWebsocketServerListener
+    {
+        FLEXT_HEADER_S(PdRabbitholeRelay, flext_base, setup)
+
+    public:
+        PdRabbitholeRelay(int argc, t_atom *argv);
+        ~PdRabbitholeRelay();
+
+    public:
+        // IWebsocketServerListener
+        void connected(void* client) override;
+        void disconnected(void* client) override;
+        void received(char* /*data*/, size_t /*size*/, void* /*id*/) override {}
+        void socketerror(const char* reason) override;
+
+    protected:
+        static void setup(t_classid c)
+        {
+            FLEXT_CADDMETHOD_(c, 0, "listen", m_listen);
+            FLEXT_CADDATTR_VAR(c, "public_session", getPublicSession, setPublicSession);
+        }
+
+        void m_listen(int& port);
+        void setPublicSession(const int& s);
+        void getPublicSession(int& s);
+
+    private:
+        void disposeRelay();
+        void outputCounts();
+
+    private:
+        FLEXT_CALLBACK_I(m_listen)
+        FLEXT_CALLSET_I(setPublicSession)
+        FLEXT_CALLGET_I(getPublicSession)
+
+    private:
+        std::shared_ptr<RabbitholeRelay> m_relay;
+        bool m_polled{false};
+        int m_publicSession{0};
+    };
+
+}
+
+#endif // PDRABBITHOLERELAY_H
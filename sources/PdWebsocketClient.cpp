@@ -38,6 +38,7 @@
 #include "PdWebsocketClient.h"
 
 #include <vector>
+#include <string>
 
 #include <rcp_packet.h>
 #include <rcp_parameter.h>
@@ -45,11 +46,26 @@
 #include <rcp_memory.h>
 #include <rcp_logging.h>
 
+#include "Reaper.h"
+
 namespace rcp
 {
 
-    PdWebsocketClient::PdWebsocketClient()
+    PdWebsocketClient::PdWebsocketClient(int argc, t_atom *argv)
     {
+        // [ws.client]
+        // option symbol: -poll - no network threads, io is polled from the scheduler
+
+        bool polled = false;
+        for (int i=0; i<argc; i++)
+        {
+            if (IsString(argv[i]) &&
+                    std::string(GetString(argv[i])) == "-poll")
+            {
+                polled = true;
+            }
+        }
+
         AddInList(0);
         FLEXT_ADDMETHOD(0, m_list);
 
@@ -61,7 +77,29 @@ namespace rcp
         AddOutInt(1);
 
         // create client
-        m_client = std::make_shared<WebsocketClientImpl>(this);
+        m_client = std::make_shared<WebsocketClientImpl>(this, polled);
+    }
+
+    PdWebsocketClient::~PdWebsocketClient()
+    {
+        disposeClient();
+    }
+
+    void PdWebsocketClient::disposeClient()
+    {
+        if (!m_client)
+        {
+            return;
+        }
+
+        if (!m_client->polled())
+        {
+            // no more calls to us - threads finish shutting down in the background
+            m_client->detachEvents();
+            Reaper::dispose(m_client);
+        }
+
+        m_client.reset();
     }
 
     // websocketClient
@@ -82,13 +120,14 @@ namespace rcp
 
     void PdWebsocketClient::received(char* data, size_t size)
     {
-        std::vector<t_atom> list(size);
+        // NOTE: only called from one network thread - reuse the atoms
+        m_atoms.resize(size);
         for (size_t i=0; i<size; i++)
         {
-            SetInt(list[i], data[i]);
+            SetInt(m_atoms[i], data[i]);
         }
 
-        ToOutList(0, size, list.data());
+        ToOutList(0, size, m_atoms.data());
     }
 
     void PdWebsocketClient::received(const std::string& msg)
@@ -141,5 +180,98 @@ namespace rcp
         m_client->disconnect();
     }
 
-    FLEXT_LIB("ws.client", PdWebsocketClient);
+    // socket options
+
+    void PdWebsocketClient::setNodelay(const bool& b)
+    {
+        m_socketOptions.noDelay = b;
+        applySocketOptions();
+    }
+
+    void PdWebsocketClient::getNodelay(bool& b)
+    {
+        b = m_socketOptions.noDelay;
+    }
+
+    void PdWebsocketClient::setSndbuf(const int& i)
+    {
+        m_socketOptions.sendBuffer = i > 0 ? i : 0;
+        applySocketOptions();
+    }
+
+    void PdWebsocketClient::getSndbuf(int& i)
+    {
+        i = m_socketOptions.sendBuffer;
+    }
+
+    void PdWebsocketClient::setRcvbuf(const int& i)
+    {
+        m_socketOptions.receiveBuffer = i > 0 ? i : 0;
+        applySocketOptions();
+    }
+
+    void PdWebsocketClient::getRcvbuf(int& i)
+    {
+        i = m_socketOptions.receiveBuffer;
+    }
+
+    void PdWebsocketClient::setTos(const int& i)
+    {
+        if (i < 0 || i > 255)
+        {
+            error("invalid tos: %d", i);
+            return;
+        }
+
+        m_socketOptions.tos = i;
+        applySocketOptions();
+    }
+
+    void PdWebsocketClient::getTos(int& i)
+    {
+        i = m_socketOptions.tos;
+    }
+
+    void PdWebsocketClient::applySocketOptions()
+    {
+        // applies on next connect
+        if (m_client)
+        {
+            m_client->setSocketOptions(m_socketOptions);
+        }
+    }
+
+    // keepalive
+
+    void PdWebsocketClient::setPingInterval(const float& f)
+    {
+        m_pingInterval = f > 0 ? f : 0;
+        applyKeepalive();
+    }
+
+    void PdWebsocketClient::getPingInterval(float& f)
+    {
+        f = m_pingInterval;
+    }
+
+    void PdWebsocketClient::setPingTimeout(const float& f)
+    {
+        m_pingTimeout = f > 0 ? f : 0;
+        applyKeepalive();
+    }
+
+    void PdWebsocketClient::getPingTimeout(float& f)
+    {
+        f = m_pingTimeout;
+    }
+
+    void PdWebsocketClient::applyKeepalive()
+    {
+        if (m_client)
+        {
+            m_client->setKeepalive(uint32_t(m_pingInterval * 1000), uint32_t(m_pingTimeout * 1000));
+        }
+    }
+
+    FLEXT_LIB_V("ws.client", PdWebsocketClient);
 }
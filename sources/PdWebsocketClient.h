@@ -38,9 +38,12 @@
 #ifndef PDWEBSOCKETCLIENT_H
 #define PDWEBSOCKETCLIENT_H
 
+#include <vector>
+
 #include <flext.h>
 
 #include "WebsocketClientImpl.h"
+#include "SocketOptions.h"
 
 namespace rcp
 {
@@ -50,7 +53,8 @@ namespace rcp
         FLEXT_HEADER_S(PdWebsocketClient, flext_base, setup)
 
     public:
-        PdWebsocketClient();
+        PdWebsocketClient(int argc, t_atom *argv);
+        ~PdWebsocketClient();
 
     public:
         // IWebsocketClientListener
@@ -65,20 +69,72 @@ namespace rcp
         {
             FLEXT_CADDMETHOD_(c, 0, "open", m_open);
             FLEXT_CADDMETHOD_(c, 0, "close", m_close);
+
+            // socket options
+            FLEXT_CADDATTR_VAR(c, "nodelay", getNodelay, setNodelay);
+            FLEXT_CADDATTR_VAR(c, "sndbuf", getSndbuf, setSndbuf);
+            FLEXT_CADDATTR_VAR(c, "rcvbuf", getRcvbuf, setRcvbuf);
+            FLEXT_CADDATTR_VAR(c, "tos", getTos, setTos);
+
+            // keepalive
+            FLEXT_CADDATTR_VAR(c, "ping_interval", getPingInterval, setPingInterval);
+            FLEXT_CADDATTR_VAR(c, "ping_timeout", getPingTimeout, setPingTimeout);
         }
 
         void m_list(int argc, t_atom* argv);
         void m_open(const t_symbol *d);
         void m_close();
 
+        // socket options
+        void setNodelay(const bool& b);
+        void getNodelay(bool& b);
+        void setSndbuf(const int& i);
+        void getSndbuf(int& i);
+        void setRcvbuf(const int& i);
+        void getRcvbuf(int& i);
+        void setTos(const int& i);
+        void getTos(int& i);
+
+        // keepalive
+        void setPingInterval(const float& f);
+        void getPingInterval(float& f);
+        void setPingTimeout(const float& f);
+        void getPingTimeout(float& f);
+
+
+    private:
+        void disposeClient();
+        void applySocketOptions();
+        void applyKeepalive();
 
     private:
         FLEXT_CALLBACK_V(m_list)
         FLEXT_CALLBACK_S(m_open)
         FLEXT_CALLBACK(m_close)
 
+        FLEXT_CALLSET_B(setNodelay)
+        FLEXT_CALLGET_B(getNodelay)
+        FLEXT_CALLSET_I(setSndbuf)
+        FLEXT_CALLGET_I(getSndbuf)
+        FLEXT_CALLSET_I(setRcvbuf)
+        FLEXT_CALLGET_I(getRcvbuf)
+        FLEXT_CALLSET_I(setTos)
+        FLEXT_CALLGET_I(getTos)
+
+        // keepalive
+        FLEXT_CALLSET_F(setPingInterval)
+        FLEXT_CALLGET_F(getPingInterval)
+        FLEXT_CALLSET_F(setPingTimeout)
+        FLEXT_CALLGET_F(getPingTimeout)
+
     private:
         std::shared_ptr<WebsocketClientImpl> m_client;
+        SocketOptions m_socketOptions;
+        // keepalive in seconds - interval 0: off
+        float m_pingInterval{0};
+        float m_pingTimeout{5};
+        // received data as atoms
+        std::vector<t_atom> m_atoms;
     };
 
 }
@@ -40,6 +40,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <vector>
+#include <string>
 
 #include <rcp_packet.h>
 #include <rcp_parameter.h>
@@ -47,6 +48,9 @@
 #include <rcp_memory.h>
 #include <rcp_logging.h>
 
+#include "Poller.h"
+#include "Reaper.h"
+
 namespace rcp
 {
 
@@ -57,12 +61,23 @@ namespace rcp
         AddOutList(0);
         AddOutInt(1);
 
+        // [ws.server <port>]
+        // option symbol: -poll - no network threads, io is polled from the scheduler
+
         uint16_t port = 0;
-        if (argc > 0)
+        for (int i=0; i<argc; i++)
         {
-            if (CanbeInt(argv[0]))
+            if (IsString(argv[i]))
+            {
+                if (std::string(GetString(argv[i])) == "-poll")
+                {
+                    m_polled = true;
+                }
+            }
+            else if (port == 0 &&
+                     CanbeInt(argv[i]))
             {
-                int p = GetAInt(argv[0], -1);
+                int p = GetAInt(argv[i], -1);
 
                 if (p > 0 &&
                         p <= (int)UINT16_MAX)
@@ -74,12 +89,44 @@ namespace rcp
 
         if (port > 0)
         {
-            m_server = std::make_shared<WebsocketServerImpl>(this);
+            m_server = std::make_shared<WebsocketServerImpl>(this, m_polled);
+            m_server->set_threads((unsigned)m_threads);
+            m_server->set_socket_options(m_socketOptions);
+            applyKeepalive();
             m_server->run(port);
         }
     }
 
 
+    PdWebsocketServer::~PdWebsocketServer()
+    {
+        disposeServer();
+    }
+
+    void PdWebsocketServer::disposeServer()
+    {
+        if (!m_server)
+        {
+            return;
+        }
+
+        // no more calls to us
+        m_server->detach_events();
+
+        if (m_polled)
+        {
+            // we may be inside the server's poll() - delete after it
+            Poller::release(m_server);
+        }
+        else
+        {
+            // threads finish shutting down in the background
+            Reaper::dispose(m_server);
+        }
+
+        m_server.reset();
+    }
+
     // IWebsocketServerListener
     void PdWebsocketServer::connected(void* /*client*/)
     {
@@ -93,13 +140,16 @@ namespace rcp
 
     void PdWebsocketServer::received(char* data, size_t size, void* /*client*/)
     {
-        std::vector<t_atom> list(size);
+        // NOTE: may run on any io thread, but websocketServer dispatches
+        // under m_dispatch_lock (or on the main thread when polled) -
+        // never concurrently, so the atoms can be reused
+        m_atoms.resize(size);
         for (size_t i=0; i<size; i++)
         {
-            SetInt(list[i], data[i]);
+            SetInt(m_atoms[i], data[i]);
         }
 
-        ToOutList(0, size, list.data());
+        ToOutList(0, size, m_atoms.data());
     }
 
     void PdWebsocketServer::socketerror(const char* reason)
@@ -149,15 +199,133 @@ namespace rcp
             return;
         }
 
+        disposeServer();
+
         if (p > 0)
         {
-            m_server = std::make_shared<WebsocketServerImpl>(this);
+            m_server = std::make_shared<WebsocketServerImpl>(this, m_polled);
+            m_server->set_threads((unsigned)m_threads);
+            m_server->set_socket_options(m_socketOptions);
+            applyKeepalive();
             m_server->run(p);
         }
-        else
+    }
+
+    void PdWebsocketServer::setThreads(const int& i)
+    {
+        int threads = i > 1 ? i : 1;
+        if (threads == m_threads)
+        {
+            return;
+        }
+
+        m_threads = threads;
+
+        if (m_server &&
+                !m_polled)
+        {
+            // threads are started when listening - re-listen
+            int port = m_server->port();
+            disposeServer();
+            m_listen(port);
+        }
+    }
+
+    void PdWebsocketServer::getThreads(int& i)
+    {
+        i = m_threads;
+    }
+
+    // socket options
+
+    void PdWebsocketServer::setNodelay(const bool& b)
+    {
+        m_socketOptions.noDelay = b;
+        applySocketOptions();
+    }
+
+    void PdWebsocketServer::getNodelay(bool& b)
+    {
+        b = m_socketOptions.noDelay;
+    }
+
+    void PdWebsocketServer::setSndbuf(const int& i)
+    {
+        m_socketOptions.sendBuffer = i > 0 ? i : 0;
+        applySocketOptions();
+    }
+
+    void PdWebsocketServer::getSndbuf(int& i)
+    {
+        i = m_socketOptions.sendBuffer;
+    }
+
+    void PdWebsocketServer::setRcvbuf(const int& i)
+    {
+        m_socketOptions.receiveBuffer = i > 0 ? i : 0;
+        applySocketOptions();
+    }
+
+    void PdWebsocketServer::getRcvbuf(int& i)
+    {
+        i = m_socketOptions.receiveBuffer;
+    }
+
+    void PdWebsocketServer::setTos(const int& i)
+    {
+        if (i < 0 || i > 255)
+        {
+            error("invalid tos: %d", i);
+            return;
+        }
+
+        m_socketOptions.tos = i;
+        applySocketOptions();
+    }
+
+    void PdWebsocketServer::getTos(int& i)
+    {
+        i = m_socketOptions.tos;
+    }
+
+    void PdWebsocketServer::applySocketOptions()
+    {
+        // for connections accepted from now on
+        if (m_server)
+        {
+            m_server->set_socket_options(m_socketOptions);
+        }
+    }
+
+    // keepalive
+
+    void PdWebsocketServer::setPingInterval(const float& f)
+    {
+        m_pingInterval = f > 0 ? f : 0;
+        applyKeepalive();
+    }
+
+    void PdWebsocketServer::getPingInterval(float& f)
+    {
+        f = m_pingInterval;
+    }
+
+    void PdWebsocketServer::setPingTimeout(const float& f)
+    {
+        m_pingTimeout = f > 0 ? f : 0;
+        applyKeepalive();
+    }
+
+    void PdWebsocketServer::getPingTimeout(float& f)
+    {
+        f = m_pingTimeout;
+    }
+
+    void PdWebsocketServer::applyKeepalive()
+    {
+        if (m_server)
         {
-            // dispose server
-            m_server.reset();
+            m_server->set_keepalive(uint32_t(m_pingInterval * 1000), uint32_t(m_pingTimeout * 1000));
         }
     }
 
@@ -38,9 +38,12 @@
 #ifndef PDWEBSOCKETSERVER_H
 #define PDWEBSOCKETSERVER_H
 
+#include <vector>
+
 #include <flext.h>
 
 #include "WebsocketServerImpl.h"
+#include "SocketOptions.h"
 
 namespace rcp
 {
@@ -51,6 +54,7 @@ namespace rcp
 
     public:
         PdWebsocketServer(int argc, t_atom *argv);
+        ~PdWebsocketServer();
 
     public:
         // IWebsocketServerListener
@@ -63,17 +67,76 @@ namespace rcp
         static void setup(t_classid c)
         {
             FLEXT_CADDMETHOD_(c, 0, "listen", m_listen);
+            FLEXT_CADDATTR_VAR(c, "threads", getThreads, setThreads);
+
+            // socket options
+            FLEXT_CADDATTR_VAR(c, "nodelay", getNodelay, setNodelay);
+            FLEXT_CADDATTR_VAR(c, "sndbuf", getSndbuf, setSndbuf);
+            FLEXT_CADDATTR_VAR(c, "rcvbuf", getRcvbuf, setRcvbuf);
+            FLEXT_CADDATTR_VAR(c, "tos", getTos, setTos);
+
+            // keepalive
+            FLEXT_CADDATTR_VAR(c, "ping_interval", getPingInterval, setPingInterval);
+            FLEXT_CADDATTR_VAR(c, "ping_timeout", getPingTimeout, setPingTimeout);
         }
 
         void m_list(int argc, t_atom* argv);
         void m_listen(int& port);
+        void setThreads(const int& i);
+        void getThreads(int& i);
+
+        // socket options
+        void setNodelay(const bool& b);
+        void getNodelay(bool& b);
+        void setSndbuf(const int& i);
+        void getSndbuf(int& i);
+        void setRcvbuf(const int& i);
+        void getRcvbuf(int& i);
+        void setTos(const int& i);
+        void getTos(int& i);
+
+        // keepalive
+        void setPingInterval(const float& f);
+        void getPingInterval(float& f);
+        void setPingTimeout(const float& f);
+        void getPingTimeout(float& f);
+
+    private:
+        void disposeServer();
+        void applySocketOptions();
+        void applyKeepalive();
 
     private:
         FLEXT_CALLBACK_V(m_list)
         FLEXT_CALLBACK_I(m_listen)
+        FLEXT_CALLSET_I(setThreads)
+        FLEXT_CALLGET_I(getThreads)
+
+        FLEXT_CALLSET_B(setNodelay)
+        FLEXT_CALLGET_B(getNodelay)
+        FLEXT_CALLSET_I(setSndbuf)
+        FLEXT_CALLGET_I(getSndbuf)
+        FLEXT_CALLSET_I(setRcvbuf)
+        FLEXT_CALLGET_I(getRcvbuf)
+        FLEXT_CALLSET_I(setTos)
+        FLEXT_CALLGET_I(getTos)
+
+        // keepalive
+        FLEXT_CALLSET_F(setPingInterval)
+        FLEXT_CALLGET_F(getPingInterval)
+        FLEXT_CALLSET_F(setPingTimeout)
+        FLEXT_CALLGET_F(getPingTimeout)
 
     private:
         std::shared_ptr<WebsocketServerImpl> m_server;
+        bool m_polled{false};
+        int m_threads{1};
+        SocketOptions m_socketOptions;
+        // keepalive in seconds - interval 0: off
+        float m_pingInterval{0};
+        float m_pingTimeout{5};
+        // received data as atoms
+        std::vector<t_atom> m_atoms;
 
     };
 
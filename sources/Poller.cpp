@@ -0,0 +1,151 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "Poller.h"
+
+#include <vector>
+#include <algorithm>
+
+#include <flext.h>
+
+namespace rcp
+{
+    static std::vector<IPollable*>& pollables()
+    {
+        static std::vector<IPollable*> p;
+        return p;
+    }
+
+    static flext::Timer& pollTimer()
+    {
+        static flext::Timer t;
+        return t;
+    }
+
+    static bool polling = false;
+
+    // released while polling
+    static std::vector<std::shared_ptr<void>>& released()
+    {
+        static std::vector<std::shared_ptr<void>> r;
+        return r;
+    }
+
+
+    void Poller::add(IPollable* pollable)
+    {
+        std::vector<IPollable*>& list = pollables();
+
+        if (std::find(list.begin(), list.end(), pollable) != list.end())
+        {
+            return;
+        }
+
+        list.push_back(pollable);
+
+        if (list.size() == 1)
+        {
+            pollTimer().SetCallback(timerCb);
+            pollTimer().Periodic(RCP_POLL_INTERVAL, nullptr);
+        }
+    }
+
+    void Poller::remove(IPollable* pollable)
+    {
+        std::vector<IPollable*>& list = pollables();
+
+        auto it = std::find(list.begin(), list.end(), pollable);
+        if (it == list.end())
+        {
+            return;
+        }
+
+        if (polling)
+        {
+            // objects may get removed from within poll - compact later
+            *it = nullptr;
+            return;
+        }
+
+        list.erase(it);
+
+        if (list.empty())
+        {
+            pollTimer().Reset();
+        }
+    }
+
+    void Poller::release(std::shared_ptr<void> object)
+    {
+        if (polling)
+        {
+            released().push_back(std::move(object));
+        }
+    }
+
+    void Poller::timerCb(void* /*user*/)
+    {
+        std::vector<IPollable*>& list = pollables();
+
+        polling = true;
+
+        // NOTE: list may grow while polling
+        for (size_t i=0; i<list.size(); i++)
+        {
+            if (list[i])
+            {
+                list[i]->poll();
+            }
+        }
+
+        polling = false;
+
+        {
+            // destructors may remove themselves from the list
+            std::vector<std::shared_ptr<void>> objects;
+            objects.swap(released());
+        }
+
+        list.erase(std::remove(list.begin(), list.end(), nullptr), list.end());
+
+        if (list.empty())
+        {
+            pollTimer().Reset();
+        }
+    }
+
+}
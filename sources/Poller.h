@@ -0,0 +1,73 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef POLLER_H
+#define POLLER_H
+
+#include <memory>
+
+#include "IPollable.h"
+
+// poll interval in seconds - effectively once per scheduler tick
+#ifndef RCP_POLL_INTERVAL
+#define RCP_POLL_INTERVAL 0.001
+#endif
+
+namespace rcp
+{
+
+    /* drives all registered IPollable objects from the scheduler
+     * instead of running io threads.
+     * NOTE: only use from the main thread.
+     */
+    class Poller
+    {
+    public:
+        static void add(IPollable* pollable);
+        static void remove(IPollable* pollable);
+
+        // drop an object once the current poll round is done.
+        // a pollable may get disposed from within its own poll()
+        static void release(std::shared_ptr<void> object);
+
+    private:
+        static void timerCb(void* user);
+    };
+
+}
+
+#endif // POLLER_H
@@ -0,0 +1,307 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef PRIORITYSENDER_H
+#define PRIORITYSENDER_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+
+#include <websocketpp/common/connection_hdl.hpp>
+#include <websocketpp/common/thread.hpp>
+#include <websocketpp/frame.hpp>
+
+#include <rcp.h>
+
+// packets larger than this are sent in the bulk lane
+#ifndef RCP_BULK_THRESHOLD
+#define RCP_BULK_THRESHOLD 1024
+#endif
+
+// bulk packets are only handed to websocketpp while less than this
+// amount of data is buffered on the connection
+#ifndef RCP_BULK_WINDOW
+#define RCP_BULK_WINDOW 16384
+#endif
+
+// retry interval in ms while bulk data is waiting
+#ifndef RCP_BULK_PUMP_INTERVAL
+#define RCP_BULK_PUMP_INTERVAL 1
+#endif
+
+namespace rcp
+{
+
+    /* two send lanes per connection:
+     * small packets (value updates, bangs, toggles) are handed to websocketpp
+     * immediately. bulk packets (init, long strings) are held back and
+     * released once the connection's send buffer drained below the window.
+     * so a small packet never waits for more than one window of bulk data.
+     *
+     * a small packet only overtakes queued bulk packets of other parameters:
+     * if a bulk packet of the same parameter (or one that can not be
+     * attributed to a parameter) is waiting, it is queued behind it.
+     * so an UPDATEVALUE or REMOVE never arrives before an earlier UPDATE.
+     *
+     * NOTE: websocket data frames of different messages must not interleave,
+     * so bulk data is paced per message, not split into fragments.
+     */
+    template <typename endpoint_type>
+    class PrioritySender
+    {
+    public:
+        enum priority {
+            PRIORITY_HIGH,
+            PRIORITY_BULK
+        };
+
+        PrioritySender(endpoint_type& endpoint)
+            : m_endpoint(endpoint)
+            , m_pumpScheduled(false)
+        {}
+
+        static priority classify(size_t size)
+        {
+            return size > RCP_BULK_THRESHOLD ? PRIORITY_BULK : PRIORITY_HIGH;
+        }
+
+        // parameter id of update, remove and updatevalue packets. -1: none
+        static int32_t parameterId(const char* data, size_t size)
+        {
+            if (size == 0)
+            {
+                return -1;
+            }
+
+            size_t offset = 1;
+
+            switch (data[0])
+            {
+            case COMMAND_UPDATE:
+            case COMMAND_REMOVE:
+                // [command][packet options...][PACKET_OPTIONS_DATA][id][id]...
+                offset = dataOffset(data, size);
+                break;
+            case COMMAND_UPDATEVALUE:
+                // [command][id][id][type][value...]
+                break;
+            default:
+                return -1;
+            }
+
+            if (offset == 0 ||
+                    offset + 2 > size)
+            {
+                return -1;
+            }
+
+            return (int32_t)(((uint8_t)data[offset] << 8) | (uint8_t)data[offset + 1]);
+        }
+
+        websocketpp::lib::error_code send(websocketpp::connection_hdl hdl, const char* data, size_t size)
+        {
+            return send(hdl, data, size, classify(size));
+        }
+
+        websocketpp::lib::error_code send(websocketpp::connection_hdl hdl, const char* data, size_t size, priority prio)
+        {
+            websocketpp::lib::error_code ec;
+            int32_t id = parameterId(data, size);
+
+            {
+                websocketpp::lib::lock_guard<websocketpp::lib::mutex> guard(m_lock);
+
+                if (prio == PRIORITY_HIGH)
+                {
+                    auto it = m_bulk.find(hdl);
+                    if (it == m_bulk.end() ||
+                            !mustWait(it->second, id))
+                    {
+                        // NOTE: sent under the lock - pump can not reorder
+                        m_endpoint.send(hdl, data, size, websocketpp::frame::opcode::value::binary, ec);
+                        return ec;
+                    }
+                }
+
+                m_bulk[hdl].push_back(pending{std::string(data, size), id});
+            }
+
+            pump();
+
+            return ec;
+        }
+
+        void remove(websocketpp::connection_hdl hdl)
+        {
+            websocketpp::lib::lock_guard<websocketpp::lib::mutex> guard(m_lock);
+            m_bulk.erase(hdl);
+        }
+
+        void clear()
+        {
+            websocketpp::lib::lock_guard<websocketpp::lib::mutex> guard(m_lock);
+            m_bulk.clear();
+        }
+
+    private:
+        // offset of the packet data behind the packet options. 0: none
+        static size_t dataOffset(const char* data, size_t size)
+        {
+            size_t offset = 1;
+
+            while (offset < size)
+            {
+                switch (data[offset])
+                {
+                case PACKET_OPTIONS_TIMESTAMP:
+                    // [option][uint64]
+                    offset += 1 + 8;
+                    break;
+                case PACKET_OPTIONS_DATA:
+                    return offset + 1;
+                default:
+                    return 0;
+                }
+            }
+
+            return 0;
+        }
+
+        struct pending {
+            std::string data;
+            int32_t id;
+        };
+
+        static bool mustWait(const std::deque<pending>& queue, int32_t id)
+        {
+            if (id < 0)
+            {
+                // can not tell what it touches
+                return !queue.empty();
+            }
+
+            for (const pending& p : queue)
+            {
+                if (p.id == id ||
+                        p.id < 0)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void pump()
+        {
+            websocketpp::lib::lock_guard<websocketpp::lib::mutex> guard(m_lock);
+
+            for (auto it = m_bulk.begin(); it != m_bulk.end();)
+            {
+                websocketpp::lib::error_code ec;
+                typename endpoint_type::connection_ptr con = m_endpoint.get_con_from_hdl(it->first, ec);
+
+                if (ec || !con)
+                {
+                    // connection is gone
+                    it = m_bulk.erase(it);
+                    continue;
+                }
+
+                std::deque<pending>& queue = it->second;
+
+                while (!queue.empty() &&
+                       con->get_buffered_amount() < RCP_BULK_WINDOW)
+                {
+                    const std::string& data = queue.front().data;
+                    con->send(data.data(), data.size(), websocketpp::frame::opcode::value::binary);
+                    queue.pop_front();
+                }
+
+                if (queue.empty())
+                {
+                    it = m_bulk.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            if (!m_bulk.empty() &&
+                    !m_pumpScheduled)
+            {
+                m_pumpScheduled = true;
+                m_endpoint.set_timer(RCP_BULK_PUMP_INTERVAL,
+                                     websocketpp::lib::bind(&PrioritySender::on_pump_timer,
+                                                            this,
+                                                            websocketpp::lib::placeholders::_1));
+            }
+        }
+
+        void on_pump_timer(const websocketpp::lib::error_code& ec)
+        {
+            {
+                websocketpp::lib::lock_guard<websocketpp::lib::mutex> guard(m_lock);
+                m_pumpScheduled = false;
+            }
+
+            if (ec)
+            {
+                // timer cancelled - endpoint stopped
+                return;
+            }
+
+            pump();
+        }
+
+    private:
+        typedef std::map<websocketpp::connection_hdl,
+                         std::deque<pending>,
+                         std::owner_less<websocketpp::connection_hdl> > bulk_map;
+
+        endpoint_type& m_endpoint;
+        bulk_map m_bulk;
+        websocketpp::lib::mutex m_lock;
+        bool m_pumpScheduled;
+    };
+
+}
+
+#endif // PRIORITYSENDER_H
@@ -0,0 +1,95 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef RABBITHOLEMUX_H
+#define RABBITHOLEMUX_H
+
+#include <cstdint>
+#include <string>
+
+/* several rcp servers share one relay connection:
+ * <prefix>/rcpmux/connect
+ *
+ * every frame starts with a channel id (2 bytes, big endian).
+ * channel 0 carries control frames: [0 0][op][channel (2 bytes)][args]
+ *
+ * OPEN (server -> relay):      args: tunnel key
+ * CLOSE (server -> relay):     no args
+ * OPENED (relay -> server):    no args
+ * REFUSED (relay -> server):   args: status (2 bytes) - 400, 412, 423
+ */
+#define RABBITHOLE_MUX_PATH "/rcpmux/connect"
+
+namespace rcp
+{
+    namespace mux
+    {
+        enum op : uint8_t
+        {
+            OPEN = 1,
+            CLOSE = 2,
+            OPENED = 3,
+            REFUSED = 4
+        };
+
+        static const size_t HEADER_SIZE = 2;
+        static const size_t CONTROL_SIZE = HEADER_SIZE + 3;
+
+        inline void writeChannel(char* out, uint16_t channel)
+        {
+            out[0] = (char)(channel >> 8);
+            out[1] = (char)(channel & 0xff);
+        }
+
+        inline uint16_t readChannel(const char* in)
+        {
+            return (uint16_t)(((uint8_t)in[0] << 8) | (uint8_t)in[1]);
+        }
+
+        inline std::string control(op o, uint16_t channel, const std::string& args = std::string())
+        {
+            std::string frame(CONTROL_SIZE, '\0');
+            frame[HEADER_SIZE] = (char)o;
+            writeChannel(&frame[HEADER_SIZE + 1], channel);
+            frame.append(args);
+
+            return frame;
+        }
+    }
+}
+
+#endif // RABBITHOLEMUX_H
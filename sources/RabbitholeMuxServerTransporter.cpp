@@ -0,0 +1,284 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "RabbitholeMuxServerTransporter.h"
+
+#include <utility>
+
+#include <rcp_memory.h>
+
+#include <flext.h>
+
+#include "RabbitholeMux.h"
+
+
+// callbacks
+static void _pd_rabbithole_mux_server_transporter_send(rcp_server_transporter* transporter, char* data, size_t data_size, void* /*id*/)
+{
+    if (transporter &&
+            transporter->user)
+    {
+        ((rcp::RabbitholeMuxServerTransporter*)transporter->user)->sendData(data, data_size);
+    }
+}
+
+
+namespace rcp
+{
+
+    static const std::string RABBITHOLE_SERVER_PATH = "/rcpserver/connect";
+
+    RabbitholeMuxServerTransporter::RabbitholeMuxServerTransporter(rcp_server* server, bool polled)
+        : m_rcpServer(server)
+        , m_polled(polled)
+    {
+        m_transporter = (rcp_server_transporter*)RCP_CALLOC(1, sizeof(rcp_server_transporter));
+
+        if (m_transporter)
+        {
+            // all clients of the tunnel get everything
+            rcp_server_transporter_setup(m_transporter,
+                                         _pd_rabbithole_mux_server_transporter_send,
+                                         _pd_rabbithole_mux_server_transporter_send);
+
+            rcp_server_add_transporter(m_rcpServer, m_transporter);
+
+            m_transporter->user = this;
+        }
+    }
+
+    RabbitholeMuxServerTransporter::~RabbitholeMuxServerTransporter()
+    {
+        close();
+
+        if (m_transporter)
+        {
+            if (m_rcpServer)
+            {
+                rcp_server_remove_transporter(m_rcpServer, m_transporter);
+            }
+
+            RCP_FREE(m_transporter);
+            m_transporter = nullptr;
+        }
+    }
+
+    rcp_server_transporter* RabbitholeMuxServerTransporter::transporter() const
+    {
+        return m_transporter;
+    }
+
+    bool RabbitholeMuxServerTransporter::detach()
+    {
+        if (m_polled)
+        {
+            // no threads to wait for
+            return false;
+        }
+
+        std::shared_ptr<RabbitholeTunnel> tunnel;
+        uint16_t channel = 0;
+
+        {
+            std::lock_guard<std::mutex> guard(m_tunnelLock);
+            // keep the tunnel: if we are its last user,
+            // its io threads are joined with us
+            tunnel = m_tunnel;
+            std::swap(channel, m_channel);
+        }
+
+        if (tunnel)
+        {
+            // no more calls to us after this
+            tunnel->close(channel);
+        }
+
+        if (m_transporter &&
+                m_rcpServer)
+        {
+            rcp_server_remove_transporter(m_rcpServer, m_transporter);
+        }
+
+        m_rcpServer = nullptr;
+
+        return true;
+    }
+
+    void RabbitholeMuxServerTransporter::unbind()
+    {
+        close();
+    }
+
+    void RabbitholeMuxServerTransporter::connect(const std::string& uri)
+    {
+        close();
+
+        m_uri = uri;
+
+        if (m_uri.find("https", 0) == 0)
+        {
+            m_uri = m_uri.replace(0, 5, "wss");
+        }
+        else if (m_uri.find("http", 0) == 0)
+        {
+            m_uri = m_uri.replace(0, 4, "ws");
+        }
+
+        // <relay>/<prefix>/rcpserver/connect?key=<tunnel>
+        size_t path = m_uri.find(RABBITHOLE_SERVER_PATH);
+        size_t key = m_uri.find("key=", path == std::string::npos ? 0 : path);
+
+        if (m_uri.find("ws", 0) != 0 ||
+                path == std::string::npos ||
+                key == std::string::npos)
+        {
+            error("Rabbithole: invalid tunnel uri: %s", m_uri.c_str());
+            return;
+        }
+
+        std::string tunnel_key = m_uri.substr(key + 4);
+        tunnel_key = tunnel_key.substr(0, tunnel_key.find('&'));
+
+        std::shared_ptr<RabbitholeTunnel> tunnel = RabbitholeTunnel::get(m_uri.substr(0, path) + RABBITHOLE_MUX_PATH, m_polled);
+        tunnel->setInterval(m_connectInterval);
+
+        m_oneTimeError = true;
+
+        {
+            std::lock_guard<std::mutex> guard(m_tunnelLock);
+            m_tunnel = tunnel;
+        }
+
+        // NOTE: not holding m_tunnelLock - the tunnel calls us with its own lock held
+        uint16_t channel = tunnel->open(tunnel_key, this);
+
+        std::lock_guard<std::mutex> guard(m_tunnelLock);
+        m_channel = channel;
+    }
+
+    void RabbitholeMuxServerTransporter::close()
+    {
+        std::shared_ptr<RabbitholeTunnel> tunnel;
+        uint16_t channel = 0;
+
+        {
+            std::lock_guard<std::mutex> guard(m_tunnelLock);
+            tunnel.swap(m_tunnel);
+            std::swap(channel, m_channel);
+        }
+
+        if (tunnel)
+        {
+            // no more calls to us after this
+            tunnel->close(channel);
+        }
+    }
+
+    void RabbitholeMuxServerTransporter::setInterval(const int i)
+    {
+        // NOTE: the connection is shared - applies to all its servers
+        m_connectInterval = i;
+
+        std::shared_ptr<RabbitholeTunnel> tunnel;
+        {
+            std::lock_guard<std::mutex> guard(m_tunnelLock);
+            tunnel = m_tunnel;
+        }
+
+        if (tunnel)
+        {
+            tunnel->setInterval(i);
+        }
+    }
+
+    void RabbitholeMuxServerTransporter::sendData(const char* data, size_t size)
+    {
+        std::lock_guard<std::mutex> guard(m_tunnelLock);
+        if (m_tunnel &&
+                m_channel != 0)
+        {
+            m_tunnel->sendTo(m_channel, data, size);
+        }
+    }
+
+    // IRabbitholeChannel
+    void RabbitholeMuxServerTransporter::opened()
+    {
+        m_oneTimeError = true;
+    }
+
+    void RabbitholeMuxServerTransporter::refused(uint16_t code)
+    {
+        if (!m_oneTimeError)
+        {
+            return;
+        }
+
+        m_oneTimeError = false;
+
+        switch (code)
+        {
+        case 400:
+            error("Rabbithole: no tunnel name provided");
+            break;
+        case 412:
+            error("Rabbithole: tunnel name too short");
+            break;
+        case 423:
+            error("Rabbithole: tunnel already in use - please use a different public tunnel or consider using a private tunnel.");
+            break;
+        default:
+            error("Rabbithole: tunnel refused: %d", code);
+            break;
+        }
+    }
+
+    void RabbitholeMuxServerTransporter::received(char* data, size_t size)
+    {
+        if (m_transporter &&
+                data &&
+                size > 0 &&
+                m_transporter->received)
+        {
+            m_transporter->received(m_transporter->server,
+                                    data,
+                                    size,
+                                    NULL);
+        }
+    }
+
+}
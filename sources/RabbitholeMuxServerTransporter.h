@@ -0,0 +1,108 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef RABBITHOLEMUXSERVERTRANSPORTER_H
+#define RABBITHOLEMUXSERVERTRANSPORTER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <rcp_server_transporter.h>
+
+#include "IServerTransporter.h"
+#include "RabbitholeTunnel.h"
+
+namespace rcp
+{
+
+    /* rabbithole tunnel on a channel of a shared relay connection.
+     * servers with the same relay share one connection and its io threads.
+     * NOTE: the relay needs to support RABBITHOLE_MUX_PATH (see [rcp.rabbithole])
+     */
+    class RabbitholeMuxServerTransporter
+            : public IServerTransporter
+            , public IRabbitholeChannel
+    {
+    public:
+        RabbitholeMuxServerTransporter(rcp_server* server, bool polled = false);
+        ~RabbitholeMuxServerTransporter();
+
+        // <relay>/<prefix>/rcpserver/connect?key=<tunnel>
+        void connect(const std::string& uri);
+        void close();
+        std::string uri() const { return m_uri; }
+
+        void setInterval(const int i);
+        int interval() const { return m_connectInterval; }
+
+        void sendData(const char* data, size_t size);
+
+    public:
+        // IServerTransporter
+        rcp_server_transporter* transporter() const override;
+        void bind(uint16_t /*port*/) override {}
+        void unbind() override;
+        uint16_t port() const override { return 0; }
+        bool isListening() const override { return true; }
+        bool detach() override;
+
+    public:
+        // IRabbitholeChannel
+        void opened() override;
+        void refused(uint16_t code) override;
+        void closed() override {}
+        void received(char* data, size_t size) override;
+
+    private:
+        rcp_server* m_rcpServer{nullptr};
+        rcp_server_transporter* m_transporter{nullptr};
+        bool m_polled{false};
+
+        std::string m_uri;
+        int m_connectInterval{2};
+        bool m_oneTimeError{true};
+
+        std::shared_ptr<RabbitholeTunnel> m_tunnel;
+        uint16_t m_channel{0};
+        // sending may happen on network threads
+        std::mutex m_tunnelLock;
+    };
+
+}
+
+#endif // RABBITHOLEMUXSERVERTRANSPORTER_H
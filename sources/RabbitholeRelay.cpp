@@ -0,0 +1,566 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "RabbitholeRelay.h"
+
+#include <flext.h>
+
+#include "RabbitholeMux.h"
+
+namespace rcp
+{
+
+    static const std::string RABBITHOLE_SERVER_PATH = "/rcpserver/connect";
+    static const std::string RABBITHOLE_CLIENT_PATH = "/rcpclient/connect";
+    static const std::string RABBITHOLE_PUBLIC_PREFIX = "/public";
+
+    static bool endsWith(const std::string& s, const std::string& suffix)
+    {
+        return s.size() >= suffix.size() &&
+                s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    static std::string queryValue(const std::string& query, const std::string& name)
+    {
+        size_t start = 0;
+        while (start < query.size())
+        {
+            size_t end = query.find('&', start);
+            if (end == std::string::npos)
+            {
+                end = query.size();
+            }
+
+            size_t eq = query.find('=', start);
+            if (eq != std::string::npos &&
+                    eq < end &&
+                    query.compare(start, eq - start, name) == 0)
+            {
+                return query.substr(eq + 1, end - eq - 1);
+            }
+
+            start = end + 1;
+        }
+
+        return std::string();
+    }
+
+    RabbitholeRelay::RabbitholeRelay(IWebsocketServerListener* listener, bool polled)
+        : websocketServer(polled)
+        , m_listener(listener)
+    {
+        // forward on the io thread - no hand-off per frame
+        setDirect(true);
+    }
+
+    RabbitholeRelay::~RabbitholeRelay()
+    {
+        // stop threads before tunnels go away
+        stop();
+    }
+
+    size_t RabbitholeRelay::tunnels() const
+    {
+        lock_guard<mutex> guard(m_tunnelLock);
+        return m_tunnels.size();
+    }
+
+    size_t RabbitholeRelay::connections() const
+    {
+        lock_guard<mutex> guard(m_tunnelLock);
+
+        size_t count = 0;
+        for (auto& it : m_peers)
+        {
+            if (it.second.open)
+            {
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    // IWebsocketServerListener
+    void RabbitholeRelay::connected(void* client)
+    {
+        if (m_listener)
+        {
+            m_listener->connected(client);
+        }
+    }
+
+    void RabbitholeRelay::disconnected(void* client)
+    {
+        if (m_listener)
+        {
+            m_listener->disconnected(client);
+        }
+    }
+
+    void RabbitholeRelay::socketerror(const char* reason)
+    {
+        if (m_listener)
+        {
+            m_listener->socketerror(reason);
+        }
+    }
+
+    void RabbitholeRelay::handle_action(const action& a)
+    {
+        std::vector<connection_hdl> to_close;
+
+        {
+            lock_guard<mutex> guard(m_tunnelLock);
+
+            auto it = m_peers.find(a.hdl);
+            if (it == m_peers.end())
+            {
+                return;
+            }
+
+            peer& p = it->second;
+
+            if (a.type == MESSAGE)
+            {
+                if (p.isMux)
+                {
+                    muxReceived(a.hdl, p, a.msg, to_close);
+                }
+                else
+                {
+                    forward(p, a.msg);
+                }
+            }
+            else if (a.type == SUBSCRIBE)
+            {
+                p.open = true;
+
+                if (p.isServer)
+                {
+                    if (p.isPublic &&
+                            m_publicSession > 0)
+                    {
+                        p.session = m_server.set_timer(m_publicSession * 1000,
+                                                       bind(&RabbitholeRelay::sessionExpired, this, a.hdl, ::_1));
+                    }
+                }
+                else if (!p.isMux)
+                {
+                    m_tunnels[p.tunnel].clients.push_back(a.hdl);
+                }
+            }
+            else if (a.type == UNSUBSCRIBE)
+            {
+                if (p.isMux)
+                {
+                    for (auto& c : p.channels)
+                    {
+                        closeChannel(c.second, to_close);
+                    }
+                    p.channels.clear();
+                }
+                else if (p.isServer)
+                {
+                    // clients need to start over with the next server
+                    auto t = m_tunnels.find(p.tunnel);
+                    if (t != m_tunnels.end())
+                    {
+                        to_close = t->second.clients;
+                    }
+                }
+
+                release(it);
+            }
+        }
+
+        for (connection_hdl& hdl : to_close)
+        {
+            websocketpp::lib::error_code ec;
+            m_server.close(hdl, websocketpp::close::status::going_away, "server disconnected", ec);
+        }
+
+        if (a.type == SUBSCRIBE)
+        {
+            connected(nullptr);
+        }
+        else if (a.type == UNSUBSCRIBE)
+        {
+            disconnected(nullptr);
+        }
+    }
+
+    void RabbitholeRelay::forward(const peer& from, server::message_ptr msg)
+    {
+        auto t = m_tunnels.find(from.tunnel);
+        if (t == m_tunnels.end())
+        {
+            return;
+        }
+
+        if (from.isServer)
+        {
+            sendToClients(t->second, msg);
+        }
+        else if (t->second.hasServer)
+        {
+            websocketpp::lib::error_code ec;
+
+            if (t->second.serverChannel == 0)
+            {
+                prepare(msg);
+                m_server.send(t->second.server, msg, ec);
+                return;
+            }
+
+            // tag with the channel of the tunnel
+            const std::string& payload = msg->get_payload();
+            server::message_ptr out = websocketpp::lib::make_shared<server::message_type>(server::message_type::con_msg_man_ptr(), msg->get_opcode(), mux::HEADER_SIZE + payload.size());
+
+            std::string& frame = out->get_raw_payload();
+            frame.resize(mux::HEADER_SIZE);
+            mux::writeChannel(&frame[0], t->second.serverChannel);
+            frame.append(payload);
+
+            m_server.send(t->second.server, out, ec);
+        }
+    }
+
+    void RabbitholeRelay::sendToClients(const tunnel& t, server::message_ptr msg)
+    {
+        prepare(msg);
+
+        websocketpp::lib::error_code ec;
+        for (const connection_hdl& hdl : t.clients)
+        {
+            m_server.send(hdl, msg, ec);
+        }
+    }
+
+    void RabbitholeRelay::prepare(server::message_ptr msg)
+    {
+        // server frames are not masked: the same frame goes to every peer.
+        // prepare it in place once, writes only reference header and payload.
+        const std::string& payload = msg->get_payload();
+        websocketpp::frame::basic_header header(msg->get_opcode(), payload.size(), true, false);
+        websocketpp::frame::extended_header extended(payload.size());
+
+        msg->set_header(websocketpp::frame::prepare_header(header, extended));
+        msg->set_prepared(true);
+    }
+
+    void RabbitholeRelay::muxReceived(connection_hdl hdl, peer& p, server::message_ptr msg, std::vector<connection_hdl>& to_close)
+    {
+        const std::string& payload = msg->get_payload();
+        if (payload.size() < mux::HEADER_SIZE)
+        {
+            return;
+        }
+
+        uint16_t channel = mux::readChannel(payload.data());
+
+        if (channel != 0)
+        {
+            auto c = p.channels.find(channel);
+            if (c == p.channels.end())
+            {
+                return;
+            }
+
+            auto t = m_tunnels.find(c->second);
+            if (t == m_tunnels.end())
+            {
+                return;
+            }
+
+            // strip the channel - copied once, shared by all clients
+            server::message_ptr out = websocketpp::lib::make_shared<server::message_type>(server::message_type::con_msg_man_ptr(), msg->get_opcode(), payload.size() - mux::HEADER_SIZE);
+            out->set_payload(payload.data() + mux::HEADER_SIZE, payload.size() - mux::HEADER_SIZE);
+
+            sendToClients(t->second, out);
+            return;
+        }
+
+        // control
+        if (payload.size() < mux::CONTROL_SIZE)
+        {
+            return;
+        }
+
+        uint8_t o = (uint8_t)payload[mux::HEADER_SIZE];
+        channel = mux::readChannel(payload.data() + mux::HEADER_SIZE + 1);
+
+        if (o == mux::OPEN)
+        {
+            std::string key = payload.substr(mux::CONTROL_SIZE);
+            uint16_t status = 0;
+
+            if (key.empty())
+            {
+                status = websocketpp::http::status_code::bad_request;
+            }
+            else if (key.size() < RCP_RABBITHOLE_MIN_KEY_LENGTH)
+            {
+                status = websocketpp::http::status_code::precondition_failed;
+            }
+            else
+            {
+                // the prefix is kept in tunnel for mux connections
+                std::string name = p.tunnel + "/" + key;
+                tunnel& t = m_tunnels[name];
+
+                if (t.hasServer ||
+                        p.channels.find(channel) != p.channels.end())
+                {
+                    status = websocketpp::http::status_code::locked;
+                }
+                else
+                {
+                    t.hasServer = true;
+                    t.server = hdl;
+                    t.serverChannel = channel;
+                    p.channels[channel] = name;
+                }
+            }
+
+            std::string reply;
+            if (status == 0)
+            {
+                reply = mux::control(mux::OPENED, channel);
+            }
+            else
+            {
+                char code[2];
+                mux::writeChannel(code, status);
+                reply = mux::control(mux::REFUSED, channel, std::string(code, 2));
+            }
+
+            websocketpp::lib::error_code ec;
+            m_server.send(hdl, reply.data(), reply.size(), websocketpp::frame::opcode::binary, ec);
+        }
+        else if (o == mux::CLOSE)
+        {
+            auto c = p.channels.find(channel);
+            if (c != p.channels.end())
+            {
+                closeChannel(c->second, to_close);
+                p.channels.erase(c);
+            }
+        }
+    }
+
+    void RabbitholeRelay::closeChannel(const std::string& name, std::vector<connection_hdl>& to_close)
+    {
+        // NOTE: m_tunnelLock is held
+        auto t = m_tunnels.find(name);
+        if (t == m_tunnels.end())
+        {
+            return;
+        }
+
+        // clients need to start over with the next server
+        to_close.insert(to_close.end(), t->second.clients.begin(), t->second.clients.end());
+
+        t->second.hasServer = false;
+        t->second.server.reset();
+        t->second.serverChannel = 0;
+
+        if (t->second.clients.empty())
+        {
+            m_tunnels.erase(t);
+        }
+    }
+
+    void RabbitholeRelay::release(peer_list::iterator it)
+    {
+        // NOTE: m_tunnelLock is held
+        peer& p = it->second;
+
+        if (p.session)
+        {
+            p.session->cancel();
+        }
+
+        // mux connections have closed their channels
+        auto t = p.isMux ? m_tunnels.end() : m_tunnels.find(p.tunnel);
+        if (t != m_tunnels.end())
+        {
+            if (p.isServer)
+            {
+                t->second.hasServer = false;
+                t->second.server.reset();
+            }
+            else
+            {
+                std::owner_less<connection_hdl> less;
+                std::vector<connection_hdl>& clients = t->second.clients;
+
+                for (auto c = clients.begin(); c != clients.end(); ++c)
+                {
+                    if (!less(*c, it->first) && !less(it->first, *c))
+                    {
+                        clients.erase(c);
+                        break;
+                    }
+                }
+            }
+
+            if (!t->second.hasServer &&
+                    t->second.clients.empty())
+            {
+                m_tunnels.erase(t);
+            }
+        }
+
+        m_peers.erase(it);
+    }
+
+    void RabbitholeRelay::sessionExpired(connection_hdl hdl, const websocketpp::lib::error_code& ec)
+    {
+        if (ec)
+        {
+            // cancelled
+            return;
+        }
+
+        // public tunnels are not reliable
+        websocketpp::lib::error_code close_ec;
+        m_server.close(hdl, 4500, "session not reliable", close_ec);
+    }
+
+    bool RabbitholeRelay::validate(connection_hdl hdl)
+    {
+        websocketpp::lib::error_code ec;
+        server::connection_ptr con = m_server.get_con_from_hdl(hdl, ec);
+        if (ec || !con)
+        {
+            return false;
+        }
+
+        const std::string& resource = con->get_resource();
+        size_t q = resource.find('?');
+
+        std::string path = resource.substr(0, q);
+        while (path.size() > 1 &&
+               path[path.size()-1] == '/')
+        {
+            path.erase(path.size()-1);
+        }
+
+        bool is_server = false;
+        std::string prefix;
+
+        if (endsWith(path, RABBITHOLE_SERVER_PATH))
+        {
+            is_server = true;
+            prefix = path.substr(0, path.size() - RABBITHOLE_SERVER_PATH.size());
+        }
+        else if (endsWith(path, RABBITHOLE_CLIENT_PATH))
+        {
+            prefix = path.substr(0, path.size() - RABBITHOLE_CLIENT_PATH.size());
+        }
+        else if (endsWith(path, RABBITHOLE_MUX_PATH))
+        {
+            // tunnels are opened on channels - see RabbitholeMux.h
+            lock_guard<mutex> guard(m_tunnelLock);
+
+            peer& p = m_peers[hdl];
+            p.tunnel = path.substr(0, path.size() - std::string(RABBITHOLE_MUX_PATH).size());
+            p.isMux = true;
+
+            return true;
+        }
+        else
+        {
+            con->set_status(websocketpp::http::status_code::not_found);
+            return false;
+        }
+
+        std::string key = q == std::string::npos ? std::string() : queryValue(resource.substr(q + 1), "key");
+
+        if (key.empty())
+        {
+            con->set_status(websocketpp::http::status_code::bad_request);
+            return false;
+        }
+
+        if (key.size() < RCP_RABBITHOLE_MIN_KEY_LENGTH)
+        {
+            con->set_status(websocketpp::http::status_code::precondition_failed);
+            return false;
+        }
+
+        std::string name = prefix + "/" + key;
+
+        lock_guard<mutex> guard(m_tunnelLock);
+
+        tunnel& t = m_tunnels[name];
+
+        if (is_server)
+        {
+            if (t.hasServer)
+            {
+                con->set_status(websocketpp::http::status_code::locked);
+                return false;
+            }
+
+            // reserve the tunnel until closed or failed
+            t.hasServer = true;
+            t.server = hdl;
+        }
+
+        peer& p = m_peers[hdl];
+        p.tunnel = name;
+        p.isServer = is_server;
+        p.isPublic = endsWith(prefix, RABBITHOLE_PUBLIC_PREFIX);
+
+        return true;
+    }
+
+    void RabbitholeRelay::handshake_failed(connection_hdl hdl)
+    {
+        // validated but handshake failed
+        lock_guard<mutex> guard(m_tunnelLock);
+
+        auto it = m_peers.find(hdl);
+        if (it != m_peers.end())
+        {
+            release(it);
+        }
+    }
+
+}
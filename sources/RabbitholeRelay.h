@@ -0,0 +1,146 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef RABBITHOLERELAY_H
+#define RABBITHOLERELAY_H
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "websocketServer.h"
+
+// shortest tunnel key accepted - shorter keys fail with 412
+#ifndef RCP_RABBITHOLE_MIN_KEY_LENGTH
+#define RCP_RABBITHOLE_MIN_KEY_LENGTH 4
+#endif
+
+namespace rcp
+{
+
+    /* local stand-in for the rabbithole relay.
+     *
+     * servers connect to <prefix>/rcpserver/connect?key=<tunnel>
+     * clients connect to <prefix>/rcpclient/connect?key=<tunnel>
+     *
+     * frames of a server are sent to all clients of its tunnel,
+     * frames of a client are sent to the server of its tunnel.
+     * frames are forwarded as received: the header is prepared once
+     * and all writes share the payload.
+     *
+     * upgrade responses:
+     * 400: no tunnel key
+     * 412: tunnel key too short
+     * 423: tunnel already has a server
+     * close codes:
+     * 4500: public session expired (<prefix> ending in /public)
+     *
+     * several servers may share one connection to <prefix>/rcpmux/connect,
+     * see RabbitholeMux.h. public sessions do not expire on shared connections.
+     */
+    class RabbitholeRelay : public websocketServer
+    {
+    public:
+        RabbitholeRelay(IWebsocketServerListener* listener, bool polled = false);
+        ~RabbitholeRelay();
+
+        size_t tunnels() const;
+        size_t connections() const;
+
+        // close public tunnels after seconds - 0: never
+        void setPublicSession(int seconds) { m_publicSession = seconds; }
+        int publicSession() const { return m_publicSession; }
+
+    public:
+        // IWebsocketServerListener
+        void connected(void* client) override;
+        void disconnected(void* client) override;
+        void received(char* /*data*/, size_t /*size*/, void* /*id*/) override {}
+        void socketerror(const char* reason) override;
+
+    protected:
+        // websocketServer
+        void handle_action(const action& a) override;
+        bool validate(connection_hdl hdl) override;
+        void handshake_failed(connection_hdl hdl) override;
+
+    private:
+        struct tunnel
+        {
+            bool hasServer{false};
+            connection_hdl server;
+            // mux connections: channel of the server
+            uint16_t serverChannel{0};
+            std::vector<connection_hdl> clients;
+        };
+
+        struct peer
+        {
+            // mux connections: path prefix
+            std::string tunnel;
+            bool isServer{false};
+            bool isPublic{false};
+            bool isMux{false};
+            bool open{false};
+            server::timer_ptr session;
+            // mux connections: channel -> tunnel
+            std::map<uint16_t, std::string> channels;
+        };
+
+        typedef std::map<connection_hdl, peer, std::owner_less<connection_hdl> > peer_list;
+
+        void forward(const peer& from, server::message_ptr msg);
+        void sendToClients(const tunnel& t, server::message_ptr msg);
+        void prepare(server::message_ptr msg);
+        void muxReceived(connection_hdl hdl, peer& p, server::message_ptr msg, std::vector<connection_hdl>& to_close);
+        void closeChannel(const std::string& name, std::vector<connection_hdl>& to_close);
+        void release(peer_list::iterator it);
+        void sessionExpired(connection_hdl hdl, const websocketpp::lib::error_code& ec);
+
+    private:
+        IWebsocketServerListener* m_listener;
+        std::atomic<int> m_publicSession{0};
+
+        std::map<std::string, tunnel> m_tunnels;
+        peer_list m_peers;
+        mutable mutex m_tunnelLock;
+    };
+
+}
+
+#endif // RABBITHOLERELAY_H
@@ -76,8 +76,8 @@ namespace rcp
         }
     }
 
-    RabbitHoleServerTransporter::RabbitHoleServerTransporter(rcp_server* server)
-        : websocketClient()
+    RabbitHoleServerTransporter::RabbitHoleServerTransporter(rcp_server* server, bool polled)
+        : websocketClient(polled)
         , m_rcpServer(server)
         , m_transporter(nullptr)
         , m_connectInterval(2)
@@ -106,7 +106,10 @@ namespace rcp
 
         if (m_transporter)
         {
-            rcp_server_remove_transporter(m_rcpServer, m_transporter);
+            if (m_rcpServer)
+            {
+                rcp_server_remove_transporter(m_rcpServer, m_transporter);
+            }
 
             RCP_FREE(m_transporter);
             m_transporter = nullptr;
@@ -120,6 +123,33 @@ namespace rcp
         return m_transporter;
     }
 
+    bool RabbitHoleServerTransporter::detach()
+    {
+        if (polled())
+        {
+            // no threads to wait for
+            return false;
+        }
+
+        // no more calls into rcp_server after this
+        detachEvents();
+
+        // flext timers belong to the main thread -
+        // unset here, the destructor then only frees it
+        m_doTryConnect = false;
+        m_tryConnectTimer.Reset();
+
+        if (m_transporter &&
+                m_rcpServer)
+        {
+            rcp_server_remove_transporter(m_rcpServer, m_transporter);
+        }
+
+        m_rcpServer = nullptr;
+
+        return true;
+    }
+
     void RabbitHoleServerTransporter::bind(uint16_t /*port*/)
     {
     }
@@ -53,7 +53,7 @@ namespace rcp
     {
 
     public:
-        RabbitHoleServerTransporter(rcp_server* server);
+        RabbitHoleServerTransporter(rcp_server* server, bool polled = false);
         ~RabbitHoleServerTransporter();
 
         void setInterval(const int i);
@@ -68,6 +68,7 @@ namespace rcp
         void unbind() override;
         uint16_t port() const override { return 0; }
         bool isListening() const override { return true; }
+        bool detach() override;
 
     public:
         // websocketClient
@@ -0,0 +1,306 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "RabbitholeTunnel.h"
+
+#include <cstring>
+
+#include "RabbitholeMux.h"
+
+namespace rcp
+{
+
+    static void tunnelTimerCb(void* userdata)
+    {
+        if (userdata != NULL)
+        {
+            static_cast<RabbitholeTunnel*>(userdata)->tryConnectTimerTimeout();
+        }
+    }
+
+    std::shared_ptr<RabbitholeTunnel> RabbitholeTunnel::get(const std::string& uri, bool polled)
+    {
+        static std::map<std::string, std::weak_ptr<RabbitholeTunnel> > tunnels;
+
+        // polled and threaded servers do not share a connection
+        std::string id = polled ? uri + " -poll" : uri;
+
+        auto it = tunnels.find(id);
+        if (it != tunnels.end())
+        {
+            if (std::shared_ptr<RabbitholeTunnel> t = it->second.lock())
+            {
+                return t;
+            }
+        }
+
+        std::shared_ptr<RabbitholeTunnel> t = std::make_shared<RabbitholeTunnel>(uri, polled);
+        tunnels[id] = t;
+
+        return t;
+    }
+
+    RabbitholeTunnel::RabbitholeTunnel(const std::string& uri, bool polled)
+        : websocketClient(polled)
+        , m_uri(uri)
+    {
+        m_tryConnectTimer.SetCallback(tunnelTimerCb);
+    }
+
+    RabbitholeTunnel::~RabbitholeTunnel()
+    {
+        m_connectInterval = 0;
+        m_tryConnectTimer.Reset();
+
+        // stop io before channels go away
+        shutdown();
+    }
+
+    uint16_t RabbitholeTunnel::open(const std::string& key, IRabbitholeChannel* channel)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_channelLock);
+
+        // next free channel - 0 is for control frames
+        while (m_nextChannel == 0 ||
+               m_channels.find(m_nextChannel) != m_channels.end())
+        {
+            m_nextChannel++;
+        }
+
+        uint16_t id = m_nextChannel++;
+        bool first = m_channels.empty();
+
+        m_channels[id] = channel_entry{key, channel};
+
+        if (m_open)
+        {
+            sendControl(mux::control(mux::OPEN, id, key));
+        }
+        else if (first)
+        {
+            m_oneTimeError = true;
+            websocketClient::connect(m_uri);
+        }
+
+        return id;
+    }
+
+    void RabbitholeTunnel::close(uint16_t channel)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_channelLock);
+
+        if (m_channels.erase(channel) == 0)
+        {
+            return;
+        }
+
+        if (m_open)
+        {
+            sendControl(mux::control(mux::CLOSE, channel));
+        }
+
+        if (m_channels.empty())
+        {
+            // nothing to tunnel
+            m_tryConnectTimer.Reset();
+            disconnect();
+            m_open = false;
+        }
+    }
+
+    void RabbitholeTunnel::sendTo(uint16_t channel, const char* data, size_t size)
+    {
+        if (!m_open)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(m_sendLock);
+
+        m_frame.resize(mux::HEADER_SIZE + size);
+        mux::writeChannel(m_frame.data(), channel);
+        memcpy(m_frame.data() + mux::HEADER_SIZE, data, size);
+
+        websocketClient::send(m_frame.data(), m_frame.size());
+    }
+
+    void RabbitholeTunnel::sendControl(const std::string& frame)
+    {
+        std::lock_guard<std::mutex> guard(m_sendLock);
+
+        m_frame.assign(frame.begin(), frame.end());
+        websocketClient::send(m_frame.data(), m_frame.size());
+    }
+
+    void RabbitholeTunnel::setInterval(const int i)
+    {
+        m_connectInterval = i;
+
+        if (m_connectInterval > 0)
+        {
+            if (!m_open)
+            {
+                tryConnect();
+            }
+        }
+        else
+        {
+            m_tryConnectTimer.Reset();
+        }
+    }
+
+    void RabbitholeTunnel::tryConnectTimerTimeout()
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_channelLock);
+
+        if (!m_open &&
+                !m_channels.empty())
+        {
+            websocketClient::connect(m_uri);
+        }
+    }
+
+    void RabbitholeTunnel::tryConnect()
+    {
+        if (m_connectInterval > 0)
+        {
+            m_tryConnectTimer.Delay(m_connectInterval, this);
+        }
+    }
+
+    // websocketClient
+    void RabbitholeTunnel::connected()
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_channelLock);
+
+        m_open = true;
+        m_oneTimeError = true;
+
+        // (re-)open all tunnels
+        for (auto& it : m_channels)
+        {
+            sendControl(mux::control(mux::OPEN, it.first, it.second.key));
+        }
+    }
+
+    void RabbitholeTunnel::failed(uint16_t code)
+    {
+        if (m_oneTimeError)
+        {
+            m_oneTimeError = false;
+            error("Rabbithole: could not connect to %s: %d", m_uri.c_str(), code);
+        }
+
+        lost();
+    }
+
+    void RabbitholeTunnel::disconnected(uint16_t /*code*/)
+    {
+        lost();
+    }
+
+    void RabbitholeTunnel::lost()
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_channelLock);
+
+        m_open = false;
+
+        if (m_channels.empty())
+        {
+            return;
+        }
+
+        // copy - channels may close from within
+        std::map<uint16_t, channel_entry> channels = m_channels;
+        for (auto& it : channels)
+        {
+            if (m_channels.find(it.first) != m_channels.end())
+            {
+                it.second.channel->closed();
+            }
+        }
+
+        tryConnect();
+    }
+
+    void RabbitholeTunnel::received(char* data, size_t size)
+    {
+        if (size < mux::HEADER_SIZE)
+        {
+            return;
+        }
+
+        std::lock_guard<std::recursive_mutex> guard(m_channelLock);
+
+        uint16_t channel = mux::readChannel(data);
+
+        if (channel != 0)
+        {
+            auto it = m_channels.find(channel);
+            if (it != m_channels.end())
+            {
+                it->second.channel->received(data + mux::HEADER_SIZE, size - mux::HEADER_SIZE);
+            }
+            return;
+        }
+
+        // control
+        if (size < mux::CONTROL_SIZE)
+        {
+            return;
+        }
+
+        auto it = m_channels.find(mux::readChannel(data + mux::HEADER_SIZE + 1));
+        if (it == m_channels.end())
+        {
+            return;
+        }
+
+        switch ((uint8_t)data[mux::HEADER_SIZE])
+        {
+        case mux::OPENED:
+            it->second.channel->opened();
+            break;
+        case mux::REFUSED:
+            it->second.channel->refused(size >= mux::CONTROL_SIZE + 2 ? mux::readChannel(data + mux::CONTROL_SIZE) : 0);
+            break;
+        default:
+            break;
+        }
+    }
+
+}
@@ -0,0 +1,130 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef RABBITHOLETUNNEL_H
+#define RABBITHOLETUNNEL_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <flext.h>
+
+#include "websocketClient.h"
+
+namespace rcp
+{
+
+    class IRabbitholeChannel
+    {
+    public:
+        virtual void opened() = 0;
+        virtual void refused(uint16_t code) = 0;
+        virtual void closed() = 0;
+        virtual void received(char* data, size_t size) = 0;
+    };
+
+
+    /* one connection to a relay carrying the tunnels of several servers.
+     * each server gets a channel, frames are tagged with its channel id.
+     * see RabbitholeMux.h
+     */
+    class RabbitholeTunnel : public websocketClient
+    {
+    public:
+        // get or create the connection to the relay at uri
+        // NOTE: only use from the main thread
+        static std::shared_ptr<RabbitholeTunnel> get(const std::string& uri, bool polled = false);
+
+        RabbitholeTunnel(const std::string& uri, bool polled = false);
+        ~RabbitholeTunnel();
+
+        // open a tunnel with key - returns the channel id
+        uint16_t open(const std::string& key, IRabbitholeChannel* channel);
+        // no calls into channel after this returns
+        void close(uint16_t channel);
+        void sendTo(uint16_t channel, const char* data, size_t size);
+
+        void setInterval(const int i);
+        int interval() const { return m_connectInterval; }
+        void tryConnectTimerTimeout();
+        std::string uri() const { return m_uri; }
+
+    public:
+        // websocketClient
+        void connected() override;
+        void failed(uint16_t code) override;
+        void disconnected(uint16_t code) override;
+        void received(char* data, size_t size) override;
+        void received(const std::string& /*msg*/) override {}
+
+    private:
+        struct channel_entry
+        {
+            std::string key;
+            IRabbitholeChannel* channel;
+        };
+
+        void tryConnect();
+        void lost();
+        void sendControl(const std::string& frame);
+
+    private:
+        std::string m_uri;
+
+        std::map<uint16_t, channel_entry> m_channels;
+        uint16_t m_nextChannel{1};
+        // channels may close from within their callbacks
+        std::recursive_mutex m_channelLock;
+
+        std::atomic<bool> m_open{false};
+        bool m_oneTimeError{true};
+
+        // framing buffer - reused
+        std::vector<char> m_frame;
+        std::mutex m_sendLock;
+
+        flext::Timer m_tryConnectTimer;
+        std::atomic<int> m_connectInterval{2};
+    };
+
+}
+
+#endif // RABBITHOLETUNNEL_H
@@ -0,0 +1,129 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "Reaper.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace rcp
+{
+    namespace
+    {
+        class ReaperThread
+        {
+        public:
+            ~ReaperThread()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    m_stop = true;
+                }
+                m_cond.notify_one();
+
+                if (m_thread.joinable())
+                {
+                    // finishes the queue first
+                    m_thread.join();
+                }
+            }
+
+            void push(std::shared_ptr<void> object)
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    m_objects.push_back(std::move(object));
+
+                    if (!m_thread.joinable())
+                    {
+                        m_thread = std::thread(&ReaperThread::run, this);
+                    }
+                }
+                m_cond.notify_one();
+            }
+
+        private:
+            void run()
+            {
+                std::unique_lock<std::mutex> lock(m_lock);
+
+                for (;;)
+                {
+                    m_cond.wait(lock, [this]() { return m_stop || !m_objects.empty(); });
+
+                    if (m_objects.empty())
+                    {
+                        // stopped
+                        break;
+                    }
+
+                    std::shared_ptr<void> object = std::move(m_objects.front());
+                    m_objects.pop_front();
+
+                    // destroy without holding the lock
+                    lock.unlock();
+                    object.reset();
+                    lock.lock();
+                }
+            }
+
+        private:
+            std::mutex m_lock;
+            std::condition_variable m_cond;
+            std::deque<std::shared_ptr<void>> m_objects;
+            std::thread m_thread;
+            bool m_stop{false};
+        };
+
+        ReaperThread& reaper()
+        {
+            static ReaperThread r;
+            return r;
+        }
+    }
+
+    void Reaper::dispose(std::shared_ptr<void> object)
+    {
+        if (object)
+        {
+            reaper().push(std::move(object));
+        }
+    }
+
+}
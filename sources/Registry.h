@@ -0,0 +1,121 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <map>
+#include <set>
+
+#include <flext.h>
+
+namespace rcp
+{
+
+    /* process-wide registry of named hosts (e.g. [rcp.client name])
+     * and the objects binding to them (e.g. [rcp.receive name ...]).
+     * bindings can register before their host exists.
+     * NOTE: only use from the main thread.
+     */
+    template <class host_type, class binding_type>
+    class Registry
+    {
+    public:
+        typedef std::set<binding_type*> binding_set;
+
+        static host_type* host(const t_symbol* name)
+        {
+            auto it = hosts().find(name);
+            return it != hosts().end() ? it->second : nullptr;
+        }
+
+        static bool addHost(const t_symbol* name, host_type* h)
+        {
+            return hosts().insert(std::make_pair(name, h)).second;
+        }
+
+        static void removeHost(const t_symbol* name, host_type* h)
+        {
+            auto it = hosts().find(name);
+            if (it != hosts().end() &&
+                    it->second == h)
+            {
+                hosts().erase(it);
+            }
+        }
+
+        static const binding_set& bindings(const t_symbol* name)
+        {
+            return allBindings()[name];
+        }
+
+        static void addBinding(const t_symbol* name, binding_type* b)
+        {
+            allBindings()[name].insert(b);
+        }
+
+        static void removeBinding(const t_symbol* name, binding_type* b)
+        {
+            auto it = allBindings().find(name);
+            if (it != allBindings().end())
+            {
+                it->second.erase(b);
+
+                if (it->second.empty())
+                {
+                    allBindings().erase(it);
+                }
+            }
+        }
+
+    private:
+        static std::map<const t_symbol*, host_type*>& hosts()
+        {
+            static std::map<const t_symbol*, host_type*> h;
+            return h;
+        }
+
+        static std::map<const t_symbol*, binding_set>& allBindings()
+        {
+            static std::map<const t_symbol*, binding_set> b;
+            return b;
+        }
+    };
+
+}
+
+#endif // REGISTRY_H
@@ -0,0 +1,220 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "ServerParameter.h"
+
+#include <stdexcept>
+
+namespace rcp
+{
+
+    ServerParameter::ServerParameter(int argc, t_atom *argv)
+    {
+        // <server> <type> <group> <group> ... <label>
+
+        if (argc < 3 ||
+                !IsSymbol(argv[0]))
+        {
+            throw std::runtime_error("please provide a server name, a type and a parameter path");
+        }
+
+        m_serverName = GetSymbol(argv[0]);
+
+        m_type = ParameterServer::parseType(argv[1]);
+        if (m_type == DATATYPE_INVALID)
+        {
+            throw std::invalid_argument("please provide a valid type (f, i, t, b, s)");
+        }
+
+        m_path.assign(argv+2, argv+argc);
+
+        AddInAnything();
+        AddOutAnything();
+
+        addValueMethods();
+    }
+
+    bool ServerParameter::Init()
+    {
+        if (!flext_base::Init())
+        {
+            return false;
+        }
+
+        ServerRegistry::addBinding(m_serverName, this);
+
+        ParameterServer* server = ServerRegistry::host(m_serverName);
+        if (server)
+        {
+            server->addBinding(this);
+        }
+
+        return true;
+    }
+
+    ServerParameter::~ServerParameter()
+    {
+        if (m_server)
+        {
+            m_server->removeBinding(this);
+        }
+
+        ServerRegistry::removeBinding(m_serverName, this);
+    }
+
+    void ServerParameter::attach(ParameterServer* server)
+    {
+        m_server = server;
+    }
+
+    void ServerParameter::detach()
+    {
+        unbound();
+        m_server = nullptr;
+    }
+
+    void ServerParameter::bound(rcp_parameter* parameter)
+    {
+        m_parameter = parameter;
+    }
+
+    void ServerParameter::unbound()
+    {
+        m_parameter = nullptr;
+    }
+
+    void ServerParameter::valueUpdated(rcp_parameter* parameter)
+    {
+        outputValue(parameter);
+    }
+
+    // input
+
+    void ServerParameter::sendValue(t_atom& atom)
+    {
+        if (m_server)
+        {
+            m_server->sendValue(m_parameter, atom);
+        }
+    }
+
+    void ServerParameter::sendBang()
+    {
+        if (m_server)
+        {
+            m_server->sendBang(m_parameter);
+        }
+    }
+
+    // options
+
+    void ServerParameter::_updateOptions(const ParameterOptions& options)
+    {
+        if (m_server &&
+                m_parameter)
+        {
+            m_server->updateOptions(m_parameter, options);
+        }
+    }
+
+    void ServerParameter::setMin(const float& f)
+    {
+        m_options.min.set(f);
+
+        ParameterOptions options;
+        options.min.set(f);
+        _updateOptions(options);
+    }
+    void ServerParameter::getMin(float& f)
+    {
+        f = m_options.min.isSet() ? m_options.min.get() : 0;
+    }
+
+    void ServerParameter::setMax(const float& f)
+    {
+        m_options.max.set(f);
+
+        ParameterOptions options;
+        options.max.set(f);
+        _updateOptions(options);
+    }
+    void ServerParameter::getMax(float& f)
+    {
+        f = m_options.max.isSet() ? m_options.max.get() : 0;
+    }
+
+    void ServerParameter::setReadonly(const bool& b)
+    {
+        m_options.readonly.set(b);
+
+        ParameterOptions options;
+        options.readonly.set(b);
+        _updateOptions(options);
+    }
+    void ServerParameter::getReadonly(bool& b)
+    {
+        b = m_options.readonly.isSet() && m_options.readonly.get();
+    }
+
+    void ServerParameter::setOrder(const int& i)
+    {
+        m_options.order.set(i);
+
+        ParameterOptions options;
+        options.order.set(i);
+        _updateOptions(options);
+    }
+    void ServerParameter::getOrder(int& i)
+    {
+        i = m_options.order.isSet() ? m_options.order.get() : 0;
+    }
+
+    void ServerParameter::setDeadband(const float& f)
+    {
+        m_options.deadband.set(f);
+
+        ParameterOptions options;
+        options.deadband.set(f);
+        _updateOptions(options);
+    }
+    void ServerParameter::getDeadband(float& f)
+    {
+        f = m_options.deadband.isSet() ? m_options.deadband.get() : 0;
+    }
+
+    FLEXT_LIB_V("rcp.param", ServerParameter);
+}
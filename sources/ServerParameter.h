@@ -0,0 +1,134 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef SERVERPARAMETER_H
+#define SERVERPARAMETER_H
+
+#include <vector>
+
+#include <rcp_parameter_type.h>
+
+#include "ParameterBinding.h"
+#include "ParameterServer.h"
+#include "Registry.h"
+
+namespace rcp
+{
+    class ServerParameter;
+
+    typedef Registry<ParameterServer, ServerParameter> ServerRegistry;
+
+    /* parameter exposed into a named rcp.server
+     * [rcp.param <server> <type> <group> ... <label>]
+     * options: @min @max @readonly @order @deadband
+     */
+    class ServerParameter : public ParameterBinding
+    {
+        FLEXT_HEADER_S(ServerParameter, flext_base, setup)
+
+    public:
+        ServerParameter(int argc, t_atom *argv);
+        ~ServerParameter();
+
+        rcp_datatype type() const { return m_type; }
+        std::vector<t_atom>& path() { return m_path; }
+        const ParameterOptions& options() const { return m_options; }
+
+        // called by ParameterServer
+        void attach(ParameterServer* server);
+        void detach();
+        void bound(rcp_parameter* parameter);
+        void unbound();
+        void valueUpdated(rcp_parameter* parameter);
+
+    protected:
+        // flext: called after construction and creation attributes,
+        // exposes the parameter with its options
+        bool Init() override;
+
+        static void setup(t_classid c)
+        {
+            FLEXT_CADDATTR_VAR(c, "min", getMin, setMin);
+            FLEXT_CADDATTR_VAR(c, "max", getMax, setMax);
+            FLEXT_CADDATTR_VAR(c, "readonly", getReadonly, setReadonly);
+            FLEXT_CADDATTR_VAR(c, "order", getOrder, setOrder);
+            FLEXT_CADDATTR_VAR(c, "deadband", getDeadband, setDeadband);
+        }
+
+        // ParameterBinding
+        void sendValue(t_atom& atom) override;
+        void sendBang() override;
+
+        // options
+        void setMin(const float& f);
+        void getMin(float& f);
+        void setMax(const float& f);
+        void getMax(float& f);
+        void setReadonly(const bool& b);
+        void getReadonly(bool& b);
+        void setOrder(const int& i);
+        void getOrder(int& i);
+        void setDeadband(const float& f);
+        void getDeadband(float& f);
+
+    private:
+        FLEXT_CALLSET_F(setMin)
+        FLEXT_CALLGET_F(getMin)
+        FLEXT_CALLSET_F(setMax)
+        FLEXT_CALLGET_F(getMax)
+        FLEXT_CALLSET_B(setReadonly)
+        FLEXT_CALLGET_B(getReadonly)
+        FLEXT_CALLSET_I(setOrder)
+        FLEXT_CALLGET_I(getOrder)
+        FLEXT_CALLSET_F(setDeadband)
+        FLEXT_CALLGET_F(getDeadband)
+
+        void _updateOptions(const ParameterOptions& options);
+
+    private:
+        const t_symbol* m_serverName{nullptr};
+        rcp_datatype m_type{DATATYPE_INVALID};
+        // groups and label
+        std::vector<t_atom> m_path;
+        ParameterOptions m_options;
+
+        ParameterServer* m_server{nullptr};
+    };
+
+}
+
+#endif // SERVERPARAMETER_H
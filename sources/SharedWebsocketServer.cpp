@@ -0,0 +1,230 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "SharedWebsocketServer.h"
+
+#include <vector>
+
+#include <flext.h>
+
+namespace rcp
+{
+
+    std::shared_ptr<SharedWebsocketServer> SharedWebsocketServer::get(uint16_t port, bool polled)
+    {
+        static std::map<uint16_t, std::weak_ptr<SharedWebsocketServer> > servers;
+
+        auto it = servers.find(port);
+        if (it != servers.end())
+        {
+            if (std::shared_ptr<SharedWebsocketServer> s = it->second.lock())
+            {
+                if (s->polled() != polled)
+                {
+                    // one listener can not be polled and threaded at once
+                    return nullptr;
+                }
+
+                return s;
+            }
+        }
+
+        std::shared_ptr<SharedWebsocketServer> s = std::make_shared<SharedWebsocketServer>(polled);
+        servers[port] = s;
+        s->run(port);
+
+        return s;
+    }
+
+    std::string SharedWebsocketServer::normalizePath(const std::string& path)
+    {
+        // strip query
+        std::string p = path.substr(0, path.find('?'));
+
+        if (p.empty() ||
+                p[0] != '/')
+        {
+            p.insert(0, "/");
+        }
+
+        while (p.size() > 1 &&
+               p[p.size()-1] == '/')
+        {
+            p.erase(p.size()-1);
+        }
+
+        return p;
+    }
+
+    SharedWebsocketServer::SharedWebsocketServer(bool polled)
+        : websocketServer(polled)
+    {
+    }
+
+    SharedWebsocketServer::~SharedWebsocketServer()
+    {
+        // stop threads before routing goes away
+        stop();
+    }
+
+    bool SharedWebsocketServer::addRoute(const std::string& path, ISharedWebsocketRoute* route)
+    {
+        lock_guard<mutex> guard(m_routeLock);
+        return m_routes.insert(std::make_pair(normalizePath(path), route)).second;
+    }
+
+    void SharedWebsocketServer::removeRoute(const std::string& path, ISharedWebsocketRoute* route)
+    {
+        std::vector<connection_hdl> to_close;
+
+        {
+            lock_guard<mutex> guard(m_routeLock);
+
+            auto it = m_routes.find(normalizePath(path));
+            if (it == m_routes.end() ||
+                    it->second != route)
+            {
+                return;
+            }
+
+            m_routes.erase(it);
+
+            for (auto r = m_routed.begin(); r != m_routed.end();)
+            {
+                if (r->second == route)
+                {
+                    to_close.push_back(r->first);
+                    r = m_routed.erase(r);
+                }
+                else
+                {
+                    ++r;
+                }
+            }
+        }
+
+        for (connection_hdl& hdl : to_close)
+        {
+            websocketpp::lib::error_code ec;
+            m_server.close(hdl, websocketpp::close::status::going_away, "route removed", ec);
+        }
+    }
+
+    void SharedWebsocketServer::socketerror(const char* reason)
+    {
+        error("websocketserver(%d): %s", port(), reason);
+    }
+
+    void SharedWebsocketServer::handle_action(const action& a)
+    {
+        if (a.type != MESSAGE)
+        {
+            // connection list - also for connections whose route is gone
+            websocketServer::handle_action(a);
+        }
+
+        // no locking needed when polled from the main thread
+        unique_lock<mutex> guard(m_routeLock, std::defer_lock);
+        if (!polled())
+        {
+            guard.lock();
+        }
+
+        auto it = m_routed.find(a.hdl);
+        if (it == m_routed.end())
+        {
+            // route was removed
+            return;
+        }
+
+        ISharedWebsocketRoute* route = it->second;
+
+        if (a.type == SUBSCRIBE)
+        {
+            route->opened(a.hdl);
+        }
+        else if (a.type == UNSUBSCRIBE)
+        {
+            m_routed.erase(it);
+            route->closed(a.hdl);
+        }
+        else if (a.type == MESSAGE)
+        {
+            if (a.msg->get_opcode() == websocketpp::frame::opcode::value::binary)
+            {
+                if (auto ptr = a.hdl.lock())
+                {
+                    const std::string & data = a.msg->get_raw_payload();
+
+                    route->received(const_cast<char*>(data.data()), data.size(), ptr.get());
+                }
+            }
+        }
+    }
+
+    bool SharedWebsocketServer::validate(connection_hdl hdl)
+    {
+        websocketpp::lib::error_code ec;
+        server::connection_ptr con = m_server.get_con_from_hdl(hdl, ec);
+        if (ec || !con)
+        {
+            return false;
+        }
+
+        std::string path = normalizePath(con->get_resource());
+
+        lock_guard<mutex> guard(m_routeLock);
+
+        auto it = m_routes.find(path);
+        if (it == m_routes.end())
+        {
+            con->set_status(websocketpp::http::status_code::not_found);
+            return false;
+        }
+
+        m_routed[hdl] = it->second;
+        return true;
+    }
+
+    void SharedWebsocketServer::handshake_failed(connection_hdl hdl)
+    {
+        // validated but handshake failed
+        lock_guard<mutex> guard(m_routeLock);
+        m_routed.erase(hdl);
+    }
+
+}
@@ -0,0 +1,102 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef SHAREDWEBSOCKETSERVER_H
+#define SHAREDWEBSOCKETSERVER_H
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "websocketServer.h"
+
+namespace rcp
+{
+
+    class ISharedWebsocketRoute
+    {
+    public:
+        virtual void opened(connection_hdl hdl) = 0;
+        virtual void closed(connection_hdl hdl) = 0;
+        virtual void received(char* data, size_t size, void* id) = 0;
+    };
+
+
+    /* one listener per port shared by multiple routes.
+     * the upgrade request is routed by its path (ws://host:port/path),
+     * unknown paths are rejected with 404.
+     */
+    class SharedWebsocketServer : public websocketServer
+    {
+    public:
+        // get or create the listener for port.
+        // returns nullptr if the port is shared with a different polled mode
+        // NOTE: only use from the main thread
+        static std::shared_ptr<SharedWebsocketServer> get(uint16_t port, bool polled = false);
+        static std::string normalizePath(const std::string& path);
+
+        SharedWebsocketServer(bool polled = false);
+        ~SharedWebsocketServer();
+
+        bool listening() const { return m_server.is_listening(); }
+
+        bool addRoute(const std::string& path, ISharedWebsocketRoute* route);
+        void removeRoute(const std::string& path, ISharedWebsocketRoute* route);
+
+    public:
+        // IWebsocketServerListener
+        void connected(void* /*client*/) override {}
+        void disconnected(void* /*client*/) override {}
+        void received(char* /*data*/, size_t /*size*/, void* /*id*/) override {}
+        void socketerror(const char* reason) override;
+
+    protected:
+        void handle_action(const action& a) override;
+        bool validate(connection_hdl hdl) override;
+        void handshake_failed(connection_hdl hdl) override;
+
+    private:
+        typedef std::map<connection_hdl, ISharedWebsocketRoute*, std::owner_less<connection_hdl> > route_list;
+
+        std::map<std::string, ISharedWebsocketRoute*> m_routes;
+        route_list m_routed;
+        mutex m_routeLock;
+    };
+
+}
+
+#endif // SHAREDWEBSOCKETSERVER_H
@@ -0,0 +1,239 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "SharedWebsocketServerTransporter.h"
+
+#include <rcp_memory.h>
+
+#include <flext.h>
+
+//
+void _pd_shared_websocket_server_transporter_sendToOne(rcp_server_transporter* transporter, char* data, size_t data_size, void* id)
+{
+    if (transporter &&
+            transporter->user)
+    {
+        ((rcp::SharedWebsocketServerTransporter*)transporter->user)->sendToOne(data, data_size, id);
+    }
+}
+
+void _pd_shared_websocket_server_transporter_sendToAll(rcp_server_transporter* transporter, char* data, size_t data_size, void* excludeId)
+{
+    if (transporter &&
+            transporter->user)
+    {
+        ((rcp::SharedWebsocketServerTransporter*)transporter->user)->sendToAll(data, data_size, excludeId);
+    }
+}
+
+
+namespace rcp
+{
+    SharedWebsocketServerTransporter::SharedWebsocketServerTransporter(rcp_server* server, IWebsocketServerListener* listener, const std::string& path, bool polled)
+        : m_rcpServer(server)
+        , m_transporter(nullptr)
+        , m_listener(listener)
+        , m_path(SharedWebsocketServer::normalizePath(path))
+        , m_polled(polled)
+    {
+        m_transporter = (rcp_server_transporter*)RCP_CALLOC(1, sizeof(rcp_server_transporter));
+
+        if (m_transporter)
+        {
+            rcp_server_transporter_setup(m_transporter,
+                                         _pd_shared_websocket_server_transporter_sendToOne,
+                                         _pd_shared_websocket_server_transporter_sendToAll);
+
+            rcp_server_add_transporter(m_rcpServer, m_transporter);
+
+            m_transporter->user = this;
+        }
+    }
+
+    SharedWebsocketServerTransporter::~SharedWebsocketServerTransporter()
+    {
+        unbind();
+
+        if (m_transporter)
+        {
+            // remove transporter from rcp_Server
+            rcp_server_remove_transporter(m_rcpServer, m_transporter);
+
+            RCP_FREE(m_transporter);
+            m_transporter = nullptr;
+        }
+    }
+
+
+    // IServerTransporter
+    rcp_server_transporter* SharedWebsocketServerTransporter::transporter() const
+    {
+        return m_transporter;
+    }
+
+    void SharedWebsocketServerTransporter::bind(uint16_t port)
+    {
+        unbind();
+
+        std::shared_ptr<SharedWebsocketServer> shared = SharedWebsocketServer::get(port, m_polled);
+
+        if (!shared)
+        {
+            error("websocketserver(%d): port is shared with a %s server", port, m_polled ? "threaded" : "polled");
+            return;
+        }
+
+        if (!shared->addRoute(m_path, this))
+        {
+            error("websocketserver(%d): path '%s' already in use", port, m_path.c_str());
+            return;
+        }
+
+        m_shared = shared;
+    }
+
+    void SharedWebsocketServerTransporter::unbind()
+    {
+        if (m_shared)
+        {
+            m_shared->removeRoute(m_path, this);
+            m_shared.reset();
+        }
+
+        std::lock_guard<std::mutex> guard(m_connectionLock);
+        m_connections.clear();
+    }
+
+    uint16_t SharedWebsocketServerTransporter::port() const
+    {
+        return m_shared ? m_shared->port() : 0;
+    }
+
+    bool SharedWebsocketServerTransporter::isListening() const
+    {
+        return m_shared && m_shared->listening();
+    }
+
+
+    // ISharedWebsocketRoute
+    void SharedWebsocketServerTransporter::opened(connection_hdl hdl)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_connectionLock);
+            m_connections.insert(hdl);
+        }
+
+        if (m_listener)
+        {
+            m_listener->connected(nullptr);
+        }
+    }
+
+    void SharedWebsocketServerTransporter::closed(connection_hdl hdl)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_connectionLock);
+            m_connections.erase(hdl);
+        }
+
+        if (m_listener)
+        {
+            m_listener->disconnected(nullptr);
+        }
+    }
+
+    void SharedWebsocketServerTransporter::received(char* data, size_t size, void* client)
+    {
+        if (m_transporter &&
+                data  &&
+                size > 0)
+        {
+            if (m_transporter->received)
+            {
+                m_transporter->received(m_transporter->server,
+                                        data,
+                                        size,
+                                        client);
+            }
+        }
+    }
+
+    void SharedWebsocketServerTransporter::sendToOne(char* data, size_t size, void* id)
+    {
+        if (!m_shared ||
+                id == nullptr)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(m_connectionLock);
+
+        for (auto& conn : m_connections)
+        {
+            if (auto p = conn.lock())
+            {
+                if (id == p.get())
+                {
+                    m_shared->sendTo(conn, data, size);
+                }
+            }
+        }
+    }
+
+    void SharedWebsocketServerTransporter::sendToAll(char* data, size_t size, void* excludeId)
+    {
+        if (!m_shared)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(m_connectionLock);
+
+        for (auto& conn : m_connections)
+        {
+            if (auto p = conn.lock())
+            {
+                if (excludeId == p.get())
+                {
+                    continue;
+                }
+                m_shared->sendTo(conn, data, size);
+            }
+        }
+    }
+
+} // namespace rcp
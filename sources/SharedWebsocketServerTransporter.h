@@ -0,0 +1,97 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef SHAREDWEBSOCKETSERVERTRANSPORTER_H
+#define SHAREDWEBSOCKETSERVERTRANSPORTER_H
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <rcp_server_transporter.h>
+
+#include "IServerTransporter.h"
+#include "SharedWebsocketServer.h"
+
+namespace rcp
+{
+
+    // server transporter on a shared websocket listener: ws://host:port/path
+    class SharedWebsocketServerTransporter
+            : public IServerTransporter
+            , public ISharedWebsocketRoute
+    {
+    public:
+        SharedWebsocketServerTransporter(rcp_server* server, IWebsocketServerListener* listener, const std::string& path, bool polled = false);
+        ~SharedWebsocketServerTransporter();
+
+        const std::string& path() const { return m_path; }
+
+        void sendToOne(char* data, size_t size, void* id);
+        void sendToAll(char* data, size_t size, void* excludeId);
+
+    public:
+        // IServerTransporter
+        rcp_server_transporter* transporter() const override;
+        void bind(uint16_t port) override;
+        void unbind() override;
+        uint16_t port() const override;
+        bool isListening() const override;
+
+    public:
+        // ISharedWebsocketRoute
+        void opened(connection_hdl hdl) override;
+        void closed(connection_hdl hdl) override;
+        void received(char* data, size_t size, void* id) override;
+
+    private:
+        typedef std::set<connection_hdl, std::owner_less<connection_hdl> > con_list;
+
+        rcp_server* m_rcpServer{nullptr};
+        rcp_server_transporter* m_transporter{nullptr};
+        IWebsocketServerListener* m_listener{nullptr};
+        std::string m_path;
+        bool m_polled{false};
+
+        std::shared_ptr<SharedWebsocketServer> m_shared;
+        con_list m_connections;
+        std::mutex m_connectionLock;
+    };
+}
+
+#endif // SHAREDWEBSOCKETSERVERTRANSPORTER_H
@@ -0,0 +1,641 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "ShmChannel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#define RCP_SHM_MAGIC 0x52435053 // RCPS
+#define RCP_SHM_VERSION 1
+// reader wakes up at least this often to check the peer (ms)
+#define RCP_SHM_CHECK_INTERVAL 100
+
+namespace rcp
+{
+    static_assert((RCP_SHM_RING_SIZE & (RCP_SHM_RING_SIZE - 1)) == 0, "RCP_SHM_RING_SIZE must be a power of two");
+
+    // counters run freely, position in ring is counter & (size-1)
+    struct ShmRing
+    {
+        alignas(64) std::atomic<uint32_t> head; // written by producer
+        alignas(64) std::atomic<uint32_t> tail; // written by consumer
+        alignas(64) std::atomic<uint32_t> wake; // futex word
+        std::atomic<uint32_t> sleeping;
+    };
+
+    struct ShmSegment
+    {
+        std::atomic<uint32_t> magic;
+        uint32_t version;
+        uint32_t ringSize;
+        std::atomic<int32_t> serverPid;
+        std::atomic<int32_t> clientPid; // 0: no client
+        ShmRing toClient;
+        ShmRing toServer;
+        // followed by: toClient data, toServer data
+    };
+
+    static inline char* ringData(ShmSegment* s, bool toClient)
+    {
+        char* base = reinterpret_cast<char*>(s) + sizeof(ShmSegment);
+        return toClient ? base : base + s->ringSize;
+    }
+
+#ifndef _WIN32
+
+    static bool processAlive(int32_t pid)
+    {
+        return pid > 0 &&
+                (kill(pid, 0) == 0 || errno == EPERM);
+    }
+
+    static void ringWait(ShmRing& ring, uint32_t value)
+    {
+#ifdef __linux__
+        struct timespec ts;
+        ts.tv_sec = 0;
+        ts.tv_nsec = RCP_SHM_CHECK_INTERVAL * 1000000L;
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&ring.wake), FUTEX_WAIT, value, &ts, nullptr, 0);
+#else
+        // back off
+        for (int i=0; i<RCP_SHM_CHECK_INTERVAL; i++)
+        {
+            if (ring.wake.load(std::memory_order_acquire) != value)
+            {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+#endif
+    }
+
+#endif
+
+
+    ShmChannel::ShmChannel(role r)
+        : m_role(r)
+    {
+    }
+
+    ShmChannel::~ShmChannel()
+    {
+        close();
+    }
+
+    bool ShmChannel::open(const std::string& name)
+    {
+        close();
+
+#ifdef _WIN32
+        (void)name;
+        std::cout << "shm transport is not supported on this platform" << std::endl;
+        return false;
+#else
+        if (name.empty())
+        {
+            return false;
+        }
+
+        m_name = name;
+        m_path = "/rcp-" + name;
+
+        bool ok = (m_role == SERVER) ? _openServer(m_path) : _openClient(m_path);
+        if (!ok)
+        {
+            close();
+            return false;
+        }
+
+        m_run = true;
+        m_thread = std::thread(&ShmChannel::_readLoop, this);
+        return true;
+#endif
+    }
+
+    void ShmChannel::detachHandlers()
+    {
+        std::lock_guard<std::mutex> guard(m_handlerLock);
+        m_detached = true;
+    }
+
+    void ShmChannel::close()
+    {
+#ifndef _WIN32
+        if (m_thread.joinable())
+        {
+            m_run = false;
+            _wake(_inRing());
+            m_thread.join();
+        }
+
+        if (m_segment)
+        {
+            // only release what we own
+            int32_t pid = (int32_t)getpid();
+
+            if (m_role == SERVER)
+            {
+                if (m_segment->serverPid.compare_exchange_strong(pid, 0))
+                {
+                    _wake(m_segment->toClient);
+                    shm_unlink(m_path.c_str());
+                }
+            }
+            else
+            {
+                if (m_segment->clientPid.compare_exchange_strong(pid, 0))
+                {
+                    _wake(m_segment->toServer);
+                }
+            }
+
+            munmap(m_segment, m_size);
+            m_segment = nullptr;
+        }
+
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+#endif
+
+        m_size = 0;
+        m_peerConnected = false;
+        m_peerPid = 0;
+        m_overflow = false;
+    }
+
+#ifndef _WIN32
+
+    bool ShmChannel::_openServer(const std::string& path)
+    {
+        m_size = sizeof(ShmSegment) + 2 * RCP_SHM_RING_SIZE;
+
+        m_fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (m_fd < 0 &&
+                errno == EEXIST)
+        {
+            // check for a stale segment of a dead server
+            int fd = shm_open(path.c_str(), O_RDWR, 0600);
+            if (fd >= 0)
+            {
+                struct stat st;
+                if (fstat(fd, &st) == 0 &&
+                        (size_t)st.st_size >= sizeof(ShmSegment))
+                {
+                    void* p = mmap(nullptr, sizeof(ShmSegment), PROT_READ, MAP_SHARED, fd, 0);
+                    if (p != MAP_FAILED)
+                    {
+                        int32_t pid = static_cast<ShmSegment*>(p)->serverPid.load(std::memory_order_acquire);
+                        munmap(p, sizeof(ShmSegment));
+
+                        if (processAlive(pid))
+                        {
+                            ::close(fd);
+                            std::cout << "shm: '" << m_name << "' is already in use" << std::endl;
+                            return false;
+                        }
+                    }
+                }
+                ::close(fd);
+            }
+
+            shm_unlink(path.c_str());
+            m_fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        }
+
+        if (m_fd < 0)
+        {
+            std::cout << "shm: could not create '" << m_name << "': " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        if (ftruncate(m_fd, (off_t)m_size) != 0)
+        {
+            std::cout << "shm: could not size '" << m_name << "': " << strerror(errno) << std::endl;
+            shm_unlink(path.c_str());
+            return false;
+        }
+
+        void* p = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (p == MAP_FAILED)
+        {
+            std::cout << "shm: could not map '" << m_name << "': " << strerror(errno) << std::endl;
+            shm_unlink(path.c_str());
+            return false;
+        }
+
+        m_segment = new (p) ShmSegment();
+        m_segment->version = RCP_SHM_VERSION;
+        m_segment->ringSize = RCP_SHM_RING_SIZE;
+        m_segment->serverPid.store((int32_t)getpid());
+        m_segment->clientPid.store(0);
+        for (ShmRing* r : { &m_segment->toClient, &m_segment->toServer })
+        {
+            r->head.store(0);
+            r->tail.store(0);
+            r->wake.store(0);
+            r->sleeping.store(0);
+        }
+
+        // publish
+        m_segment->magic.store(RCP_SHM_MAGIC, std::memory_order_release);
+
+        return true;
+    }
+
+    bool ShmChannel::_openClient(const std::string& path)
+    {
+        m_fd = shm_open(path.c_str(), O_RDWR, 0600);
+        if (m_fd < 0)
+        {
+            std::cout << "shm: could not open '" << m_name << "': " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(m_fd, &st) != 0 ||
+                (size_t)st.st_size < sizeof(ShmSegment))
+        {
+            std::cout << "shm: invalid segment '" << m_name << "'" << std::endl;
+            return false;
+        }
+
+        m_size = (size_t)st.st_size;
+
+        void* p = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (p == MAP_FAILED)
+        {
+            std::cout << "shm: could not map '" << m_name << "': " << strerror(errno) << std::endl;
+            m_size = 0;
+            return false;
+        }
+
+        m_segment = static_cast<ShmSegment*>(p);
+
+        if (m_segment->magic.load(std::memory_order_acquire) != RCP_SHM_MAGIC ||
+                m_segment->version != RCP_SHM_VERSION ||
+                m_size < sizeof(ShmSegment) + 2 * (size_t)m_segment->ringSize ||
+                !processAlive(m_segment->serverPid.load(std::memory_order_acquire)))
+        {
+            std::cout << "shm: no server on '" << m_name << "'" << std::endl;
+            return false;
+        }
+
+        int32_t pid = (int32_t)getpid();
+        int32_t current = m_segment->clientPid.load(std::memory_order_acquire);
+        if (current != 0 && processAlive(current))
+        {
+            std::cout << "shm: '" << m_name << "' already has a client" << std::endl;
+            return false;
+        }
+
+        // discard anything left for a previous client before the server
+        // can see us. we are the consumer of this ring, so this is ours to do.
+        // frames a previous client left in toServer are complete and get
+        // drained by the server - everything we write follows them.
+        m_segment->toClient.tail.store(m_segment->toClient.head.load(std::memory_order_acquire), std::memory_order_release);
+
+        // claim the client slot - take over from dead clients
+        if (!m_segment->clientPid.compare_exchange_strong(current, pid))
+        {
+            std::cout << "shm: '" << m_name << "' already has a client" << std::endl;
+            return false;
+        }
+
+        m_peerConnected = true;
+
+        // let the server notice us
+        _wake(m_segment->toServer);
+
+        return true;
+    }
+
+    void ShmChannel::_wake(ShmRing& ring)
+    {
+        ring.wake.fetch_add(1, std::memory_order_release);
+
+#ifdef __linux__
+        if (ring.sleeping.load(std::memory_order_acquire))
+        {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&ring.wake), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+#endif
+    }
+
+    void ShmChannel::_readLoop()
+    {
+        ShmRing& ring = _inRing();
+        const char* data = _inData();
+
+        while (m_run)
+        {
+            uint32_t wake = ring.wake.load(std::memory_order_acquire);
+
+            _checkPeer();
+
+            if (_drain(ring, data))
+            {
+                continue;
+            }
+
+            ring.sleeping.store(1, std::memory_order_release);
+            if (m_run &&
+                    ring.head.load(std::memory_order_acquire) == ring.tail.load(std::memory_order_relaxed))
+            {
+                ringWait(ring, wake);
+            }
+            ring.sleeping.store(0, std::memory_order_release);
+        }
+    }
+
+    bool ShmChannel::_drain(ShmRing& ring, const char* data)
+    {
+        const uint32_t mask = m_segment->ringSize - 1;
+        uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+        uint32_t head = ring.head.load(std::memory_order_acquire);
+
+        if (tail == head)
+        {
+            return false;
+        }
+
+        if (head - tail > m_segment->ringSize)
+        {
+            std::cout << "shm: corrupt ring on '" << m_name << "' - resetting" << std::endl;
+            ring.tail.store(head, std::memory_order_release);
+            return true;
+        }
+
+        while (tail != head)
+        {
+            uint32_t size = 0;
+            if (head - tail >= sizeof(size))
+            {
+                for (size_t i=0; i<sizeof(size); i++)
+                {
+                    reinterpret_cast<char*>(&size)[i] = data[(tail + i) & mask];
+                }
+            }
+
+            // the peer is not trusted: a frame must fit into what was published
+            if (size == 0 ||
+                    size > head - tail - sizeof(size))
+            {
+                std::cout << "shm: invalid frame on '" << m_name << "' - resetting" << std::endl;
+                ring.tail.store(head, std::memory_order_release);
+                return true;
+            }
+
+            tail += sizeof(size);
+
+            uint32_t pos = tail & mask;
+            if (pos + size <= m_segment->ringSize)
+            {
+                // contiguous - no copy
+                _dispatch(data + pos, size);
+            }
+            else
+            {
+                uint32_t first = m_segment->ringSize - pos;
+                m_frame.resize(size);
+                memcpy(m_frame.data(), data + pos, first);
+                memcpy(m_frame.data() + first, data, size - first);
+                _dispatch(m_frame.data(), size);
+            }
+
+            tail += size;
+            ring.tail.store(tail, std::memory_order_release);
+        }
+
+        return true;
+    }
+
+    void ShmChannel::_checkPeer()
+    {
+        int32_t pid = (m_role == SERVER) ?
+                    m_segment->clientPid.load(std::memory_order_acquire) :
+                    m_segment->serverPid.load(std::memory_order_acquire);
+
+        if (m_overflow &&
+                m_peerConnected)
+        {
+            // send() dropped the client
+            pid = 0;
+        }
+        else if (m_role == CLIENT &&
+                m_segment->clientPid.load(std::memory_order_acquire) != (int32_t)getpid())
+        {
+            // the server dropped us - like a server going away
+            pid = 0;
+        }
+
+        // only ask the system once in a while if the peer is still alive
+        auto now = std::chrono::steady_clock::now();
+        if (pid == m_peerPid &&
+                now - m_peerCheck < std::chrono::milliseconds(RCP_SHM_CHECK_INTERVAL))
+        {
+            return;
+        }
+
+        m_peerPid = pid;
+        m_peerCheck = now;
+
+        bool connected = processAlive(pid);
+
+        if (connected != m_peerConnected)
+        {
+            std::lock_guard<std::mutex> guard(m_handlerLock);
+            if (m_detached)
+            {
+                return;
+            }
+
+            m_peerConnected = connected;
+
+            if (connected)
+            {
+                // a new client starts in sync
+                m_overflow = false;
+            }
+
+            if (m_stateHandler)
+            {
+                m_stateHandler(connected);
+            }
+        }
+    }
+
+    void ShmChannel::_dropClient()
+    {
+        // server: the client can not read fast enough
+        // client: the server can not
+        int32_t client = (m_role == SERVER) ?
+                    m_segment->clientPid.load(std::memory_order_acquire) :
+                    (int32_t)getpid();
+
+        if (client != 0)
+        {
+            m_segment->clientPid.compare_exchange_strong(client, 0);
+        }
+
+        // both readers check the client slot
+        _wake(_inRing());
+        _wake(_outRing());
+    }
+
+    void ShmChannel::_dispatch(const char* data, size_t size)
+    {
+        std::lock_guard<std::mutex> guard(m_handlerLock);
+        if (!m_detached &&
+                m_receiveHandler)
+        {
+            m_receiveHandler(data, size);
+        }
+    }
+
+#else
+
+    bool ShmChannel::_openServer(const std::string&) { return false; }
+    bool ShmChannel::_openClient(const std::string&) { return false; }
+    void ShmChannel::_readLoop() {}
+    bool ShmChannel::_drain(ShmRing&, const char*) { return false; }
+    void ShmChannel::_checkPeer() {}
+    void ShmChannel::_wake(ShmRing&) {}
+    void ShmChannel::_dispatch(const char*, size_t) {}
+    void ShmChannel::_dropClient() {}
+
+#endif
+
+    bool ShmChannel::send(const char* data, size_t size)
+    {
+        if (!m_segment ||
+                !m_peerConnected ||
+                m_overflow ||
+                size == 0)
+        {
+            return false;
+        }
+
+        const uint32_t ring_size = m_segment->ringSize;
+        const uint32_t need = (uint32_t)(size + sizeof(uint32_t));
+
+        if (need > ring_size)
+        {
+            std::cout << "shm: packet too large: " << size << std::endl;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> guard(m_sendLock);
+
+        ShmRing& ring = _outRing();
+        char* out = _outData();
+        const uint32_t mask = ring_size - 1;
+        uint32_t head = ring.head.load(std::memory_order_relaxed);
+
+        // this runs on the pd thread - never wait for the peer.
+        // skipping the packet could lose structure, drop the client instead
+        if (ring_size - (head - ring.tail.load(std::memory_order_acquire)) < need)
+        {
+            if (!m_overflow.exchange(true))
+            {
+                std::cout << "shm: ring full on '" << m_name << "' - disconnecting the client" << std::endl;
+                _dropClient();
+            }
+            return false;
+        }
+
+        uint32_t size32 = (uint32_t)size;
+        for (size_t i=0; i<sizeof(size32); i++)
+        {
+            out[(head + i) & mask] = reinterpret_cast<const char*>(&size32)[i];
+        }
+        head += sizeof(size32);
+
+        uint32_t pos = head & mask;
+        uint32_t first = std::min<uint32_t>(size32, ring_size - pos);
+        memcpy(out + pos, data, first);
+        memcpy(out, data + first, size32 - first);
+        head += size32;
+
+        ring.head.store(head, std::memory_order_release);
+
+        _wake(ring);
+
+        return true;
+    }
+
+    ShmRing& ShmChannel::_inRing()
+    {
+        return m_role == SERVER ? m_segment->toServer : m_segment->toClient;
+    }
+
+    ShmRing& ShmChannel::_outRing()
+    {
+        return m_role == SERVER ? m_segment->toClient : m_segment->toServer;
+    }
+
+    char* ShmChannel::_inData()
+    {
+        return ringData(m_segment, m_role == CLIENT);
+    }
+
+    char* ShmChannel::_outData()
+    {
+        return ringData(m_segment, m_role == SERVER);
+    }
+
+}
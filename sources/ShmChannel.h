@@ -0,0 +1,145 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef SHMCHANNEL_H
+#define SHMCHANNEL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ring size per direction in bytes - must be a power of two
+#ifndef RCP_SHM_RING_SIZE
+#define RCP_SHM_RING_SIZE (1 << 20)
+#endif
+
+namespace rcp
+{
+    struct ShmSegment;
+    struct ShmRing;
+
+    /* shared memory transport between two processes on the same machine.
+     * a POSIX shm segment holds one lock-free single-producer/single-consumer
+     * ring per direction. frames: [uint32 size][data].
+     * the reader thread sleeps on a futex (linux) or backs off (others).
+     * one server and one client per segment.
+     * NOTE: not available on windows
+     */
+    class ShmChannel
+    {
+    public:
+        enum role {
+            SERVER,
+            CLIENT
+        };
+
+        typedef std::function<void(const char*, size_t)> receive_handler;
+        // server: client connected / disconnected
+        // client: server gone
+        typedef std::function<void(bool)> state_handler;
+
+        ShmChannel(role r);
+        ~ShmChannel();
+
+        bool open(const std::string& name);
+        void close();
+        bool isOpen() const { return m_segment != nullptr; }
+        bool peerConnected() const { return m_peerConnected; }
+        const std::string& name() const { return m_name; }
+
+        void setReceiveHandler(receive_handler handler) { m_receiveHandler = handler; }
+        void setStateHandler(state_handler handler) { m_stateHandler = handler; }
+
+        // stop calling the handlers, peerConnected() keeps what was reported.
+        // waits for a running call, does not join the reader thread:
+        // close() may then run on any thread (see Reaper)
+        void detachHandlers();
+
+        // never blocks: returns false if peer is not connected or the ring is full.
+        // a full ring drops the client: a lost packet may be structural,
+        // the client has to connect again and re-init
+        bool send(const char* data, size_t size);
+
+    private:
+        bool _openServer(const std::string& path);
+        bool _openClient(const std::string& path);
+        void _readLoop();
+        bool _drain(ShmRing& ring, const char* data);
+        void _checkPeer();
+        void _dispatch(const char* data, size_t size);
+        void _dropClient();
+        void _wake(ShmRing& ring);
+
+        ShmRing& _inRing();
+        ShmRing& _outRing();
+        char* _inData();
+        char* _outData();
+
+    private:
+        role m_role;
+        std::string m_name;
+        std::string m_path;
+
+        ShmSegment* m_segment{nullptr};
+        size_t m_size{0};
+        int m_fd{-1};
+
+        std::thread m_thread;
+        std::atomic<bool> m_run{false};
+        std::atomic<bool> m_peerConnected{false};
+        int32_t m_peerPid{0};
+        std::chrono::steady_clock::time_point m_peerCheck;
+        std::mutex m_sendLock;
+        // set on a full ring until the next client connects
+        std::atomic<bool> m_overflow{false};
+        std::vector<char> m_frame;
+
+        receive_handler m_receiveHandler;
+        state_handler m_stateHandler;
+        // held while calling a handler
+        std::mutex m_handlerLock;
+        bool m_detached{false};
+    };
+
+}
+
+#endif // SHMCHANNEL_H
@@ -0,0 +1,167 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "ShmClientTransporter.h"
+
+#include <rcp_memory.h>
+
+// callbacks
+static void _pd_shm_client_transporter_send(rcp_client_transporter* transporter, char* data, size_t size)
+{
+    if (transporter &&
+            transporter->user)
+    {
+        ((rcp::ShmClientTransporter*)transporter->user)->send(data, size);
+    }
+}
+
+namespace rcp
+{
+    ShmClientTransporter::ShmClientTransporter(IWebsocketClientListener* listener)
+        : m_transporter(nullptr)
+        , m_listener(listener)
+        , m_channel(ShmChannel::CLIENT)
+    {
+        m_transporter = (rcp_client_transporter*)RCP_CALLOC(1, sizeof(rcp_client_transporter));
+
+        if (m_transporter)
+        {
+            rcp_client_transporter_setup(m_transporter,
+                                         _pd_shm_client_transporter_send);
+
+            m_transporter->user = this;
+        }
+
+        m_channel.setReceiveHandler(std::bind(&ShmClientTransporter::_received, this, std::placeholders::_1, std::placeholders::_2));
+        m_channel.setStateHandler(std::bind(&ShmClientTransporter::_peerState, this, std::placeholders::_1));
+    }
+
+    ShmClientTransporter::~ShmClientTransporter()
+    {
+        // stop reader thread first
+        m_channel.close();
+
+        if (m_transporter)
+        {
+            RCP_FREE(m_transporter);
+            m_transporter = nullptr;
+        }
+    }
+
+    void ShmClientTransporter::send(char* data, size_t size)
+    {
+        m_channel.send(data, size);
+    }
+
+    // IClientTransporter
+    rcp_client_transporter* ShmClientTransporter::transporter() const
+    {
+        return m_transporter;
+    }
+
+    void ShmClientTransporter::open(const std::string& address)
+    {
+        close();
+
+        if (!m_channel.open(address))
+        {
+            if (m_listener)
+            {
+                m_listener->failed(0);
+            }
+            return;
+        }
+
+        if (m_transporter)
+        {
+            rcp_client_transporter_call_connected_cb(m_transporter);
+        }
+
+        if (m_listener)
+        {
+            m_listener->connected();
+        }
+    }
+
+    void ShmClientTransporter::close()
+    {
+        if (!m_channel.isOpen())
+        {
+            return;
+        }
+
+        m_channel.close();
+
+        if (m_transporter)
+        {
+            // NOTE: this re-creates the client manager
+            rcp_client_transporter_call_disconnected_cb(m_transporter);
+        }
+
+        if (m_listener)
+        {
+            m_listener->disconnected(0);
+        }
+    }
+
+    // ShmChannel - called on the reader thread
+    void ShmClientTransporter::_received(const char* data, size_t size)
+    {
+        if (m_transporter)
+        {
+            rcp_client_transporter_call_recv_cb(m_transporter, const_cast<char*>(data), size);
+        }
+    }
+
+    void ShmClientTransporter::_peerState(bool connected)
+    {
+        if (!connected)
+        {
+            // server went away
+            if (m_transporter)
+            {
+                rcp_client_transporter_call_disconnected_cb(m_transporter);
+            }
+
+            if (m_listener)
+            {
+                m_listener->disconnected(0);
+            }
+        }
+    }
+
+} // namespace rcp
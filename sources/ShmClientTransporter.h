@@ -0,0 +1,76 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef SHMCLIENTTRANSPORTER_H
+#define SHMCLIENTTRANSPORTER_H
+
+#include <rcp_client_transporter.h>
+
+#include "IClientTransporter.h"
+#include "ShmChannel.h"
+#include "websocketClient.h"
+
+namespace rcp
+{
+
+    // client transporter to a server on the same machine via shared memory
+    // address: name of the server's shm segment
+    class ShmClientTransporter : public IClientTransporter
+    {
+    public:
+        ShmClientTransporter(IWebsocketClientListener* listener);
+        ~ShmClientTransporter();
+
+        void send(char* data, size_t size);
+
+        // IClientTransporter
+        rcp_client_transporter* transporter() const override;
+        void open(const std::string& address) override;
+        void close() override;
+
+    private:
+        void _received(const char* data, size_t size);
+        void _peerState(bool connected);
+
+    private:
+        rcp_client_transporter* m_transporter{nullptr};
+        IWebsocketClientListener* m_listener{nullptr};
+        ShmChannel m_channel;
+    };
+}
+
+#endif // SHMCLIENTTRANSPORTER_H
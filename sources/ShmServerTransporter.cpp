@@ -0,0 +1,191 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "ShmServerTransporter.h"
+
+#include <rcp_memory.h>
+
+//
+void _pd_shm_server_transporter_sendToOne(rcp_server_transporter* transporter, char* data, size_t data_size, void* id)
+{
+    if (transporter &&
+            transporter->user)
+    {
+        ((rcp::ShmServerTransporter*)transporter->user)->sendToOne(data, data_size, id);
+    }
+}
+
+void _pd_shm_server_transporter_sendToAll(rcp_server_transporter* transporter, char* data, size_t data_size, void* excludeId)
+{
+    if (transporter &&
+            transporter->user)
+    {
+        ((rcp::ShmServerTransporter*)transporter->user)->sendToAll(data, data_size, excludeId);
+    }
+}
+
+
+namespace rcp
+{
+    ShmServerTransporter::ShmServerTransporter(rcp_server* server, IWebsocketServerListener* listener)
+        : m_rcpServer(server)
+        , m_transporter(nullptr)
+        , m_listener(listener)
+        , m_channel(ShmChannel::SERVER)
+    {
+        m_transporter = (rcp_server_transporter*)RCP_CALLOC(1, sizeof(rcp_server_transporter));
+
+        if (m_transporter)
+        {
+            rcp_server_transporter_setup(m_transporter,
+                                         _pd_shm_server_transporter_sendToOne,
+                                         _pd_shm_server_transporter_sendToAll);
+
+            rcp_server_add_transporter(m_rcpServer, m_transporter);
+
+            m_transporter->user = this;
+        }
+
+        m_channel.setReceiveHandler(std::bind(&ShmServerTransporter::_received, this, std::placeholders::_1, std::placeholders::_2));
+        m_channel.setStateHandler(std::bind(&ShmServerTransporter::_peerState, this, std::placeholders::_1));
+    }
+
+    ShmServerTransporter::~ShmServerTransporter()
+    {
+        // stop reader thread first
+        // NOTE: no listener calls, owner may be going away
+        m_channel.close();
+
+        if (m_transporter)
+        {
+            // remove transporter from rcp_Server
+            if (m_rcpServer)
+            {
+                rcp_server_remove_transporter(m_rcpServer, m_transporter);
+            }
+
+            RCP_FREE(m_transporter);
+            m_transporter = nullptr;
+        }
+    }
+
+    bool ShmServerTransporter::detach()
+    {
+        // no more calls into rcp_server or the listener after this
+        m_channel.detachHandlers();
+
+        if (m_transporter &&
+                m_rcpServer)
+        {
+            rcp_server_remove_transporter(m_rcpServer, m_transporter);
+        }
+
+        m_rcpServer = nullptr;
+        m_listener = nullptr;
+
+        return true;
+    }
+
+    bool ShmServerTransporter::open(const std::string& name)
+    {
+        return m_channel.open(name);
+    }
+
+    void ShmServerTransporter::close()
+    {
+        bool was_connected = m_channel.peerConnected();
+
+        m_channel.close();
+
+        if (was_connected &&
+                m_listener)
+        {
+            m_listener->disconnected(&m_client);
+        }
+    }
+
+    // IServerTransporter
+    rcp_server_transporter* ShmServerTransporter::transporter() const
+    {
+        return m_transporter;
+    }
+
+    void ShmServerTransporter::sendToOne(char* data, size_t size, void* id)
+    {
+        if (id == &m_client)
+        {
+            m_channel.send(data, size);
+        }
+    }
+
+    void ShmServerTransporter::sendToAll(char* data, size_t size, void* excludeId)
+    {
+        if (excludeId != &m_client)
+        {
+            m_channel.send(data, size);
+        }
+    }
+
+    // ShmChannel - called on the reader thread
+    void ShmServerTransporter::_received(const char* data, size_t size)
+    {
+        if (m_transporter &&
+                m_transporter->received)
+        {
+            m_transporter->received(m_transporter->server,
+                                    const_cast<char*>(data),
+                                    size,
+                                    &m_client);
+        }
+    }
+
+    void ShmServerTransporter::_peerState(bool connected)
+    {
+        if (m_listener)
+        {
+            if (connected)
+            {
+                m_listener->connected(&m_client);
+            }
+            else
+            {
+                m_listener->disconnected(&m_client);
+            }
+        }
+    }
+
+} // namespace rcp
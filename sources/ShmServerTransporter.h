@@ -0,0 +1,90 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef SHMSERVERTRANSPORTER_H
+#define SHMSERVERTRANSPORTER_H
+
+#include <string>
+
+#include <rcp_server_transporter.h>
+
+#include "IServerTransporter.h"
+#include "ShmChannel.h"
+#include "websocketServer.h"
+
+namespace rcp
+{
+
+    // server transporter for a local client via shared memory
+    class ShmServerTransporter : public IServerTransporter
+    {
+    public:
+        ShmServerTransporter(rcp_server* server, IWebsocketServerListener* listener);
+        ~ShmServerTransporter();
+
+        bool open(const std::string& name);
+        void close();
+        std::string name() const { return m_channel.name(); }
+        bool peerConnected() const { return m_channel.peerConnected(); }
+
+        void sendToOne(char* data, size_t size, void* id);
+        void sendToAll(char* data, size_t size, void* excludeId);
+
+    public:
+        // IServerTransporter
+        rcp_server_transporter* transporter() const override;
+        void bind(uint16_t /*port*/) override {}
+        void unbind() override { close(); }
+        uint16_t port() const override { return 0; }
+        bool isListening() const override { return m_channel.isOpen(); }
+        bool detach() override;
+
+    private:
+        void _received(const char* data, size_t size);
+        void _peerState(bool connected);
+
+    private:
+        rcp_server* m_rcpServer{nullptr};
+        rcp_server_transporter* m_transporter{nullptr};
+        IWebsocketServerListener* m_listener{nullptr};
+        ShmChannel m_channel;
+        // id of the one client
+        char m_client{0};
+    };
+}
+
+#endif // SHMSERVERTRANSPORTER_H
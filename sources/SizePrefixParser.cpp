@@ -0,0 +1,191 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "SizePrefixParser.h"
+
+#include <stdexcept>
+
+namespace rcp
+{
+
+    SizePrefixParser::SizePrefixParser(int argc, t_atom *argv)
+    {
+        // [sizeprefix.parse] - max frame size 65536
+        // [sizeprefix.parse int] - max frame size in bytes
+
+        AddInAnything();
+
+        AddOutList();
+
+        FLEXT_ADDMETHOD(0, m_float);
+        FLEXT_ADDMETHOD(0, m_list);
+
+        for (int i=0; i<argc; i++)
+        {
+            if (CanbeInt(argv[i]))
+            {
+                int max = GetAInt(argv[i], 0);
+                if (max <= 0)
+                {
+                    throw std::invalid_argument("please provide a valid max frame size");
+                }
+
+                m_maxFrame = (size_t)max;
+                break;
+            }
+        }
+    }
+
+    void SizePrefixParser::m_float(float f)
+    {
+        append((int)f);
+        parse();
+    }
+
+    void SizePrefixParser::m_list(int argc, t_atom *argv)
+    {
+        // append whole list, then output all complete frames
+        m_buffer.reserve(m_buffer.size() + argc);
+
+        for (int i=0; i<argc; i++)
+        {
+            if (CanbeInt(argv[i]))
+            {
+                append(GetAInt(argv[i], -1));
+            }
+        }
+
+        parse();
+    }
+
+    void SizePrefixParser::m_clear()
+    {
+        m_buffer.clear();
+
+        if (m_parsing)
+        {
+            m_cleared = true;
+        }
+    }
+
+    void SizePrefixParser::setMax(const int& max)
+    {
+        if (max <= 0)
+        {
+            error("sizeprefix.parse: invalid max frame size: %d", max);
+            return;
+        }
+
+        m_maxFrame = (size_t)max;
+    }
+
+    void SizePrefixParser::getMax(int& max)
+    {
+        max = (int)m_maxFrame;
+    }
+
+    void SizePrefixParser::append(int byte)
+    {
+        if (byte >= 0 &&
+                byte < 256)
+        {
+            m_buffer.push_back((unsigned char)byte);
+        }
+    }
+
+    void SizePrefixParser::parse()
+    {
+        if (m_parsing)
+        {
+            // data appended from within output - outer parse picks it up
+            return;
+        }
+
+        m_parsing = true;
+        size_t offset = 0;
+
+        while (m_buffer.size() - offset >= 4)
+        {
+            const unsigned char* p = m_buffer.data() + offset;
+            size_t size = ((size_t)p[0] << 24) |
+                    ((size_t)p[1] << 16) |
+                    ((size_t)p[2] << 8) |
+                    (size_t)p[3];
+
+            if (size > m_maxFrame)
+            {
+                // stream is out of sync - drop everything
+                error("sizeprefix.parse: frame size %d exceeds max %d - clearing buffer", (int)size, (int)m_maxFrame);
+                m_buffer.clear();
+                offset = 0;
+                break;
+            }
+
+            if (m_buffer.size() - offset - 4 < size)
+            {
+                // wait for more data
+                break;
+            }
+
+            m_atoms.resize(size);
+            for (size_t i=0; i<size; i++)
+            {
+                SetInt(m_atoms[i], p[4 + i]);
+            }
+
+            offset += 4 + size;
+
+            ToOutList(0, (int)size, m_atoms.data());
+
+            if (m_cleared)
+            {
+                // cleared from within output
+                m_cleared = false;
+                offset = 0;
+            }
+        }
+
+        if (offset > 0)
+        {
+            m_buffer.erase(m_buffer.begin(), m_buffer.begin() + offset);
+        }
+
+        m_parsing = false;
+    }
+
+    FLEXT_LIB_V("sizeprefix.parse", SizePrefixParser)
+}
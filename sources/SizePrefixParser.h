@@ -0,0 +1,100 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef SIZEPREFIXPARSER_H
+#define SIZEPREFIXPARSER_H
+
+#include <vector>
+
+#include <flext.h>
+
+// default max frame size in bytes
+#ifndef RCP_SIZEPREFIX_MAX_FRAME
+#define RCP_SIZEPREFIX_MAX_FRAME 65536
+#endif
+
+namespace rcp
+{
+
+    // reassembles frames with a 4 byte size prefix (big endian)
+    // from a byte stream arriving in arbitrary chunks
+    class SizePrefixParser : public flext_base
+    {
+        FLEXT_HEADER_S(SizePrefixParser, flext_base, setup)
+
+    public:
+        SizePrefixParser(int argc, t_atom *argv);
+
+    protected:
+        static void setup(t_classid c)
+        {
+            FLEXT_CADDMETHOD_(c, 0, "clear", m_clear);
+            FLEXT_CADDATTR_VAR(c, "max", getMax, setMax);
+        }
+
+        void m_float(float f);
+        void m_list(int argc, t_atom *argv);
+        void m_clear();
+
+        void setMax(const int& max);
+        void getMax(int& max);
+
+    private:
+        void append(int byte);
+        void parse();
+
+    private:
+        FLEXT_CALLBACK_F(m_float)
+        FLEXT_CALLBACK_V(m_list)
+        FLEXT_CALLBACK(m_clear)
+        FLEXT_CALLSET_I(setMax)
+        FLEXT_CALLGET_I(getMax)
+
+    private:
+        // received bytes not yet output
+        std::vector<unsigned char> m_buffer;
+        // output atoms - reused
+        std::vector<t_atom> m_atoms;
+        size_t m_maxFrame{RCP_SIZEPREFIX_MAX_FRAME};
+        // output may feed back into this object
+        bool m_parsing{false};
+        bool m_cleared{false};
+    };
+
+}
+
+#endif // SIZEPREFIXPARSER_H
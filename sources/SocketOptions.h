@@ -0,0 +1,98 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef SOCKETOPTIONS_H
+#define SOCKETOPTIONS_H
+
+// NOTE: needed to figure out ASIO_STANDALONE before including websocketpp
+#include <asio.hpp>
+
+namespace rcp
+{
+
+    /* tcp options applied to websocket sockets when they are set up
+     * (websocketpp socket_init handler): accepted or connected from then on.
+     */
+    struct SocketOptions
+    {
+        // rcp packets are small - do not wait for more data
+        bool noDelay{true};
+        // SO_SNDBUF / SO_RCVBUF in bytes - 0: system default
+        int sendBuffer{0};
+        int receiveBuffer{0};
+        // IP TOS byte (DSCP << 2) - 0: system default
+        int tos{0};
+
+        template <typename Socket>
+        void apply(Socket& socket) const
+        {
+            asio::error_code ec;
+
+            socket.set_option(asio::ip::tcp::no_delay(noDelay), ec);
+
+            if (sendBuffer > 0)
+            {
+                socket.set_option(asio::socket_base::send_buffer_size(sendBuffer), ec);
+            }
+
+            if (receiveBuffer > 0)
+            {
+                socket.set_option(asio::socket_base::receive_buffer_size(receiveBuffer), ec);
+            }
+
+            if (tos > 0)
+            {
+                int value = tos;
+
+                asio::ip::tcp::endpoint local = socket.local_endpoint(ec);
+                if (!ec &&
+                        local.address().is_v6())
+                {
+#ifdef IPV6_TCLASS
+                    ::setsockopt(socket.native_handle(), IPPROTO_IPV6, IPV6_TCLASS, (const char*)&value, sizeof(value));
+#endif
+                }
+
+                // also covers v4 mapped addresses on dual stack sockets
+                ::setsockopt(socket.native_handle(), IPPROTO_IP, IP_TOS, (const char*)&value, sizeof(value));
+            }
+        }
+    };
+
+}
+
+#endif // SOCKETOPTIONS_H
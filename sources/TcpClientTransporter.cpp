@@ -0,0 +1,300 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "TcpClientTransporter.h"
+
+#include <flext.h>
+
+#include <rcp_memory.h>
+
+#include "Poller.h"
+
+// callbacks
+static void _pd_tcp_client_transporter_send(rcp_client_transporter* transporter, char* data, size_t size)
+{
+    if (transporter &&
+            transporter->user)
+    {
+        ((rcp::TcpClientTransporter*)transporter->user)->send(data, size);
+    }
+}
+
+namespace rcp
+{
+    TcpClientTransporter::TcpClientTransporter(IWebsocketClientListener* listener, bool polled)
+        : m_transporter(nullptr)
+        , m_listener(listener)
+        , m_polled(polled)
+        , m_resolver(m_io)
+    {
+        m_transporter = (rcp_client_transporter*)RCP_CALLOC(1, sizeof(rcp_client_transporter));
+
+        if (m_transporter)
+        {
+            rcp_client_transporter_setup(m_transporter,
+                                         _pd_tcp_client_transporter_send);
+
+            m_transporter->user = this;
+        }
+    }
+
+    TcpClientTransporter::~TcpClientTransporter()
+    {
+        // NOTE: no listener calls, owner may be going away
+        _stop();
+
+        if (m_transporter)
+        {
+            RCP_FREE(m_transporter);
+            m_transporter = nullptr;
+        }
+    }
+
+    void TcpClientTransporter::send(char* data, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(m_connectionLock);
+
+        if (m_connection &&
+                m_connected)
+        {
+            m_connection->send(data, size);
+        }
+    }
+
+    // IClientTransporter
+    rcp_client_transporter* TcpClientTransporter::transporter() const
+    {
+        return m_transporter;
+    }
+
+    void TcpClientTransporter::open(const std::string& address)
+    {
+        close();
+
+        std::string host = address;
+        if (host.compare(0, 6, "tcp://") == 0)
+        {
+            host = host.substr(6);
+        }
+
+        // strip any path
+        size_t slash = host.find('/');
+        if (slash != std::string::npos)
+        {
+            host = host.substr(0, slash);
+        }
+
+        size_t colon = host.rfind(':');
+        if (colon == std::string::npos ||
+                colon == 0 ||
+                colon == host.size() - 1)
+        {
+            error("rcp.client: tcp address needs host:port - %s", address.c_str());
+            return;
+        }
+
+        std::string port = host.substr(colon + 1);
+        host = host.substr(0, colon);
+
+        // [::1]:10000
+        if (host.size() > 2 &&
+                host.front() == '[' &&
+                host.back() == ']')
+        {
+            host = host.substr(1, host.size() - 2);
+        }
+
+        m_io.reset();
+        m_work.reset(new asio::io_service::work(m_io));
+
+        std::shared_ptr<TcpConnection> connection = std::make_shared<TcpConnection>(m_io);
+        {
+            std::lock_guard<std::mutex> lock(m_connectionLock);
+            m_connection = connection;
+        }
+
+        asio::ip::tcp::resolver::query query(host, port);
+        m_resolver.async_resolve(query, [this, connection](const asio::error_code& ec, asio::ip::tcp::resolver::iterator it) {
+
+            if (ec)
+            {
+                handleConnect(connection, ec);
+                return;
+            }
+
+            asio::async_connect(connection->socket(),
+                                it,
+                                [this, connection](const asio::error_code& ec, asio::ip::tcp::resolver::iterator) {
+                handleConnect(connection, ec);
+            });
+        });
+
+        if (m_polled)
+        {
+            Poller::add(this);
+        }
+        else
+        {
+            m_thread = std::thread([this]() {
+                m_io.run();
+            });
+        }
+    }
+
+    void TcpClientTransporter::close()
+    {
+        bool was_connected = m_connected;
+
+        _stop();
+
+        if (was_connected)
+        {
+            if (m_transporter)
+            {
+                // NOTE: this re-creates the client manager
+                rcp_client_transporter_call_disconnected_cb(m_transporter);
+            }
+
+            if (m_listener)
+            {
+                m_listener->disconnected(0);
+            }
+        }
+    }
+
+    // IPollable
+    void TcpClientTransporter::poll()
+    {
+        m_io.poll();
+    }
+
+    void TcpClientTransporter::_stop()
+    {
+        if (m_polled)
+        {
+            Poller::remove(this);
+        }
+
+        m_work.reset();
+        m_io.stop();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+
+        // io is stopped - safe to close from here
+        m_resolver.cancel();
+
+        std::lock_guard<std::mutex> lock(m_connectionLock);
+        if (m_connection)
+        {
+            m_connection->abort();
+            m_connection.reset();
+        }
+        m_connected = false;
+    }
+
+    // io thread
+    void TcpClientTransporter::handleConnect(std::shared_ptr<TcpConnection> connection, const asio::error_code& ec)
+    {
+        if (connection != m_connection)
+        {
+            // old attempt
+            return;
+        }
+
+        if (ec)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_connectionLock);
+                m_connection.reset();
+            }
+
+            if (m_listener)
+            {
+                m_listener->failed(0);
+            }
+            return;
+        }
+
+        connection->start(std::bind(&TcpClientTransporter::connectionReceived, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3),
+                          std::bind(&TcpClientTransporter::connectionClosed, this, std::placeholders::_1));
+
+        m_connected = true;
+
+        if (m_transporter)
+        {
+            rcp_client_transporter_call_connected_cb(m_transporter);
+        }
+
+        if (m_listener)
+        {
+            m_listener->connected();
+        }
+    }
+
+    void TcpClientTransporter::connectionReceived(TcpConnection* /*connection*/, const char* data, size_t size)
+    {
+        if (m_transporter)
+        {
+            rcp_client_transporter_call_recv_cb(m_transporter, const_cast<char*>(data), size);
+        }
+    }
+
+    void TcpClientTransporter::connectionClosed(TcpConnection* /*connection*/)
+    {
+        m_connected = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_connectionLock);
+            m_connection.reset();
+        }
+
+        if (m_transporter)
+        {
+            // NOTE: this re-creates the client manager
+            rcp_client_transporter_call_disconnected_cb(m_transporter);
+        }
+
+        if (m_listener)
+        {
+            m_listener->disconnected(0);
+        }
+    }
+
+} // namespace rcp
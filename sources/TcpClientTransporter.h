@@ -0,0 +1,101 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef TCPCLIENTTRANSPORTER_H
+#define TCPCLIENTTRANSPORTER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <asio.hpp>
+
+#include <rcp_client_transporter.h>
+
+#include "IClientTransporter.h"
+#include "IPollable.h"
+#include "TcpConnection.h"
+#include "websocketClient.h"
+
+namespace rcp
+{
+
+    // client transporter for plain tcp with size prefixed frames
+    // address: host:port (optional tcp:// prefix)
+    class TcpClientTransporter
+            : public IClientTransporter
+            , public IPollable
+    {
+    public:
+        TcpClientTransporter(IWebsocketClientListener* listener, bool polled = false);
+        ~TcpClientTransporter();
+
+        void send(char* data, size_t size);
+
+        // IClientTransporter
+        rcp_client_transporter* transporter() const override;
+        void open(const std::string& address) override;
+        void close() override;
+
+        // IPollable
+        void poll() override;
+
+    private:
+        void _stop();
+        void handleConnect(std::shared_ptr<TcpConnection> connection, const asio::error_code& ec);
+        void connectionReceived(TcpConnection* connection, const char* data, size_t size);
+        void connectionClosed(TcpConnection* connection);
+
+    private:
+        rcp_client_transporter* m_transporter{nullptr};
+        IWebsocketClientListener* m_listener{nullptr};
+        bool m_polled{false};
+
+        asio::io_service m_io;
+        std::unique_ptr<asio::io_service::work> m_work;
+        asio::ip::tcp::resolver m_resolver;
+        std::thread m_thread;
+
+        std::shared_ptr<TcpConnection> m_connection;
+        std::mutex m_connectionLock;
+        std::atomic<bool> m_connected{false};
+    };
+}
+
+#endif // TCPCLIENTTRANSPORTER_H
@@ -0,0 +1,276 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "TcpConnection.h"
+
+#include <cstring>
+
+namespace rcp
+{
+
+    TcpConnection::TcpConnection(asio::io_service& io)
+        : m_io(io)
+        , m_socket(io)
+        , m_buffer(RCP_TCP_READ_SIZE)
+    {
+    }
+
+    TcpConnection::~TcpConnection()
+    {
+        asio::error_code ec;
+        m_socket.close(ec);
+    }
+
+    void TcpConnection::start(receive_handler onReceive, close_handler onClose)
+    {
+        m_onReceive = onReceive;
+        m_onClose = onClose;
+
+        // rcp packets are small - do not wait for more data
+        asio::error_code ec;
+        m_socket.set_option(asio::ip::tcp::no_delay(true), ec);
+
+        startRead();
+    }
+
+    void TcpConnection::send(const char* data, size_t size)
+    {
+        // a slow peer would let the queue grow without bound.
+        // dropping frames would leave it with a wrong state - close it instead,
+        // it gets everything again when it reconnects.
+        if (m_pending.fetch_add(size + 4) + size + 4 > RCP_TCP_MAX_QUEUE)
+        {
+            m_pending.fetch_sub(size + 4);
+
+            if (!m_overflow.exchange(true))
+            {
+                close();
+            }
+            return;
+        }
+
+        std::shared_ptr<std::string> frame = std::make_shared<std::string>(size + 4, '\0');
+        (*frame)[0] = (char)((size >> 24) & 0xff);
+        (*frame)[1] = (char)((size >> 16) & 0xff);
+        (*frame)[2] = (char)((size >> 8) & 0xff);
+        (*frame)[3] = (char)(size & 0xff);
+        frame->replace(4, size, data, size);
+
+        std::shared_ptr<TcpConnection> self = shared_from_this();
+        m_io.post([self, frame]() {
+
+            if (self->m_closed)
+            {
+                return;
+            }
+
+            self->m_queue.push_back(frame);
+
+            if (self->m_writing.empty())
+            {
+                self->startWrite();
+            }
+        });
+    }
+
+    void TcpConnection::close()
+    {
+        std::shared_ptr<TcpConnection> self = shared_from_this();
+        m_io.post([self]() {
+            self->_close();
+        });
+    }
+
+    void TcpConnection::abort()
+    {
+        m_onReceive = nullptr;
+        m_onClose = nullptr;
+        m_closed = true;
+
+        asio::error_code ec;
+        m_socket.close(ec);
+    }
+
+    void TcpConnection::startRead()
+    {
+        if (m_buffer.size() - m_used < RCP_TCP_READ_SIZE)
+        {
+            m_buffer.resize(m_used + RCP_TCP_READ_SIZE);
+        }
+
+        m_socket.async_read_some(asio::buffer(m_buffer.data() + m_used, m_buffer.size() - m_used),
+                                 std::bind(&TcpConnection::handleRead, shared_from_this(), std::placeholders::_1, std::placeholders::_2));
+    }
+
+    void TcpConnection::handleRead(const asio::error_code& ec, size_t size)
+    {
+        if (m_closed)
+        {
+            return;
+        }
+
+        if (ec)
+        {
+            _close();
+            return;
+        }
+
+        m_used += size;
+
+        // hand out all complete frames
+        size_t offset = 0;
+        while (m_used - offset >= 4)
+        {
+            const uint8_t* p = (const uint8_t*)m_buffer.data() + offset;
+            uint32_t frame_size = ((uint32_t)p[0] << 24) |
+                    ((uint32_t)p[1] << 16) |
+                    ((uint32_t)p[2] << 8) |
+                    (uint32_t)p[3];
+
+            if (frame_size > RCP_TCP_MAX_FRAME)
+            {
+                _close();
+                return;
+            }
+
+            if (m_used - offset - 4 < frame_size)
+            {
+                // incomplete - make room for the rest
+                if (m_buffer.size() < frame_size + 4)
+                {
+                    m_buffer.resize(frame_size + 4 + RCP_TCP_READ_SIZE);
+                }
+                break;
+            }
+
+            if (m_onReceive &&
+                    frame_size > 0)
+            {
+                m_onReceive(this, m_buffer.data() + offset + 4, frame_size);
+            }
+
+            if (m_closed)
+            {
+                // closed in handler
+                return;
+            }
+
+            offset += 4 + frame_size;
+        }
+
+        // keep the incomplete rest at the front
+        if (offset > 0)
+        {
+            m_used -= offset;
+            if (m_used > 0)
+            {
+                memmove(m_buffer.data(), m_buffer.data() + offset, m_used);
+            }
+        }
+
+        startRead();
+    }
+
+    void TcpConnection::startWrite()
+    {
+        // gather everything queued into one write
+        std::vector<asio::const_buffer> buffers;
+        buffers.reserve(m_queue.size());
+
+        while (!m_queue.empty())
+        {
+            buffers.push_back(asio::buffer(*m_queue.front()));
+            m_writing.push_back(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        asio::async_write(m_socket,
+                          buffers,
+                          std::bind(&TcpConnection::handleWrite, shared_from_this(), std::placeholders::_1));
+    }
+
+    void TcpConnection::handleWrite(const asio::error_code& ec)
+    {
+        size_t written = 0;
+        for (auto& frame : m_writing)
+        {
+            written += frame->size();
+        }
+        m_pending.fetch_sub(written);
+        m_writing.clear();
+
+        if (m_closed)
+        {
+            return;
+        }
+
+        if (ec)
+        {
+            _close();
+            return;
+        }
+
+        if (!m_queue.empty())
+        {
+            startWrite();
+        }
+    }
+
+    void TcpConnection::_close()
+    {
+        if (m_closed)
+        {
+            return;
+        }
+
+        m_closed = true;
+        m_queue.clear();
+
+        asio::error_code ec;
+        m_socket.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+        m_socket.close(ec);
+
+        if (m_onClose)
+        {
+            m_onClose(this);
+        }
+
+        m_onReceive = nullptr;
+        m_onClose = nullptr;
+    }
+
+}
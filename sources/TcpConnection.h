@@ -0,0 +1,126 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef TCPCONNECTION_H
+#define TCPCONNECTION_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <asio.hpp>
+
+// frames bigger than this close the connection
+#ifndef RCP_TCP_MAX_FRAME
+#define RCP_TCP_MAX_FRAME (16 * 1024 * 1024)
+#endif
+
+// minimum free space for one read
+#ifndef RCP_TCP_READ_SIZE
+#define RCP_TCP_READ_SIZE 8192
+#endif
+
+// bytes waiting to be written - a peer that does not read gets closed
+#ifndef RCP_TCP_MAX_QUEUE
+#define RCP_TCP_MAX_QUEUE (16 * 1024 * 1024)
+#endif
+
+namespace rcp
+{
+
+    /* tcp stream carrying frames with a 4 byte size prefix (big endian)
+     * same framing as [sizeprefix].
+     * partial reads are reassembled in one growing buffer, complete
+     * frames are handed to the receive handler without a copy.
+     * all socket operations run on the io_service.
+     */
+    class TcpConnection : public std::enable_shared_from_this<TcpConnection>
+    {
+    public:
+        typedef std::function<void(TcpConnection*, const char*, size_t)> receive_handler;
+        typedef std::function<void(TcpConnection*)> close_handler;
+
+        TcpConnection(asio::io_service& io);
+        ~TcpConnection();
+
+        asio::ip::tcp::socket& socket() { return m_socket; }
+
+        // start reading - call on the io thread
+        void start(receive_handler onReceive, close_handler onClose);
+
+        // thread safe - writing happens on the io thread
+        // closes the connection if more than RCP_TCP_MAX_QUEUE bytes are pending
+        void send(const char* data, size_t size);
+        // thread safe - calls close handler
+        void close();
+        // close without calling any handler - only call if io is not running
+        void abort();
+
+    private:
+        void startRead();
+        void handleRead(const asio::error_code& ec, size_t size);
+        void startWrite();
+        void handleWrite(const asio::error_code& ec);
+        void _close();
+
+    private:
+        asio::io_service& m_io;
+        asio::ip::tcp::socket m_socket;
+
+        // reassembly buffer
+        std::vector<char> m_buffer;
+        size_t m_used{0};
+
+        // write queue - frames including prefix
+        std::deque<std::shared_ptr<std::string>> m_queue;
+        std::vector<std::shared_ptr<std::string>> m_writing;
+        // bytes posted but not yet written
+        std::atomic<size_t> m_pending{0};
+        std::atomic<bool> m_overflow{false};
+
+        receive_handler m_onReceive;
+        close_handler m_onClose;
+        bool m_closed{false};
+    };
+
+}
+
+#endif // TCPCONNECTION_H
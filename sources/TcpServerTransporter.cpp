@@ -0,0 +1,302 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "TcpServerTransporter.h"
+
+#include <flext.h>
+
+#include <rcp_memory.h>
+
+#include "Poller.h"
+
+//
+void _pd_tcp_server_transporter_sendToOne(rcp_server_transporter* transporter, char* data, size_t data_size, void* id)
+{
+    if (transporter &&
+            transporter->user)
+    {
+        ((rcp::TcpServerTransporter*)transporter->user)->sendToOne(data, data_size, id);
+    }
+}
+
+void _pd_tcp_server_transporter_sendToAll(rcp_server_transporter* transporter, char* data, size_t data_size, void* excludeId)
+{
+    if (transporter &&
+            transporter->user)
+    {
+        ((rcp::TcpServerTransporter*)transporter->user)->sendToAll(data, data_size, excludeId);
+    }
+}
+
+
+namespace rcp
+{
+    TcpServerTransporter::TcpServerTransporter(rcp_server* server, IWebsocketServerListener* listener, bool polled)
+        : m_rcpServer(server)
+        , m_transporter(nullptr)
+        , m_listener(listener)
+        , m_polled(polled)
+        , m_acceptor(m_io)
+    {
+        m_transporter = (rcp_server_transporter*)RCP_CALLOC(1, sizeof(rcp_server_transporter));
+
+        if (m_transporter)
+        {
+            rcp_server_transporter_setup(m_transporter,
+                                         _pd_tcp_server_transporter_sendToOne,
+                                         _pd_tcp_server_transporter_sendToAll);
+
+            rcp_server_add_transporter(m_rcpServer, m_transporter);
+
+            m_transporter->user = this;
+        }
+    }
+
+    TcpServerTransporter::~TcpServerTransporter()
+    {
+        unbind();
+
+        if (m_transporter)
+        {
+            // remove transporter from rcp_Server
+            rcp_server_remove_transporter(m_rcpServer, m_transporter);
+
+            RCP_FREE(m_transporter);
+            m_transporter = nullptr;
+        }
+    }
+
+    // IServerTransporter
+    rcp_server_transporter* TcpServerTransporter::transporter() const
+    {
+        return m_transporter;
+    }
+
+    void TcpServerTransporter::bind(uint16_t port)
+    {
+        unbind();
+
+        asio::error_code ec;
+        asio::ip::tcp protocol = asio::ip::tcp::v6();
+
+        // try dual stack first
+        m_acceptor.open(protocol, ec);
+        if (!ec)
+        {
+            m_acceptor.set_option(asio::ip::v6_only(false), ec);
+        }
+
+        if (ec)
+        {
+            m_acceptor.close(ec);
+
+            protocol = asio::ip::tcp::v4();
+            m_acceptor.open(protocol, ec);
+        }
+
+        if (!ec)
+        {
+            m_acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true), ec);
+            m_acceptor.bind(asio::ip::tcp::endpoint(protocol, port), ec);
+        }
+
+        if (!ec)
+        {
+            m_acceptor.listen(asio::socket_base::max_connections, ec);
+        }
+
+        if (ec)
+        {
+            error("tcpserver(%d): %s", port, ec.message().c_str());
+
+            asio::error_code ignore;
+            m_acceptor.close(ignore);
+            return;
+        }
+
+        m_port = port;
+
+        m_io.reset();
+        m_work.reset(new asio::io_service::work(m_io));
+
+        startAccept();
+
+        if (m_polled)
+        {
+            Poller::add(this);
+        }
+        else
+        {
+            m_thread = std::thread([this]() {
+                m_io.run();
+            });
+        }
+    }
+
+    void TcpServerTransporter::unbind()
+    {
+        if (m_polled)
+        {
+            Poller::remove(this);
+        }
+
+        m_work.reset();
+        m_io.stop();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+
+        // io is stopped - safe to close from here
+        asio::error_code ec;
+        m_acceptor.close(ec);
+
+        std::lock_guard<std::mutex> lock(m_connectionLock);
+        for (auto& it : m_connections)
+        {
+            it.second->abort();
+        }
+        m_connections.clear();
+
+        m_port = 0;
+    }
+
+    // IPollable
+    void TcpServerTransporter::poll()
+    {
+        m_io.poll();
+    }
+
+    void TcpServerTransporter::sendToOne(char* data, size_t size, void* id)
+    {
+        std::lock_guard<std::mutex> lock(m_connectionLock);
+
+        auto it = m_connections.find((TcpConnection*)id);
+        if (it != m_connections.end())
+        {
+            it->second->send(data, size);
+        }
+    }
+
+    void TcpServerTransporter::sendToAll(char* data, size_t size, void* excludeId)
+    {
+        std::lock_guard<std::mutex> lock(m_connectionLock);
+
+        for (auto& it : m_connections)
+        {
+            if (it.first != excludeId)
+            {
+                it.second->send(data, size);
+            }
+        }
+    }
+
+    // io thread
+    void TcpServerTransporter::startAccept()
+    {
+        std::shared_ptr<TcpConnection> connection = std::make_shared<TcpConnection>(m_io);
+
+        m_acceptor.async_accept(connection->socket(),
+                                std::bind(&TcpServerTransporter::handleAccept, this, connection, std::placeholders::_1));
+    }
+
+    void TcpServerTransporter::handleAccept(std::shared_ptr<TcpConnection> connection, const asio::error_code& ec)
+    {
+        // acceptor closed in unbind
+        if (ec == asio::error::operation_aborted ||
+                !m_acceptor.is_open())
+        {
+            return;
+        }
+
+        if (!ec)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_connectionLock);
+                m_connections[connection.get()] = connection;
+            }
+
+            connection->start(std::bind(&TcpServerTransporter::connectionReceived, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3),
+                              std::bind(&TcpServerTransporter::connectionClosed, this, std::placeholders::_1));
+
+            if (m_listener)
+            {
+                m_listener->connected(connection.get());
+            }
+        }
+
+        startAccept();
+    }
+
+    void TcpServerTransporter::connectionReceived(TcpConnection* connection, const char* data, size_t size)
+    {
+        if (m_transporter &&
+                m_transporter->received)
+        {
+            m_transporter->received(m_transporter->server,
+                                    const_cast<char*>(data),
+                                    size,
+                                    connection);
+        }
+    }
+
+    void TcpServerTransporter::connectionClosed(TcpConnection* connection)
+    {
+        // keep connection alive until we are done
+        std::shared_ptr<TcpConnection> keep;
+
+        {
+            std::lock_guard<std::mutex> lock(m_connectionLock);
+
+            auto it = m_connections.find(connection);
+            if (it == m_connections.end())
+            {
+                return;
+            }
+
+            keep = it->second;
+            m_connections.erase(it);
+        }
+
+        if (m_listener)
+        {
+            m_listener->disconnected(connection);
+        }
+    }
+
+} // namespace rcp
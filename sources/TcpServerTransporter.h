@@ -0,0 +1,105 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef TCPSERVERTRANSPORTER_H
+#define TCPSERVERTRANSPORTER_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <asio.hpp>
+
+#include <rcp_server_transporter.h>
+
+#include "IServerTransporter.h"
+#include "IPollable.h"
+#include "TcpConnection.h"
+#include "websocketServer.h"
+
+namespace rcp
+{
+
+    // server transporter for plain tcp with size prefixed frames
+    class TcpServerTransporter
+            : public IServerTransporter
+            , public IPollable
+    {
+    public:
+        TcpServerTransporter(rcp_server* server, IWebsocketServerListener* listener, bool polled = false);
+        ~TcpServerTransporter();
+
+        void sendToOne(char* data, size_t size, void* id);
+        void sendToAll(char* data, size_t size, void* excludeId);
+
+    public:
+        // IServerTransporter
+        rcp_server_transporter* transporter() const override;
+        void bind(uint16_t port) override;
+        void unbind() override;
+        uint16_t port() const override { return m_port; }
+        bool isListening() const override { return m_acceptor.is_open(); }
+
+        // IPollable
+        void poll() override;
+
+    private:
+        void startAccept();
+        void handleAccept(std::shared_ptr<TcpConnection> connection, const asio::error_code& ec);
+        void connectionReceived(TcpConnection* connection, const char* data, size_t size);
+        void connectionClosed(TcpConnection* connection);
+
+    private:
+        rcp_server* m_rcpServer{nullptr};
+        rcp_server_transporter* m_transporter{nullptr};
+        IWebsocketServerListener* m_listener{nullptr};
+        bool m_polled{false};
+
+        asio::io_service m_io;
+        std::unique_ptr<asio::io_service::work> m_work;
+        asio::ip::tcp::acceptor m_acceptor;
+        std::thread m_thread;
+        uint16_t m_port{0};
+
+        // connection pointer is the client id
+        std::map<TcpConnection*, std::shared_ptr<TcpConnection>> m_connections;
+        std::mutex m_connectionLock;
+    };
+}
+
+#endif // TCPSERVERTRANSPORTER_H
@@ -0,0 +1,233 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "UdpChannel.h"
+
+#include <cstdlib>
+#include <iostream>
+
+#include <rcp.h>
+
+namespace rcp
+{
+
+    UdpChannel::UdpChannel(asio::io_service& io)
+        : m_io(io)
+        , m_strand(io)
+        , m_socket(io)
+    {
+    }
+
+    UdpChannel::~UdpChannel()
+    {
+        // last reference - nothing runs on the strand anymore
+        asio::error_code ec;
+        m_socket.close(ec);
+    }
+
+    bool UdpChannel::open(uint16_t port)
+    {
+        if (m_socket.is_open())
+        {
+            return false;
+        }
+
+        asio::error_code ec;
+        m_socket.open(asio::ip::udp::v4(), ec);
+        if (!ec)
+        {
+            m_socket.bind(asio::ip::udp::endpoint(asio::ip::udp::v4(), port), ec);
+        }
+
+        if (ec)
+        {
+            std::cout << "udp: could not open port " << port << ": " << ec.message() << std::endl;
+            m_socket.close(ec);
+            return false;
+        }
+
+        startReceive();
+        return true;
+    }
+
+    void UdpChannel::close()
+    {
+        // a receive may be running on an io thread
+        std::shared_ptr<UdpChannel> self = shared_from_this();
+        m_strand.post([self]() {
+            if (self->m_socket.is_open())
+            {
+                asio::error_code ec;
+                self->m_socket.close(ec);
+            }
+        });
+    }
+
+    uint16_t UdpChannel::localPort() const
+    {
+        asio::error_code ec;
+        asio::ip::udp::endpoint ep = m_socket.local_endpoint(ec);
+        return ec ? 0 : ep.port();
+    }
+
+    void UdpChannel::send(const asio::ip::udp::endpoint& to, const char* data, size_t size)
+    {
+        if (size > RCP_UDP_MAX_PAYLOAD)
+        {
+            return;
+        }
+
+        uint32_t seq = ++m_sequence;
+
+        std::shared_ptr<std::string> datagram = std::make_shared<std::string>(size + 4, '\0');
+        (*datagram)[0] = (char)((seq >> 24) & 0xff);
+        (*datagram)[1] = (char)((seq >> 16) & 0xff);
+        (*datagram)[2] = (char)((seq >> 8) & 0xff);
+        (*datagram)[3] = (char)(seq & 0xff);
+        datagram->replace(4, size, data, size);
+
+        m_strand.post(std::bind(&UdpChannel::_send, shared_from_this(), to, datagram));
+    }
+
+    void UdpChannel::_send(asio::ip::udp::endpoint to, std::shared_ptr<std::string> datagram)
+    {
+        if (!m_socket.is_open())
+        {
+            return;
+        }
+
+        // datagrams are small - send synchronously on the io thread
+        asio::error_code ec;
+        m_socket.send_to(asio::buffer(*datagram), to, 0, ec);
+    }
+
+    void UdpChannel::forget(const asio::ip::udp::endpoint& from)
+    {
+        std::shared_ptr<UdpChannel> self = shared_from_this();
+        m_strand.post([self, from]() {
+            auto it = self->m_lastSequence.lower_bound(sender_id(from, INT16_MIN));
+            while (it != self->m_lastSequence.end() &&
+                   it->first.first == from)
+            {
+                it = self->m_lastSequence.erase(it);
+            }
+        });
+    }
+
+    void UdpChannel::startReceive()
+    {
+        m_socket.async_receive_from(asio::buffer(m_buffer, sizeof(m_buffer)),
+                                    m_remote,
+                                    m_strand.wrap(std::bind(&UdpChannel::handleReceive, shared_from_this(), std::placeholders::_1, std::placeholders::_2)));
+    }
+
+    void UdpChannel::handleReceive(const asio::error_code& ec, size_t size)
+    {
+        if (ec == asio::error::operation_aborted ||
+                !m_socket.is_open())
+        {
+            // closed
+            return;
+        }
+
+        if (!ec &&
+                size > 4 &&
+                isUpdateValue(m_buffer + 4, size - 4))
+        {
+            uint32_t seq = ((uint32_t)(uint8_t)m_buffer[0] << 24) |
+                    ((uint32_t)(uint8_t)m_buffer[1] << 16) |
+                    ((uint32_t)(uint8_t)m_buffer[2] << 8) |
+                    (uint32_t)(uint8_t)m_buffer[3];
+
+            int16_t id = (int16_t)(((uint8_t)m_buffer[5] << 8) | (uint8_t)m_buffer[6]);
+
+            bool accept = true;
+
+            auto it = m_lastSequence.find(sender_id(m_remote, id));
+            if (it != m_lastSequence.end())
+            {
+                // wrap-around safe: drop anything not newer
+                accept = (int32_t)(seq - it->second) > 0;
+            }
+
+            if (accept)
+            {
+                m_lastSequence[sender_id(m_remote, id)] = seq;
+
+                if (m_handler)
+                {
+                    m_handler(m_remote, m_buffer + 4, size - 4);
+                }
+            }
+        }
+
+        startReceive();
+    }
+
+    bool UdpChannel::isUpdateValue(const char* data, size_t size)
+    {
+        // [command][id][id][type][value...]
+        return size > 3 &&
+                size <= RCP_UDP_MAX_PAYLOAD &&
+                data[0] == COMMAND_UPDATEVALUE;
+    }
+
+    std::string UdpChannel::handshake(uint16_t port)
+    {
+        return std::string(RCP_UDP_HANDSHAKE) + std::to_string(port);
+    }
+
+    uint16_t UdpChannel::parseHandshake(const std::string& msg)
+    {
+        const size_t len = sizeof(RCP_UDP_HANDSHAKE) - 1;
+
+        if (msg.compare(0, len, RCP_UDP_HANDSHAKE) != 0)
+        {
+            return 0;
+        }
+
+        int port = std::atoi(msg.c_str() + len);
+        if (port <= 0 ||
+                port > (int)UINT16_MAX)
+        {
+            return 0;
+        }
+
+        return (uint16_t)port;
+    }
+
+}
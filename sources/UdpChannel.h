@@ -0,0 +1,124 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef UDPCHANNEL_H
+#define UDPCHANNEL_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+// NOTE: needed to figure out ASIO_STANDALONE before including websocketpp
+#include <asio.hpp>
+
+// max size of a value update sent as datagram
+#ifndef RCP_UDP_MAX_PAYLOAD
+#define RCP_UDP_MAX_PAYLOAD 1200
+#endif
+
+// text message used to exchange udp ports on the websocket
+#define RCP_UDP_HANDSHAKE "rcp-udp "
+
+namespace rcp
+{
+
+    /* udp side channel for value updates
+     * datagram: [uint32 sequence (big endian)][rcp packet]
+     * only UPDATEVALUE packets are sent as datagrams. the receiver
+     * drops datagrams older than the last one it saw for the same
+     * sender and parameter id (latest wins).
+     * all socket operations run on a strand of the given io_service.
+     * queued handlers keep the channel alive - create with make_shared.
+     * a closed channel is not re-opened, create a new one instead.
+     */
+    class UdpChannel : public std::enable_shared_from_this<UdpChannel>
+    {
+    public:
+        typedef std::function<void(const asio::ip::udp::endpoint&, const char*, size_t)> receive_handler;
+
+        UdpChannel(asio::io_service& io);
+        ~UdpChannel();
+
+        // port 0: any free port
+        // NOTE: set the receive handler before
+        bool open(uint16_t port);
+        // thread safe - closes on the strand
+        void close();
+        uint16_t localPort() const;
+
+        void setReceiveHandler(receive_handler handler) { m_handler = handler; }
+
+        // thread safe - sending happens on the io thread
+        void send(const asio::ip::udp::endpoint& to, const char* data, size_t size);
+        // forget latest-wins state of a sender
+        void forget(const asio::ip::udp::endpoint& from);
+
+        static bool isUpdateValue(const char* data, size_t size);
+        static std::string handshake(uint16_t port);
+        // returns 0 if msg is no handshake
+        static uint16_t parseHandshake(const std::string& msg);
+
+    private:
+        void startReceive();
+        void handleReceive(const asio::error_code& ec, size_t size);
+        void _send(asio::ip::udp::endpoint to, std::shared_ptr<std::string> datagram);
+
+    private:
+        typedef std::pair<asio::ip::udp::endpoint, int16_t> sender_id;
+
+        asio::io_service& m_io;
+        // the io_service may be run by several threads
+        asio::io_service::strand m_strand;
+        asio::ip::udp::socket m_socket;
+        asio::ip::udp::endpoint m_remote;
+        char m_buffer[RCP_UDP_MAX_PAYLOAD + 4];
+
+        std::atomic<uint32_t> m_sequence{0};
+        receive_handler m_handler;
+
+        // latest wins: last sequence per sender and parameter id
+        // NOTE: only accessed on the strand
+        std::map<sender_id, uint32_t> m_lastSequence;
+    };
+
+}
+
+#endif // UDPCHANNEL_H
@@ -0,0 +1,248 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#include "UpdateEncoder.h"
+
+#include <rcp.h>
+#include <rcp_endian.h>
+#include <rcp_parameter.h>
+
+namespace rcp
+{
+    union _int_float_union{
+        int32_t i;
+        float f;
+    };
+
+
+    UpdateEncoder::UpdateEncoder(Sink sink)
+        : m_sink(sink)
+    {
+        m_thread = std::thread(&UpdateEncoder::_run, this);
+    }
+
+    UpdateEncoder::~UpdateEncoder()
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_run = false;
+        }
+        m_cond.notify_one();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    void UpdateEncoder::snapshot(rcp_parameter* parameter)
+    {
+        if (parameter == nullptr)
+        {
+            return;
+        }
+
+        Change change;
+        change.id = rcp_parameter_get_id(parameter);
+        change.type = RCP_TYPE_ID(parameter);
+        change.i = 0;
+        change.f = 0;
+
+        switch (change.type)
+        {
+        case DATATYPE_BANG:
+            break;
+        case DATATYPE_FLOAT32:
+            change.f = rcp_parameter_get_value_float(RCP_VALUE_PARAMETER(parameter));
+            break;
+        case DATATYPE_INT32:
+            change.i = rcp_parameter_get_value_int32(RCP_VALUE_PARAMETER(parameter));
+            break;
+        case DATATYPE_BOOLEAN:
+            change.i = rcp_parameter_get_value_bool(RCP_VALUE_PARAMETER(parameter)) ? 1 : 0;
+            break;
+        case DATATYPE_STRING:
+        {
+            const char* value = rcp_parameter_get_value_string(RCP_VALUE_PARAMETER(parameter));
+            if (value)
+            {
+                change.s = value;
+            }
+            break;
+        }
+        default:
+            // no value update for this type
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+
+            auto it = m_index.find(change.id);
+            if (it != m_index.end() &&
+                    change.type != DATATYPE_BANG)
+            {
+                // not encoded yet - replace
+                m_front[it->second] = std::move(change);
+                return;
+            }
+
+            // every bang is an event of its own
+            m_index[change.id] = m_front.size();
+            m_front.push_back(std::move(change));
+        }
+        m_cond.notify_one();
+    }
+
+    void UpdateEncoder::flush()
+    {
+        _encode();
+    }
+
+    bool UpdateEncoder::alreadySent(const char* data, size_t size)
+    {
+        if (data == nullptr ||
+                size < 4 ||
+                (uint8_t)data[0] != COMMAND_UPDATEVALUE)
+        {
+            return false;
+        }
+
+        int16_t id = (int16_t)(((uint8_t)data[1] << 8) | (uint8_t)data[2]);
+
+        std::lock_guard<std::mutex> guard(m_sentLock);
+
+        auto it = m_sent.find(id);
+        if (it == m_sent.end())
+        {
+            return false;
+        }
+
+        bool sent = it->second.size() == size &&
+                it->second.compare(0, size, data, size) == 0;
+
+        m_sent.erase(it);
+        return sent;
+    }
+
+    void UpdateEncoder::_run()
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_lock);
+                m_cond.wait(lock, [this]() { return !m_run || !m_front.empty(); });
+
+                if (!m_run)
+                {
+                    break;
+                }
+            }
+
+            _encode();
+        }
+    }
+
+    void UpdateEncoder::_encode()
+    {
+        std::lock_guard<std::mutex> encode_guard(m_encodeLock);
+
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_back.swap(m_front);
+            m_index.clear();
+        }
+
+        for (const Change& change : m_back)
+        {
+            _write(change, m_packet);
+
+            if (change.type != DATATYPE_BANG)
+            {
+                // the value stays dirty in the tree
+                std::lock_guard<std::mutex> guard(m_sentLock);
+                m_sent[change.id] = m_packet;
+            }
+
+            m_sink(m_packet.data(), m_packet.size());
+        }
+
+        // keep the capacity for the next swap
+        m_back.clear();
+    }
+
+    void UpdateEncoder::_write(const Change& change, std::string& out)
+    {
+        // [command][id][id][type][value...]
+        unsigned char header[4];
+        header[0] = COMMAND_UPDATEVALUE;
+        _rcp_store16(header + 1, change.id);
+        header[3] = change.type;
+
+        out.assign((const char*)header, sizeof(header));
+
+        unsigned char v[4];
+
+        switch (change.type)
+        {
+        case DATATYPE_FLOAT32:
+        {
+            union _int_float_union uu;
+            uu.f = change.f;
+            _rcp_store32(v, (uint32_t)uu.i);
+            out.append((const char*)v, 4);
+            break;
+        }
+        case DATATYPE_INT32:
+            _rcp_store32(v, (uint32_t)change.i);
+            out.append((const char*)v, 4);
+            break;
+        case DATATYPE_BOOLEAN:
+            out.push_back(change.i ? 1 : 0);
+            break;
+        case DATATYPE_STRING:
+            // long string - size prefix
+            _rcp_store32(v, (uint32_t)change.s.size());
+            out.append((const char*)v, 4);
+            out.append(change.s);
+            break;
+        default:
+            break;
+        }
+    }
+
+}
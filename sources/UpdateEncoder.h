@@ -0,0 +1,121 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef UPDATEENCODER_H
+#define UPDATEENCODER_H
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <rcp_parameter_type.h>
+
+namespace rcp
+{
+
+    /* serializes value updates on a background thread.
+     * the pd thread only copies changed values into the front change set,
+     * the encoder thread swaps it with the back set, builds UPDATEVALUE
+     * packets and hands them to the sink.
+     * NOTE: values are still set in the parameter tree (and marked dirty).
+     * rcp-c has no call to clear that flag, so the transporter asks
+     * alreadySent() and drops what the encoder sent before.
+     * call flush() before rcp_server_update so no older value overtakes the tree.
+     */
+    class UpdateEncoder
+    {
+    public:
+        typedef std::function<void(const char* data, size_t size)> Sink;
+
+        explicit UpdateEncoder(Sink sink);
+        ~UpdateEncoder();
+
+        // pd thread: copy current value, latest value per parameter wins
+        void snapshot(rcp_parameter* parameter);
+
+        // encode pending changes on the calling thread.
+        // returns after everything snapshotted before was handed to the sink
+        void flush();
+
+        // true if data is the UPDATEVALUE the encoder sent last for its parameter.
+        // forgets the parameter either way - the next value goes out again
+        bool alreadySent(const char* data, size_t size);
+
+    private:
+        struct Change
+        {
+            int16_t id;
+            rcp_datatype type;
+            int32_t i;
+            float f;
+            std::string s;
+        };
+
+        void _run();
+        void _encode();
+        static void _write(const Change& change, std::string& out);
+
+    private:
+        Sink m_sink;
+
+        // front: written by pd, back: read by the encoder
+        std::vector<Change> m_front;
+        std::vector<Change> m_back;
+        // parameter id -> index in m_front
+        std::map<int16_t, size_t> m_index;
+
+        std::mutex m_lock;
+        std::condition_variable m_cond;
+        // keeps swap and encode of one batch together
+        std::mutex m_encodeLock;
+        std::string m_packet;
+
+        // parameter id -> last packet handed to the sink (no bangs)
+        std::map<int16_t, std::string> m_sent;
+        std::mutex m_sentLock;
+
+        std::thread m_thread;
+        bool m_run{true};
+    };
+
+}
+
+#endif // UPDATEENCODER_H
@@ -3,8 +3,8 @@
 namespace rcp
 {
 
-    WebsocketClientImpl::WebsocketClientImpl(IWebsocketClientListener* listener)
-        : websocketClient()
+    WebsocketClientImpl::WebsocketClientImpl(IWebsocketClientListener* listener, bool polled)
+        : websocketClient(polled)
         , m_listener(listener)
     {
     }
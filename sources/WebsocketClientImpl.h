@@ -8,7 +8,7 @@ namespace rcp
     class WebsocketClientImpl : public websocketClient
     {
     public:
-        WebsocketClientImpl(IWebsocketClientListener* listener);
+        WebsocketClientImpl(IWebsocketClientListener* listener, bool polled = false);
 
     public:
         // websocketClient
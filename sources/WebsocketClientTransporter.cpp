@@ -46,14 +46,14 @@ static void _pd_websocket_client_transporter_send(rcp_client_transporter* transp
 	if (transporter &&
             transporter->user)
 	{
-		((rcp::WebsocketClientTransporter*)transporter->user)->send(data, size);
+		((rcp::WebsocketClientTransporter*)transporter->user)->sendData(data, size);
 	}
 }
 
 namespace rcp
 {
-    WebsocketClientTransporter::WebsocketClientTransporter(IWebsocketClientListener* listener)
-        : websocketClient()
+    WebsocketClientTransporter::WebsocketClientTransporter(IWebsocketClientListener* listener, bool polled)
+        : websocketClient(polled)
         , m_transporter(nullptr)
         , m_listener(listener)
     {
@@ -70,6 +70,10 @@ namespace rcp
 
     WebsocketClientTransporter::~WebsocketClientTransporter()
     {
+        // stop io before the udp channel goes away
+        shutdown();
+        m_udp.reset();
+
         if (m_transporter)
         {
             RCP_FREE(m_transporter);
@@ -94,9 +98,61 @@ namespace rcp
         websocketClient::disconnect();
     }
 
+    bool WebsocketClientTransporter::detach()
+    {
+        if (polled())
+        {
+            // no threads to wait for
+            return false;
+        }
+
+        // no more calls into rcp_client or the listener after this
+        detachEvents();
+        m_listener = nullptr;
+
+        return true;
+    }
+
+    void WebsocketClientTransporter::sendData(char* data, size_t size)
+    {
+        if (m_udpEnabled &&
+                UdpChannel::isUpdateValue(data, size))
+        {
+            std::lock_guard<std::mutex> guard(m_udpLock);
+
+            if (m_udpActive)
+            {
+                m_udp->send(m_udpServer, data, size);
+                return;
+            }
+        }
+
+        send(data, size);
+    }
+
     // websocketClient
     void WebsocketClientTransporter::connected()
     {
+        if (m_udpEnabled)
+        {
+            // NOTE: called on the io thread
+            std::shared_ptr<UdpChannel> udp = std::make_shared<UdpChannel>(io_service());
+            udp->setReceiveHandler(std::bind(&WebsocketClientTransporter::_udpReceived, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+
+            asio::ip::tcp::endpoint remote;
+            if (remoteEndpoint(remote) &&
+                    udp->open(0))
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_udpLock);
+                    m_udp = udp;
+                }
+
+                // ask server for udp
+                sendText(UdpChannel::handshake(udp->localPort()));
+            }
+        }
+
         if (m_transporter)
         {
             rcp_client_transporter_call_connected_cb(m_transporter);
@@ -110,6 +166,8 @@ namespace rcp
 
     void WebsocketClientTransporter::failed(uint16_t code)
     {
+        _closeUdp();
+
         if (m_transporter)
         {
             // NOTE: this re-creates the client manager
@@ -124,6 +182,8 @@ namespace rcp
 
     void WebsocketClientTransporter::disconnected(uint16_t code)
     {
+        _closeUdp();
+
         if (m_transporter)
         {
             // NOTE: this re-creates the client manager
@@ -144,4 +204,64 @@ namespace rcp
         }
     }
 
+    void WebsocketClientTransporter::received(const std::string& msg)
+    {
+        uint16_t port = UdpChannel::parseHandshake(msg);
+        if (port == 0)
+        {
+            return;
+        }
+
+        asio::ip::tcp::endpoint remote;
+        if (!remoteEndpoint(remote))
+        {
+            return;
+        }
+
+        // server accepted - value updates go via udp from now on
+        std::lock_guard<std::mutex> guard(m_udpLock);
+        if (!m_udp)
+        {
+            return;
+        }
+
+        m_udpServer = asio::ip::udp::endpoint(remote.address(), port);
+        m_udpActive = true;
+    }
+
+    void WebsocketClientTransporter::_udpReceived(const asio::ip::udp::endpoint& from, const char* data, size_t size)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_udpLock);
+            if (!m_udpActive ||
+                    from != m_udpServer)
+            {
+                return;
+            }
+        }
+
+        // same thread as websocket messages
+        std::unique_lock<std::mutex> guard = dispatchGuard();
+        if (!detached())
+        {
+            received(const_cast<char*>(data), size);
+        }
+    }
+
+    void WebsocketClientTransporter::_closeUdp()
+    {
+        std::shared_ptr<UdpChannel> udp;
+
+        {
+            std::lock_guard<std::mutex> guard(m_udpLock);
+            m_udpActive = false;
+            udp.swap(m_udp);
+        }
+
+        if (udp)
+        {
+            udp->close();
+        }
+    }
+
 } // namespace rcp
@@ -38,10 +38,15 @@
 #ifndef WEBSOCKETCLIENTTRANSPORTER_H
 #define WEBSOCKETCLIENTTRANSPORTER_H
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 #include <rcp_client_transporter.h>
 
 #include "IClientTransporter.h"
 #include "websocketClient.h"
+#include "UdpChannel.h"
 
 typedef struct _pd_websocket_client_transporter pd_websocket_client_transporter;
 
@@ -52,26 +57,45 @@ namespace rcp
     class WebsocketClientTransporter : public IClientTransporter, public websocketClient
     {
     public:
-        WebsocketClientTransporter(IWebsocketClientListener* listener);
+        WebsocketClientTransporter(IWebsocketClientListener* listener, bool polled = false);
         ~WebsocketClientTransporter();
 
         // IClientTransporter
         rcp_client_transporter* transporter() const override;
         void open(const std::string& address) override;
         void close() override;
+        bool detach() override;
         void pushData(char* /*data*/, size_t /*size*/) const override {}
 
+        void sendData(char* data, size_t size);
+
+        // udp side channel for value updates (ws:// only)
+        void setUdp(bool udp) { m_udpEnabled = udp; }
+        bool udp() const { return m_udpEnabled; }
+
     public:
         // websocketClient
         void connected() override;
         void failed(uint16_t code) override;
         void disconnected(uint16_t code) override;
         void received(char* data, size_t size) override;
-        void received(const std::string& /*msg*/) override {}
+        void received(const std::string& msg) override;
+
+    private:
+        void _udpReceived(const asio::ip::udp::endpoint& from, const char* data, size_t size);
+        void _closeUdp();
 
     private:
         rcp_client_transporter* m_transporter{nullptr};
         IWebsocketClientListener* m_listener{nullptr};
+
+        // udp
+        std::atomic<bool> m_udpEnabled{false};
+        // one channel per connection
+        std::shared_ptr<UdpChannel> m_udp;
+        bool m_udpActive{false};
+        asio::ip::udp::endpoint m_udpServer;
+        std::mutex m_udpLock;
     };
 }
 
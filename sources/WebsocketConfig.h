@@ -0,0 +1,174 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+#ifndef WEBSOCKETCONFIG_H
+#define WEBSOCKETCONFIG_H
+
+// NOTE: needed to figure out ASIO_STANDALONE before including websocketpp
+#include <asio.hpp>
+
+#include <websocketpp/config/asio_no_tls.hpp>
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#ifndef RCP_NO_SSL
+#include <websocketpp/config/asio_client.hpp>
+#endif
+#include <websocketpp/message_buffer/message.hpp>
+#include <websocketpp/logger/stub.hpp>
+
+#include "MessagePool.h"
+#include "ConnectionStats.h"
+
+/* websocketpp configs
+ * default: lean configs
+ *  - logging compiled out (log::stub) - all channels were cleared at runtime anyway
+ *  - pooled message buffers (see MessagePool.h)
+ *  - read buffer size RCP_WS_READ_BUFFER_SIZE
+ * define RCP_WEBSOCKET_STOCK_CONFIG to use the stock websocketpp configs.
+ *
+ * server connections always carry ConnectionStats.
+ *
+ * NOTE: concurrency stays concurrency::basic. endpoints are used from the
+ * io thread and the Pd thread (sending) unless polled, which is a runtime
+ * option - concurrency::none is not safe for that.
+ */
+
+// bytes read from the socket at once
+#ifndef RCP_WS_READ_BUFFER_SIZE
+#define RCP_WS_READ_BUFFER_SIZE 8192
+#endif
+
+namespace rcp
+{
+namespace config
+{
+
+#ifdef RCP_WEBSOCKET_STOCK_CONFIG
+
+    struct asio : public websocketpp::config::asio
+    {
+        typedef rcp::ConnectionStats connection_base;
+    };
+
+    typedef websocketpp::config::asio_client asio_client;
+#ifndef RCP_NO_SSL
+    typedef websocketpp::config::asio_tls_client asio_tls_client;
+#endif
+
+#else
+
+    // message type shared by all configs
+    typedef websocketpp::message_buffer::message<rcp::pooled_con_msg_manager> pooled_message_type;
+
+    struct asio : public websocketpp::config::asio
+    {
+        typedef asio type;
+        typedef websocketpp::config::asio base;
+
+        typedef pooled_message_type message_type;
+        typedef rcp::pooled_con_msg_manager<message_type> con_msg_manager_type;
+        typedef rcp::pooled_endpoint_msg_manager<con_msg_manager_type> endpoint_msg_manager_type;
+
+        typedef websocketpp::log::stub alog_type;
+        typedef websocketpp::log::stub elog_type;
+
+        struct transport_config : public base::transport_config
+        {
+            typedef type::alog_type alog_type;
+            typedef type::elog_type elog_type;
+        };
+
+        typedef websocketpp::transport::asio::endpoint<transport_config> transport_type;
+
+        typedef rcp::ConnectionStats connection_base;
+
+        static const size_t connection_read_buffer_size = RCP_WS_READ_BUFFER_SIZE;
+    };
+
+    struct asio_client : public websocketpp::config::asio_client
+    {
+        typedef asio_client type;
+        typedef websocketpp::config::asio_client base;
+
+        typedef pooled_message_type message_type;
+        typedef rcp::pooled_con_msg_manager<message_type> con_msg_manager_type;
+        typedef rcp::pooled_endpoint_msg_manager<con_msg_manager_type> endpoint_msg_manager_type;
+
+        typedef websocketpp::log::stub alog_type;
+        typedef websocketpp::log::stub elog_type;
+
+        struct transport_config : public base::transport_config
+        {
+            typedef type::alog_type alog_type;
+            typedef type::elog_type elog_type;
+        };
+
+        typedef websocketpp::transport::asio::endpoint<transport_config> transport_type;
+
+        static const size_t connection_read_buffer_size = RCP_WS_READ_BUFFER_SIZE;
+    };
+
+#ifndef RCP_NO_SSL
+    struct asio_tls_client : public websocketpp::config::asio_tls_client
+    {
+        typedef asio_tls_client type;
+        typedef websocketpp::config::asio_tls_client base;
+
+        typedef pooled_message_type message_type;
+        typedef rcp::pooled_con_msg_manager<message_type> con_msg_manager_type;
+        typedef rcp::pooled_endpoint_msg_manager<con_msg_manager_type> endpoint_msg_manager_type;
+
+        typedef websocketpp::log::stub alog_type;
+        typedef websocketpp::log::stub elog_type;
+
+        struct transport_config : public base::transport_config
+        {
+            typedef type::alog_type alog_type;
+            typedef type::elog_type elog_type;
+        };
+
+        typedef websocketpp::transport::asio::endpoint<transport_config> transport_type;
+
+        static const size_t connection_read_buffer_size = RCP_WS_READ_BUFFER_SIZE;
+    };
+#endif
+
+#endif // RCP_WEBSOCKET_STOCK_CONFIG
+
+}
+}
+
+#endif // WEBSOCKETCONFIG_H
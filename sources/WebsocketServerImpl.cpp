@@ -40,23 +40,25 @@
 namespace rcp
 {
 
-    WebsocketServerImpl::WebsocketServerImpl(IWebsocketServerListener* listener)
-        : websocketServer()
+    WebsocketServerImpl::WebsocketServerImpl(IWebsocketServerListener* listener, bool polled)
+        : websocketServer(polled)
         , m_listener(listener)
     {
     }
 
     size_t WebsocketServerImpl::connections() const
     {
-        return m_connections.size();
+        return connections_snapshot()->size();
     }
 
     void WebsocketServerImpl::send(char* data, size_t size)
     {
         // send to all connected clients
-        for (auto& conn : m_connections)
+        con_list_ptr connections = connections_snapshot();
+
+        for (const con_entry& conn : *connections)
         {
-            m_server.send(conn, data, size, websocketpp::frame::opcode::value::binary);
+            sendTo(conn.hdl, data, size);
         }
     }
 
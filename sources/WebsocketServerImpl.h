@@ -46,7 +46,7 @@ namespace rcp
     class WebsocketServerImpl : public websocketServer
     {
     public:
-        WebsocketServerImpl(IWebsocketServerListener* listener);
+        WebsocketServerImpl(IWebsocketServerListener* listener, bool polled = false);
 
         size_t connections() const;
         void send(char* data, size_t size);
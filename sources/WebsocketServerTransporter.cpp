@@ -63,11 +63,13 @@ void _pd_websocket_server_transporter_sendToAll(rcp_server_transporter* transpor
 
 namespace rcp
 {
-    WebsocketServerTransporter::WebsocketServerTransporter(rcp_server* server, IWebsocketServerListener* listener)
-        : websocketServer()
+    WebsocketServerTransporter::WebsocketServerTransporter(rcp_server* server, IWebsocketServerListener* listener, bool polled)
+        : websocketServer(polled)
         , m_rcpServer(server)
         , m_transporter(nullptr)
         , m_listener(listener)
+        , m_sendStrand(m_server.get_io_service())
+        , m_alive(std::make_shared<bool>(true))
     {
         m_transporter = (rcp_server_transporter*)RCP_CALLOC(1, sizeof(rcp_server_transporter));
 
@@ -85,10 +87,22 @@ namespace rcp
 
     WebsocketServerTransporter::~WebsocketServerTransporter()
     {
+        m_encoder.reset();
+
+        // sends still queued on the io service are dropped,
+        // stop() waits for a running one
+        m_alive.reset();
+
+        // stop io before the udp channel goes away
+        stop();
+
         if (m_transporter)
         {
-            // remove transporter from rcp_Server
-            rcp_server_remove_transporter(m_rcpServer, m_transporter);
+            if (m_rcpServer)
+            {
+                // remove transporter from rcp_Server
+                rcp_server_remove_transporter(m_rcpServer, m_transporter);
+            }
 
             RCP_FREE(m_transporter);
             m_transporter = nullptr;
@@ -112,6 +126,32 @@ namespace rcp
         stop();
     }
 
+    bool WebsocketServerTransporter::detach()
+    {
+        if (polled())
+        {
+            // no threads to wait for
+            return false;
+        }
+
+        // no more calls into rcp_server or the listener after this
+        detach_events();
+
+        // no more sends from the encoder thread
+        m_encoder.reset();
+
+        if (m_transporter &&
+                m_rcpServer)
+        {
+            rcp_server_remove_transporter(m_rcpServer, m_transporter);
+        }
+
+        m_rcpServer = nullptr;
+        m_listener = nullptr;
+
+        return true;
+    }
+
     uint16_t WebsocketServerTransporter::port() const
     {
         return websocketServer::port();
@@ -161,6 +201,187 @@ namespace rcp
         error("websocketserver(%d): %s", websocketServer::port(), reason);
     }
 
+    // async
+
+    void WebsocketServerTransporter::setAsync(bool async)
+    {
+        if (async == m_async)
+        {
+            return;
+        }
+
+        if (!async &&
+                m_encoder)
+        {
+            // send what is pending with the async path still on
+            m_encoder->flush();
+            m_encoder.reset();
+        }
+
+        m_async = async;
+
+        if (m_async)
+        {
+            m_encoder.reset(new UpdateEncoder([this](const char* data, size_t size) {
+                _postToAll(data, size, nullptr);
+            }));
+        }
+    }
+
+    void WebsocketServerTransporter::snapshot(rcp_parameter* parameter)
+    {
+        if (m_encoder)
+        {
+            m_encoder->snapshot(parameter);
+        }
+    }
+
+    void WebsocketServerTransporter::flushSnapshots()
+    {
+        if (m_encoder)
+        {
+            m_encoder->flush();
+        }
+    }
+
+    // udp
+
+    void WebsocketServerTransporter::setUdpPort(uint16_t port)
+    {
+        if (port == m_udpPort)
+        {
+            return;
+        }
+
+        m_udpPort = port;
+
+        std::shared_ptr<UdpChannel> udp;
+
+        if (m_udpPort > 0)
+        {
+            udp = std::make_shared<UdpChannel>(m_server.get_io_service());
+            udp->setReceiveHandler(std::bind(&WebsocketServerTransporter::_udpReceived, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+
+            if (!udp->open(m_udpPort))
+            {
+                error("websocketserver(%d): could not open udp port %d", websocketServer::port(), m_udpPort);
+                udp.reset();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(m_udpLock);
+            m_udpPeers.clear();
+            m_udpConnections.clear();
+        }
+
+        // io threads may still use the old channel - it closes on its strand
+        // and goes away with the last queued handler
+        std::shared_ptr<UdpChannel> old = std::atomic_exchange(&m_udp, udp);
+        if (old)
+        {
+            old->close();
+        }
+    }
+
+    void WebsocketServerTransporter::handle_action(const action& a)
+    {
+        websocketServer::handle_action(a);
+
+        if (a.type != UNSUBSCRIBE)
+        {
+            return;
+        }
+
+        std::shared_ptr<UdpChannel> udp = std::atomic_load(&m_udp);
+        if (udp)
+        {
+            std::lock_guard<std::mutex> guard(m_udpLock);
+
+            auto it = m_udpPeers.find(a.hdl);
+            if (it != m_udpPeers.end())
+            {
+                udp->forget(it->second);
+                m_udpConnections.erase(it->second);
+                m_udpPeers.erase(it);
+            }
+        }
+    }
+
+    void WebsocketServerTransporter::received_text(connection_hdl hdl, const std::string& msg)
+    {
+        uint16_t port = UdpChannel::parseHandshake(msg);
+        if (port == 0)
+        {
+            websocketServer::received_text(hdl, msg);
+            return;
+        }
+
+        if (!std::atomic_load(&m_udp))
+        {
+            // no udp - client keeps using the websocket
+            return;
+        }
+
+        websocketpp::lib::error_code ec;
+        server::connection_ptr con = m_server.get_con_from_hdl(hdl, ec);
+        if (ec || !con)
+        {
+            return;
+        }
+
+        asio::ip::tcp::endpoint remote = con->get_raw_socket().remote_endpoint(ec);
+        if (ec)
+        {
+            return;
+        }
+
+        asio::ip::udp::endpoint peer(remote.address(), port);
+
+        {
+            std::lock_guard<std::mutex> guard(m_udpLock);
+            m_udpPeers[hdl] = peer;
+            m_udpConnections[peer] = hdl;
+        }
+
+        // tell the client our port
+        m_server.send(hdl, UdpChannel::handshake(m_udpPort), websocketpp::frame::opcode::text, ec);
+    }
+
+    bool WebsocketServerTransporter::_sendUdp(UdpChannel* udp, connection_hdl hdl, const char* data, size_t size)
+    {
+        std::lock_guard<std::mutex> guard(m_udpLock);
+
+        auto it = m_udpPeers.find(hdl);
+        if (it == m_udpPeers.end())
+        {
+            return false;
+        }
+
+        udp->send(it->second, data, size);
+        return true;
+    }
+
+    void WebsocketServerTransporter::_udpReceived(const asio::ip::udp::endpoint& from, const char* data, size_t size)
+    {
+        connection_hdl hdl;
+
+        {
+            std::lock_guard<std::mutex> guard(m_udpLock);
+
+            auto it = m_udpConnections.find(from);
+            if (it == m_udpConnections.end())
+            {
+                // unknown sender
+                return;
+            }
+
+            hdl = it->second;
+        }
+
+        queue_received(hdl, data, size);
+    }
+
     void WebsocketServerTransporter::sendToOne(char* data, size_t size, void* id)
     {
         if (!m_server.is_listening()) {
@@ -171,38 +392,105 @@ namespace rcp
             return;
         }
 
-        for (auto& conn : m_connections)
+        if (m_async)
         {
-            if (auto p = conn.lock())
-            {
-                if (id == p.get())
+            // copy once, framing and sending happens on the io thread
+            std::shared_ptr<std::string> buffer = std::make_shared<std::string>(data, size);
+            std::weak_ptr<bool> alive = m_alive;
+            m_sendStrand.post([this, alive, buffer, id]() {
+                if (alive.lock())
                 {
-                    m_server.send(conn, data, size, websocketpp::frame::opcode::value::binary);
+                    _sendToOne(buffer->data(), buffer->size(), id);
                 }
-            }
-            else
-            {
-                // TODO: handle this?
-            }
+            });
+            return;
         }
+
+        _sendToOne(data, size, id);
     }
 
     void WebsocketServerTransporter::sendToAll(char* data, size_t size, void* excludeId)
+    {
+        // rcp_server_update: values the encoder sent are still dirty.
+        // forwarded client updates (excludeId set) come from the io thread
+        if (excludeId == nullptr &&
+                m_encoder &&
+                m_encoder->alreadySent(data, size))
+        {
+            return;
+        }
+
+        _postToAll(data, size, excludeId);
+    }
+
+    void WebsocketServerTransporter::_postToAll(const char* data, size_t size, void* excludeId)
     {
         if (!m_server.is_listening()) {
             return;
         }
 
-        for (auto& conn : m_connections)
+        if (m_async)
         {
-            if (auto p = conn.lock())
+            // copy once, framing and sending happens on the io thread
+            std::shared_ptr<std::string> buffer = std::make_shared<std::string>(data, size);
+            std::weak_ptr<bool> alive = m_alive;
+            m_sendStrand.post([this, alive, buffer, excludeId]() {
+                if (alive.lock())
+                {
+                    _sendToAll(buffer->data(), buffer->size(), excludeId);
+                }
+            });
+            return;
+        }
+
+        _sendToAll(data, size, excludeId);
+    }
+
+    void WebsocketServerTransporter::_sendToOne(const char* data, size_t size, void* id)
+    {
+        std::shared_ptr<UdpChannel> udp;
+        if (UdpChannel::isUpdateValue(data, size))
+        {
+            udp = std::atomic_load(&m_udp);
+        }
+
+        con_list_ptr connections = connections_snapshot();
+
+        for (const con_entry& conn : *connections)
+        {
+            if (id == conn.id)
             {
-                if (excludeId == p.get())
+                if (udp && _sendUdp(udp.get(), conn.hdl, data, size))
                 {
-                    continue;
+                    return;
                 }
-                m_server.send(conn, data, size, websocketpp::frame::opcode::value::binary);
+                sendTo(conn.hdl, data, size);
+                return;
+            }
+        }
+    }
+
+    void WebsocketServerTransporter::_sendToAll(const char* data, size_t size, void* excludeId)
+    {
+        std::shared_ptr<UdpChannel> udp;
+        if (UdpChannel::isUpdateValue(data, size))
+        {
+            udp = std::atomic_load(&m_udp);
+        }
+
+        con_list_ptr connections = connections_snapshot();
+
+        for (const con_entry& conn : *connections)
+        {
+            if (excludeId == conn.id)
+            {
+                continue;
+            }
+            if (udp && _sendUdp(udp.get(), conn.hdl, data, size))
+            {
+                continue;
             }
+            sendTo(conn.hdl, data, size);
         }
     }
 
@@ -38,10 +38,18 @@
 #ifndef WEBSOCKETSERVERTRANSPORTER_H
 #define WEBSOCKETSERVERTRANSPORTER_H
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
 #include <rcp_server_transporter.h>
 
 #include "IServerTransporter.h"
 #include "websocketServer.h"
+#include "UdpChannel.h"
+#include "UpdateEncoder.h"
 
 typedef struct _pd_websocket_server_transporter pd_websocket_server_transporter;
 
@@ -54,7 +62,7 @@ namespace rcp
             , public websocketServer
     {
     public:
-        WebsocketServerTransporter(rcp_server* server, IWebsocketServerListener* listener);
+        WebsocketServerTransporter(rcp_server* server, IWebsocketServerListener* listener, bool polled = false);
         ~WebsocketServerTransporter();
 
     public:
@@ -64,10 +72,29 @@ namespace rcp
         void unbind() override;
         uint16_t port() const override;
         bool isListening() const override;
+        bool detach() override;
+        void stats(std::vector<ConnectionInfo>& out) override { connection_stats(out); }
+        void ping() override { ping_all(); }
+        void rejected(uint64_t& full, uint64_t& limited) const override { rejected_connections(full, limited); }
 
         void sendToOne(char* data, size_t size, void* id);
         void sendToAll(char* data, size_t size, void* excludeId);
 
+        // hand packets to the io thread for framing and fan-out
+        // value updates are serialized on a background encoder
+        void setAsync(bool async);
+        bool async() const { return m_async; }
+
+        // async: copy the current value, the encoder sends it
+        void snapshot(rcp_parameter* parameter);
+        // send pending snapshots - call before rcp_server_update
+        void flushSnapshots();
+
+        // udp side channel for value updates - 0: off
+        // NOTE: set before bind
+        void setUdpPort(uint16_t port);
+        uint16_t udpPort() const { return m_udpPort; }
+
     public:
         // IWebsocketServerListener
         void connected(void* client) override;
@@ -75,10 +102,37 @@ namespace rcp
         void received(char* data, size_t size, void* id) override;
         void socketerror(const char* reason) override;
 
+    protected:
+        // websocketServer
+        void handle_action(const action& a) override;
+        void received_text(connection_hdl hdl, const std::string& msg) override;
+
+    private:
+        // sendToAll without the encoder check
+        void _postToAll(const char* data, size_t size, void* excludeId);
+        void _sendToOne(const char* data, size_t size, void* id);
+        void _sendToAll(const char* data, size_t size, void* excludeId);
+        bool _sendUdp(UdpChannel* udp, connection_hdl hdl, const char* data, size_t size);
+        void _udpReceived(const asio::ip::udp::endpoint& from, const char* data, size_t size);
+
     private:
         rcp_server* m_rcpServer{nullptr};
         rcp_server_transporter* m_transporter{nullptr};
         IWebsocketServerListener* m_listener{nullptr};
+        std::atomic<bool> m_async{false};
+        std::unique_ptr<UpdateEncoder> m_encoder;
+        // async sends keep their order with several io threads
+        asio::io_service::strand m_sendStrand;
+        // reset first in the destructor - posted sends check it
+        std::shared_ptr<bool> m_alive;
+
+        // udp
+        uint16_t m_udpPort{0};
+        // read on io threads - std::atomic_load / std::atomic_store
+        std::shared_ptr<UdpChannel> m_udp;
+        std::map<connection_hdl, asio::ip::udp::endpoint, std::owner_less<connection_hdl> > m_udpPeers;
+        std::map<asio::ip::udp::endpoint, connection_hdl> m_udpConnections;
+        std::mutex m_udpLock;
     };
 }
 
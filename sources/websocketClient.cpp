@@ -36,6 +36,9 @@
 */
 
 #include "websocketClient.h"
+#include "Poller.h"
+
+#include <chrono>
 
 #ifndef RCP_NO_SSL
 #include <openssl/asn1.h>
@@ -47,42 +50,79 @@
 namespace rcp
 {
 
-websocketClient::websocketClient()
+websocketClient::websocketClient(bool polled)
     : m_hostname(RABBITHOLE_HOSTNAME)
+    , m_polled(polled)
+    , m_sender(m_client)
+#ifndef RCP_NO_SSL
+    , m_sslSender(m_sslClient)
+#endif
 {
     // Set logging to be pretty verbose (everything except message payloads)
     m_client.clear_access_channels(websocketpp::log::alevel::all);
     m_client.clear_error_channels(websocketpp::log::alevel::all);
 //    m_client.clear_access_channels(websocketpp::log::alevel::frame_payload);
     m_client.set_access_channels(websocketpp::log::alevel::frame_payload);
+    m_client.set_socket_init_handler(bind(&websocketClient::_socketInit, this, ::_1, ::_2));
+    m_client.set_pong_handler(bind(&websocketClient::_pong, this, ::_1, ::_2));
 
 
     // Initialize Asio Transport
 
     m_client.init_asio();
     m_client.start_perpetual();
-    m_thread = websocketpp::lib::make_shared<websocketpp::lib::thread>(&client::run, &m_client);
+    if (!m_polled)
+    {
+        m_thread = websocketpp::lib::make_shared<websocketpp::lib::thread>(&client::run, &m_client);
+    }
 
 #ifndef RCP_NO_SSL
     m_sslClient.clear_access_channels(websocketpp::log::alevel::all);
     m_sslClient.clear_error_channels(websocketpp::log::alevel::all);
 //    m_sslClient.clear_access_channels(websocketpp::log::alevel::frame_payload);
     m_sslClient.set_tls_init_handler(bind(&websocketClient::on_tls_init, this, ::_1));
+    m_sslClient.set_socket_init_handler(bind(&websocketClient::_tlsSocketInit, this, ::_1, ::_2));
+    m_sslClient.set_pong_handler(bind(&websocketClient::_pong, this, ::_1, ::_2));
 
     m_sslClient.init_asio();
     m_sslClient.start_perpetual();
-    m_sslThread = websocketpp::lib::make_shared<websocketpp::lib::thread>(&ssl_client::run, &m_sslClient);
+    if (!m_polled)
+    {
+        m_sslThread = websocketpp::lib::make_shared<websocketpp::lib::thread>(&ssl_client::run, &m_sslClient);
+    }
 #endif
+
+    if (m_polled)
+    {
+        Poller::add(this);
+    }
 }
 
 websocketClient::~websocketClient()
 {
+    shutdown();
+}
+
+void websocketClient::shutdown()
+{
+    if (m_shutdown)
+    {
+        return;
+    }
+    m_shutdown = true;
+
+    if (m_polled)
+    {
+        Poller::remove(this);
+    }
+
     if (m_con) m_con->set_close_handler(nullptr);
 #ifndef RCP_NO_SSL
     if (m_sslCon) m_sslCon->set_close_handler(nullptr);
 #endif
 
 
+    _stopKeepalive();
     m_client.stop_perpetual();
 #ifndef RCP_NO_SSL
     m_sslClient.stop_perpetual();
@@ -91,14 +131,25 @@ websocketClient::~websocketClient()
 
     disconnect();
 
+    if (m_polled)
+    {
+        // nobody is polling anymore - do not wait for the closing handshake
+        m_client.stop();
+#ifndef RCP_NO_SSL
+        m_sslClient.stop();
+#endif
+    }
+
     if (m_thread)
     {
         m_thread->join();
+        m_thread.reset();
     }
 #ifndef RCP_NO_SSL
     if (m_sslThread)
     {
         m_sslThread->join();
+        m_sslThread.reset();
     }
 #endif
 }
@@ -122,6 +173,7 @@ void websocketClient::disconnect()
             }
         }
 
+        m_sslSender.clear();
         m_sslCon.reset();
     }
 #endif
@@ -141,6 +193,7 @@ void websocketClient::disconnect()
             }
         }
 
+        m_sender.clear();
         m_con.reset();
     }
 }
@@ -188,6 +241,8 @@ void websocketClient::connect(const std::string& uri, const std::string& subprot
         catch (const std::exception & e) {
             std::cout << "connect error: " << e.what() << std::endl;
         }
+
+        _startKeepalive();
 #else
         // unable to connect to wss without ssl
         std::cerr << "can not connect to secure websocket - no ssl" << std::endl;
@@ -218,6 +273,8 @@ void websocketClient::connect(const std::string& uri, const std::string& subprot
         catch (const std::exception & e) {
             std::cout << "connect error: " << e.what() << std::endl;
         }
+
+        _startKeepalive();
     }
 }
 
@@ -239,8 +296,166 @@ bool websocketClient::isOpen() const
 }
 
 
+void websocketClient::setSocketOptions(const SocketOptions& options)
+{
+    std::lock_guard<std::mutex> guard(m_socketLock);
+    m_socketOptions = options;
+}
+
+SocketOptions websocketClient::socketOptions()
+{
+    std::lock_guard<std::mutex> guard(m_socketLock);
+    return m_socketOptions;
+}
+
+void websocketClient::_socketInit(websocketpp::connection_hdl /*hdl*/, asio::ip::tcp::socket& socket)
+{
+    socketOptions().apply(socket);
+}
+
+#ifndef RCP_NO_SSL
+void websocketClient::_tlsSocketInit(websocketpp::connection_hdl /*hdl*/, asio::ssl::stream<asio::ip::tcp::socket>& socket)
+{
+    socketOptions().apply(socket.lowest_layer());
+}
+#endif
+
+void websocketClient::setKeepalive(uint32_t intervalMs, uint32_t timeoutMs)
+{
+    bool start = m_keepaliveInterval == 0 && intervalMs > 0;
+
+    m_keepaliveInterval = intervalMs;
+    m_keepaliveTimeout = timeoutMs;
+
+    if (start)
+    {
+        _startKeepalive();
+    }
+}
+
+void websocketClient::_startKeepalive()
+{
+    // NOTE: main thread - same as connect and disconnect.
+    // timers are only touched on the io threads
+    uint32_t generation = ++m_keepaliveGeneration;
+
+    if (m_keepaliveInterval == 0)
+    {
+        return;
+    }
+
+#ifndef RCP_NO_SSL
+    if (m_sslCon)
+    {
+        m_sslClient.get_io_service().post(bind(&websocketClient::_keepalive<ssl_client>, this, &m_sslClient, &m_sslKeepaliveTimer, m_sslCon->get_handle(), generation, websocketpp::lib::error_code()));
+    }
+#endif
+
+    if (m_con)
+    {
+        m_client.get_io_service().post(bind(&websocketClient::_keepalive<client>, this, &m_client, &m_keepaliveTimer, m_con->get_handle(), generation, websocketpp::lib::error_code()));
+    }
+}
+
+void websocketClient::_stopKeepalive()
+{
+    m_keepaliveInterval = 0;
+    ++m_keepaliveGeneration;
+
+    // a pending timer would keep run() from returning
+    m_client.get_io_service().post([this]() {
+        if (m_keepaliveTimer) m_keepaliveTimer->cancel();
+    });
+#ifndef RCP_NO_SSL
+    m_sslClient.get_io_service().post([this]() {
+        if (m_sslKeepaliveTimer) m_sslKeepaliveTimer->cancel();
+    });
+#endif
+}
+
+template <typename Endpoint>
+void websocketClient::_keepalive(Endpoint* endpoint, typename Endpoint::timer_ptr* timer, websocketpp::connection_hdl hdl, uint32_t generation, const websocketpp::lib::error_code& ec)
+{
+    uint32_t interval = m_keepaliveInterval;
+
+    if (ec ||
+            interval == 0 ||
+            generation != m_keepaliveGeneration)
+    {
+        // cancelled, switched off or replaced
+        return;
+    }
+
+    websocketpp::lib::error_code e;
+    typename Endpoint::connection_ptr con = endpoint->get_con_from_hdl(hdl, e);
+    if (!con)
+    {
+        return;
+    }
+
+    int64_t silent = _nowMs() - m_lastSeen;
+    int64_t timeout = m_keepaliveTimeout;
+
+    switch (con->get_state())
+    {
+    case websocketpp::session::state::connecting:
+        // open handshake has its own timeout
+        break;
+
+    case websocketpp::session::state::open:
+        if (silent > interval + timeout)
+        {
+            // server vanished
+            con->close(websocketpp::close::status::going_away, "ping timeout", e);
+        }
+        else if (silent >= interval)
+        {
+            con->ping("", e);
+        }
+        break;
+
+    case websocketpp::session::state::closing:
+        if (silent > 2 * interval + timeout)
+        {
+            // closing handshake stuck behind a full send buffer
+            con->get_raw_socket().close(e);
+        }
+        break;
+
+    default:
+        // closed - done
+        return;
+    }
+
+    *timer = endpoint->set_timer(interval, bind(&websocketClient::_keepalive<Endpoint>, this, endpoint, timer, hdl, generation, ::_1));
+}
+
+void websocketClient::_pong(websocketpp::connection_hdl /*hdl*/, std::string /*payload*/)
+{
+    m_lastSeen = _nowMs();
+}
+
+int64_t websocketClient::_nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void websocketClient::detachEvents()
+{
+    std::lock_guard<std::mutex> guard(m_dispatchLock);
+    m_detached = true;
+}
+
 void websocketClient::on_message(connection_hdl /*hdl*/, client::message_ptr msg)
 {
+    m_lastSeen = _nowMs();
+
+    std::unique_lock<std::mutex> guard = dispatchGuard();
+    if (detached())
+    {
+        return;
+    }
+
     if (msg->get_opcode() == websocketpp::frame::opcode::value::binary)
     {
         const std::string & data = msg->get_raw_payload();
@@ -258,8 +473,7 @@ void websocketClient::send(char* data, size_t size)
 #ifndef RCP_NO_SSL
     if (m_sslCon)
     {
-        websocketpp::lib::error_code ec;
-        m_sslClient.send(m_sslCon->get_handle(), data, size, websocketpp::frame::opcode::binary, ec);
+        websocketpp::lib::error_code ec = m_sslSender.send(m_sslCon->get_handle(), data, size);
         if (ec) {
             std::cout << "sending failed: " << ec.message() << std::endl << std::endl;
         }
@@ -268,14 +482,62 @@ void websocketClient::send(char* data, size_t size)
 
     if (m_con)
     {
-        websocketpp::lib::error_code ec;
-        m_client.send(m_con->get_handle(), data, size, websocketpp::frame::opcode::binary, ec);
+        websocketpp::lib::error_code ec = m_sender.send(m_con->get_handle(), data, size);
         if (ec) {
             std::cout << "sending failed: " << ec.message() << std::endl << std::endl;
         }
     }
 }
 
+void websocketClient::sendText(const std::string& msg)
+{
+#ifndef RCP_NO_SSL
+    if (m_sslCon)
+    {
+        websocketpp::lib::error_code ec = m_sslCon->send(msg, websocketpp::frame::opcode::value::text);
+        if (ec) {
+            std::cout << "sending failed: " << ec.message() << std::endl << std::endl;
+        }
+    }
+#endif
+
+    if (m_con)
+    {
+        websocketpp::lib::error_code ec = m_con->send(msg, websocketpp::frame::opcode::value::text);
+        if (ec) {
+            std::cout << "sending failed: " << ec.message() << std::endl << std::endl;
+        }
+    }
+}
+
+bool websocketClient::remoteEndpoint(asio::ip::tcp::endpoint& endpoint)
+{
+    // only plain websocket connections
+    if (!m_con)
+    {
+        return false;
+    }
+
+    websocketpp::lib::error_code ec;
+    endpoint = m_con->get_raw_socket().remote_endpoint(ec);
+    return !ec;
+}
+
+
+void websocketClient::poll()
+{
+    try
+    {
+        m_client.poll();
+#ifndef RCP_NO_SSL
+        m_sslClient.poll();
+#endif
+    }
+    catch (const std::exception & e) {
+        std::cout << "poll error: " << e.what() << std::endl;
+    }
+}
+
 
 #ifndef RCP_NO_SSL
 
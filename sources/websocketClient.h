@@ -38,6 +38,9 @@
 #ifndef RABBITCONTROL_WEBSOCKET_CLIENT_H
 #define RABBITCONTROL_WEBSOCKET_CLIENT_H
 
+#include <atomic>
+#include <mutex>
+
 // NOTE: needed to figure out ASIO_STANDALONE before including websocketpp
 #include <asio.hpp>
 
@@ -46,17 +49,22 @@
 
 #ifndef RCP_NO_SSL
 #include <asio/ssl.hpp>
-#include <websocketpp/config/asio_client.hpp>
-typedef websocketpp::client<websocketpp::config::asio_tls_client> ssl_client;
+#endif
+
+#include "PrioritySender.h"
+#include "IPollable.h"
+#include "WebsocketConfig.h"
+#include "SocketOptions.h"
+
+#ifndef RCP_NO_SSL
+typedef websocketpp::client<rcp::config::asio_tls_client> ssl_client;
 typedef websocketpp::lib::shared_ptr<websocketpp::lib::asio::ssl::context> context_ptr;
-#else
-#include <websocketpp/config/asio_no_tls_client.hpp>
 #endif
 
 #define RABBITHOLE_HOSTNAME "rabbithole.rabbitcontrol.cc"
 
 
-typedef websocketpp::client<websocketpp::config::asio_client> client;
+typedef websocketpp::client<rcp::config::asio_client> client;
 
 
 using websocketpp::connection_hdl;
@@ -65,7 +73,7 @@ using websocketpp::lib::placeholders::_2;
 using websocketpp::lib::bind;
 
 // pull out the type of messages sent by our config
-typedef websocketpp::config::asio_client::message_type::ptr message_ptr;
+typedef rcp::config::asio_client::message_type::ptr message_ptr;
 
 using websocketpp::lib::thread;
 
@@ -85,37 +93,70 @@ namespace rcp
     };
 
 
-    class websocketClient : public IWebsocketClientListener
+    class websocketClient : public IWebsocketClientListener, public IPollable
     {
 
     public:
 
-        websocketClient();
+        // polled: no threads, io is driven from the scheduler via poll()
+        websocketClient(bool polled = false);
         virtual ~websocketClient();
 
     public:
         void on_open(websocketpp::connection_hdl /*hdl*/)
         {
-            connected();
+            m_lastSeen = _nowMs();
+
+            std::unique_lock<std::mutex> guard = dispatchGuard();
+            if (!detached())
+            {
+                connected();
+            }
         }
 
         void on_fail(websocketpp::connection_hdl hdl)
         {
-            failed(uint16_t(_getResponseCode(hdl)));
+            std::unique_lock<std::mutex> guard = dispatchGuard();
+            if (!detached())
+            {
+                failed(uint16_t(_getResponseCode(hdl)));
+            }
         }
 
         void on_close(websocketpp::connection_hdl hdl)
         {
-            disconnected(uint16_t(_getCloseCode(hdl)));
+            std::unique_lock<std::mutex> guard = dispatchGuard();
+            if (!detached())
+            {
+                disconnected(uint16_t(_getCloseCode(hdl)));
+            }
         }
 
         bool isOpen() const;
+        bool polled() const { return m_polled; }
+
+        // applies to the next connection
+        void setSocketOptions(const SocketOptions& options);
+        SocketOptions socketOptions();
+
+        // ping every interval, close the connection when silent for interval + timeout.
+        // interval 0: off
+        void setKeepalive(uint32_t intervalMs, uint32_t timeoutMs);
+
+        // stop calling connected, failed, disconnected and received.
+        // waits for a running call, does not join any thread:
+        // the destructor may then run on any thread (see Reaper).
+        void detachEvents();
 
         virtual void connect(const std::string& uri, const std::string& subprotocol = "");
         virtual void disconnect();
 
         void on_message(connection_hdl hdl, client::message_ptr msg);
         void send(char* data, size_t size);
+        void sendText(const std::string& msg);
+
+        // IPollable
+        void poll() override;
 
     #ifndef RCP_NO_SSL
         // SSL
@@ -128,23 +169,73 @@ namespace rcp
         #endif
     #endif
 
+    protected:
+        // join io threads - call from derived destructors before
+        // tearing down state used by io handlers
+        void shutdown();
+        bool remoteEndpoint(asio::ip::tcp::endpoint& endpoint);
+        asio::io_service& io_service() { return m_client.get_io_service(); }
+
+        // hold while calling out - check detached() after taking it
+        // NOTE: not locked when polled - calls run on the main thread
+        // which may delete us from within
+        std::unique_lock<std::mutex> dispatchGuard()
+        {
+            std::unique_lock<std::mutex> guard(m_dispatchLock, std::defer_lock);
+            if (!m_polled)
+            {
+                guard.lock();
+            }
+            return guard;
+        }
+        bool detached() const { return m_detached; }
+
     private:
+        void _socketInit(websocketpp::connection_hdl hdl, asio::ip::tcp::socket& socket);
+        void _startKeepalive();
+        template <typename Endpoint>
+        void _keepalive(Endpoint* endpoint, typename Endpoint::timer_ptr* timer, websocketpp::connection_hdl hdl, uint32_t generation, const websocketpp::lib::error_code& ec);
+        void _stopKeepalive();
+        void _pong(websocketpp::connection_hdl hdl, std::string payload);
+        static int64_t _nowMs();
+    #ifndef RCP_NO_SSL
+        void _tlsSocketInit(websocketpp::connection_hdl hdl, asio::ssl::stream<asio::ip::tcp::socket>& socket);
+    #endif
         websocketpp::http::status_code::value _getResponseCode(websocketpp::connection_hdl hdl);
         websocketpp::close::status::value _getCloseCode(websocketpp::connection_hdl hdl);
         void _printCodes(websocketpp::connection_hdl hdl);
 
     private:
         std::string m_hostname;
+        bool m_polled{false};
+        bool m_shutdown{false};
+        std::mutex m_dispatchLock;
+        bool m_detached{false};
+        std::mutex m_socketLock;
+        SocketOptions m_socketOptions;
+        // milliseconds
+        std::atomic<uint32_t> m_keepaliveInterval{0};
+        std::atomic<uint32_t> m_keepaliveTimeout{0};
+        // a newer keepalive timer chain replaces older ones
+        std::atomic<uint32_t> m_keepaliveGeneration{0};
+        // last time anything was received in milliseconds
+        std::atomic<int64_t> m_lastSeen{0};
 
         client m_client;
         websocketpp::lib::shared_ptr<websocketpp::lib::thread> m_thread;
         client::connection_ptr m_con;
+        PrioritySender<client> m_sender;
+        // io thread only
+        client::timer_ptr m_keepaliveTimer;
 
     #ifndef RCP_NO_SSL
         // ssl
         ssl_client m_sslClient;
         websocketpp::lib::shared_ptr<websocketpp::lib::thread> m_sslThread;
         ssl_client::connection_ptr m_sslCon;
+        PrioritySender<ssl_client> m_sslSender;
+        // io thread only
+        ssl_client::timer_ptr m_sslKeepaliveTimer;
     #endif
     };
 
@@ -38,20 +38,34 @@
 #ifndef RABBITCONTROL_WEBSOCKET_SERVER_H
 #define RABBITCONTROL_WEBSOCKET_SERVER_H
 
-#include <set>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 // NOTE: needed to figure out ASIO_STANDALONE before including websocketpp
 #include <asio.hpp>
 
-#include <websocketpp/config/asio_no_tls.hpp>
 #include <websocketpp/server.hpp>
 #include <websocketpp/common/thread.hpp>
 
 // rcp
 #include <rcp_server.h>
 
-typedef websocketpp::server<websocketpp::config::asio> server;
+#include "PrioritySender.h"
+#include "IPollable.h"
+#include "Poller.h"
+#include "WebsocketConfig.h"
+#include "ConnectionStats.h"
+#include "SocketOptions.h"
+
+typedef websocketpp::server<rcp::config::asio> server;
 
 using websocketpp::connection_hdl;
 using websocketpp::lib::placeholders::_1;
@@ -98,15 +112,20 @@ namespace rcp
     };
 
 
-    class websocketServer : public IWebsocketServerListener
+    class websocketServer : public IWebsocketServerListener, public IPollable
     {
     public:
-        websocketServer()
+        // polled: no threads, io is driven from the scheduler via poll()
+        websocketServer(bool polled = false)
             : m_port(0)
             , ws_thread(nullptr)
             , server_thread(nullptr)
             , m_run(false)
+            , m_polled(polled)
+            , m_sender(m_server)
         {
+            std::atomic_store(&m_connections, std::make_shared<const con_list>());
+
             // Initialize Asio Transport
             m_server.init_asio();
             m_server.set_reuse_addr(true);
@@ -118,9 +137,13 @@ namespace rcp
             m_server.set_open_handler(bind(&websocketServer::on_open,this,::_1));
             m_server.set_close_handler(bind(&websocketServer::on_close,this,::_1));
             m_server.set_message_handler(bind(&websocketServer::on_message,this,::_1,::_2));
+            m_server.set_pong_handler(bind(&websocketServer::on_pong,this,::_1,::_2));
+            m_server.set_interrupt_handler(bind(&websocketServer::on_interrupt,this,::_1));
+            m_server.set_socket_init_handler(bind(&websocketServer::on_socket_init,this,::_1,::_2));
+            m_server.set_validate_handler(bind(&websocketServer::on_validate,this,::_1));
+            m_server.set_fail_handler(bind(&websocketServer::on_fail,this,::_1));
 
-            // start service thread
-            ws_thread = new websocketpp::lib::thread(std::bind(&websocketServer::process_messages, this));
+            // NOTE: service thread is started in run() unless dispatching directly
         }
 
         virtual ~websocketServer()
@@ -132,17 +155,103 @@ namespace rcp
             return m_port;
         }
 
+        bool polled() const {
+            return m_polled;
+        }
+
+        // direct: handle open, close and message on the io thread
+        // instead of handing them to the service thread.
+        // NOTE: only takes effect before run()
+        void setDirect(bool direct) {
+            m_direct = direct;
+        }
+
+        bool direct() const {
+            return m_direct;
+        }
+
+        // threads running the io loop - connections are spread over them,
+        // handlers of one connection never run concurrently (strands).
+        // NOTE: only takes effect before run(), ignored when polled
+        void set_threads(unsigned threads) {
+            m_threads = threads > 0 ? threads : 1;
+        }
+
+        unsigned threads() const {
+            return m_threads;
+        }
+
+        // applies to connections accepted from now on
+        void set_socket_options(const SocketOptions& options) {
+            lock_guard<mutex> guard(m_socket_lock);
+            m_socket_options = options;
+        }
+
+        SocketOptions socket_options() {
+            lock_guard<mutex> guard(m_socket_lock);
+            return m_socket_options;
+        }
+
+        // admission control - checked before the upgrade completes.
+        // max_clients: refuse with 503 when reached. 0: no limit
+        void set_max_clients(uint32_t max_clients) {
+            m_max_clients = max_clients;
+        }
+
+        // new connections per second and remote address, bursts of up to
+        // one second worth. refused with 429. 0: no limit
+        void set_connect_rate(float per_second) {
+            lock_guard<mutex> guard(m_admission_lock);
+            m_connect_rate = per_second > 0 ? per_second : 0;
+            m_buckets.clear();
+        }
+
+        // connections refused since start
+        void rejected_connections(uint64_t& full, uint64_t& limited) const {
+            full = m_rejected_full;
+            limited = m_rejected_limited;
+        }
+
+        // ping every interval, close connections silent for interval + timeout.
+        // interval 0: off
+        void set_keepalive(uint32_t interval_ms, uint32_t timeout_ms)
+        {
+            m_keepalive_interval = interval_ms;
+            m_keepalive_timeout = timeout_ms;
+
+            // (re)start the timer on the io thread
+            m_server.get_io_service().post(bind(&websocketServer::_keepalive_schedule, this));
+        }
+
         void run(uint16_t port)
         {
             m_port = port;
 
-            server_thread = new thread(bind(&websocketServer::_do_run, this));
+            if (m_polled)
+            {
+                try
+                {
+                    m_server.listen(m_port);
+                    m_server.start_accept();
+                } catch (const std::exception & e) {
+                    _socketerror(e.what());
+                    return;
+                }
+
+                Poller::add(this);
+                return;
+            }
 
-            if (!ws_thread)
+            if (!m_direct &&
+                    !ws_thread)
             {
                 // start service thread
+                // NOTE: set before starting, stop() may follow right away
+                m_run = true;
                 ws_thread = new websocketpp::lib::thread(std::bind(&websocketServer::process_messages, this));
             }
+
+            server_thread = new thread(bind(&websocketServer::_do_run, this));
         }
 
         void _do_run()
@@ -154,18 +263,74 @@ namespace rcp
 
                 // Start the server accept loop
                 m_server.start_accept();
+            } catch (const std::exception & e) {
+                const char* r = e.what();
+                std::cout << r << std::endl;
+                _socketerror(r);
+                return;
+            }
+
+            // more threads on the same io_service
+            // NOTE: joined in stop() after this thread
+            for (unsigned i=1; i<m_threads; i++)
+            {
+                m_io_threads.push_back(new thread(bind(&websocketServer::_run_io, this)));
+            }
 
+            _run_io();
+        }
+
+        void _run_io()
+        {
+            try
+            {
                 // Start the ASIO io_service run loop
                 m_server.run();
             } catch (const std::exception & e) {
                 const char* r = e.what();
                 std::cout << r << std::endl;
-                socketerror(r);
+                _socketerror(r);
+            }
+        }
+
+        // IPollable
+        void poll() override
+        {
+            try
+            {
+                m_server.poll();
+            } catch (const std::exception & e) {
+                _socketerror(e.what());
+            }
+        }
+
+        // stop handing out events and stop accepting connections.
+        // waits for a running event, does not join any thread:
+        // stop() may then run on any thread (see Reaper).
+        void detach_events()
+        {
+            {
+                lock_guard<mutex> guard(m_dispatch_lock);
+                m_detached = true;
+            }
+
+            // free the port right away - it may get re-used
+            if (m_server.is_listening())
+            {
+                websocketpp::lib::error_code ec;
+                m_server.stop_listening(ec);
             }
         }
 
         void stop()
         {
+            if (m_polled)
+            {
+                Poller::remove(this);
+            }
+
+            m_keepalive_interval = 0;
+
             if (!m_server.stopped())
             {
                 m_server.stop();
@@ -177,7 +342,11 @@ namespace rcp
             }
 
             // close all connections
-            m_connections.clear();
+            {
+                lock_guard<mutex> guard(m_connection_lock);
+                std::atomic_store(&m_connections, std::make_shared<const con_list>());
+            }
+            m_sender.clear();
 
             if (server_thread)
             {
@@ -187,6 +356,13 @@ namespace rcp
                 server_thread = nullptr;
             }
 
+            for (thread* t : m_io_threads)
+            {
+                t->join();
+                delete t;
+            }
+            m_io_threads.clear();
+
             if (ws_thread)
             {
                 {
@@ -202,8 +378,66 @@ namespace rcp
             }
         }
 
+        void on_socket_init(connection_hdl /*hdl*/, asio::ip::tcp::socket& socket)
+        {
+            socket_options().apply(socket);
+        }
+
+        bool on_validate(connection_hdl hdl)
+        {
+            websocketpp::lib::error_code ec;
+            server::connection_ptr con = m_server.get_con_from_hdl(hdl, ec);
+            if (ec || !con)
+            {
+                return false;
+            }
+
+            if (!_admit_rate(con))
+            {
+                m_rejected_limited++;
+                con->set_status(websocketpp::http::status_code::too_many_requests);
+                return false;
+            }
+
+            if (!_reserve_slot())
+            {
+                m_rejected_full++;
+                con->set_status(websocketpp::http::status_code::service_unavailable);
+                return false;
+            }
+            con->admitted = true;
+
+            if (!validate(hdl))
+            {
+                _release(hdl);
+                return false;
+            }
+
+            return true;
+        }
+
+        void on_fail(connection_hdl hdl)
+        {
+            _release(hdl);
+            handshake_failed(hdl);
+        }
+
         void on_open(connection_hdl hdl)
         {
+            websocketpp::lib::error_code ec;
+            server::connection_ptr con = m_server.get_con_from_hdl(hdl, ec);
+            if (con)
+            {
+                con->openTime = std::chrono::steady_clock::now();
+                con->lastSeen = _now_us();
+            }
+
+            if (_dispatch_direct())
+            {
+                _dispatch(action(SUBSCRIBE,hdl));
+                return;
+            }
+
             {
                 lock_guard<mutex> guard(m_action_lock);
                 //std::cout << "on_open" << std::endl;
@@ -214,6 +448,15 @@ namespace rcp
 
         void on_close(connection_hdl hdl)
         {
+            _release(hdl);
+            m_sender.remove(hdl);
+
+            if (_dispatch_direct())
+            {
+                _dispatch(action(UNSUBSCRIBE,hdl));
+                return;
+            }
+
             {
                 lock_guard<mutex> guard(m_action_lock);
                 //std::cout << "on_close" << std::endl;
@@ -224,6 +467,22 @@ namespace rcp
 
         void on_message(connection_hdl hdl, server::message_ptr msg)
         {
+            websocketpp::lib::error_code ec;
+            server::connection_ptr con = m_server.get_con_from_hdl(hdl, ec);
+            if (con)
+            {
+                con->bytesIn += msg->get_payload().size();
+                con->messagesIn++;
+                con->lastSeen = _now_us();
+            }
+
+            if (_dispatch_direct())
+            {
+                // already on the main thread or dispatching on the io thread
+                _dispatch(action(MESSAGE,hdl,msg));
+                return;
+            }
+
             // queue message up for sending by processing thread
             {
                 lock_guard<mutex> guard(m_action_lock);
@@ -235,8 +494,6 @@ namespace rcp
 
         void process_messages()
         {
-            m_run = true;
-
             while(m_run)
             {
                 unique_lock<mutex> lock(m_action_lock);
@@ -257,64 +514,451 @@ namespace rcp
 
                 lock.unlock();
 
-                if (a.type == SUBSCRIBE)
-                {
-                    lock_guard<mutex> guard(m_connection_lock);
-                    m_connections.insert(a.hdl);
+                _dispatch(a);
+            }
 
-                    connected(nullptr);
-                }
-                else if (a.type == UNSUBSCRIBE)
+            // done
+        }
+
+        virtual void handle_action(const action& a)
+        {
+            if (a.type == SUBSCRIBE)
+            {
+                _publish_add(a.hdl);
+
+                connected(nullptr);
+            }
+            else if (a.type == UNSUBSCRIBE)
+            {
+                _publish_remove(a.hdl);
+
+                disconnected(nullptr);
+            }
+            else if (a.type == MESSAGE)
+            {
+                if (a.msg->get_opcode() == websocketpp::frame::opcode::value::binary)
                 {
-                    lock_guard<mutex> guard(m_connection_lock);
-                    m_connections.erase(a.hdl);
+                    if (auto ptr = a.hdl.lock())
+                    {
+                        const std::string & data = a.msg->get_raw_payload();
 
-                    disconnected(nullptr);
+                        received(const_cast<char*>(data.data()), data.size(), ptr.get());
+                    }
                 }
-                else if (a.type == MESSAGE)
+                else
                 {
-                    lock_guard<mutex> guard(m_connection_lock);
+                    received_text(a.hdl, a.msg->get_payload());
+                }
 
-                    if (a.msg->get_opcode() == websocketpp::frame::opcode::value::binary)
-                    {
-                        if (auto ptr = a.hdl.lock())
-                        {
-                            const std::string & data = a.msg->get_raw_payload();
+            } else {
+                // undefined.
+            }
+        }
 
-                            received(const_cast<char*>(data.data()), data.size(), ptr.get());
-                        }
-                    }
-                    else
-                    {
-                        // got text message
-                        std::cout << "websocket: got text message: " << a.msg->get_payload() << std::endl;
-                    }
+        virtual void received_text(connection_hdl /*hdl*/, const std::string& msg)
+        {
+            // got text message
+            std::cout << "websocket: got text message: " << msg << std::endl;
+        }
+
+        // hand binary data received outside of websocketpp (e.g. udp)
+        // to the same path as websocket messages
+        void queue_received(connection_hdl hdl, const char* data, size_t size)
+        {
+            server::message_ptr msg = websocketpp::lib::make_shared<server::message_type>(server::message_type::con_msg_man_ptr(), websocketpp::frame::opcode::binary, size);
+            msg->set_payload(data, size);
+
+            on_message(hdl, msg);
+        }
+
+        // small packets go out immediately, bulk packets are paced
+        void sendTo(connection_hdl hdl, const char* data, size_t size)
+        {
+            websocketpp::lib::error_code ec;
+            server::connection_ptr con = m_server.get_con_from_hdl(hdl, ec);
+            if (con)
+            {
+                con->bytesOut += size;
+                con->messagesOut++;
+            }
+
+            m_sender.send(hdl, data, size);
+        }
 
-                } else {
-                    // undefined.
+        // ping all connections - round trip times show up in connection_stats
+        void ping_all()
+        {
+            // payload: send time in microseconds
+            std::string payload = std::to_string(_now_us());
+
+            con_list_ptr connections = connections_snapshot();
+            for (const con_entry& conn : *connections)
+            {
+                websocketpp::lib::error_code ec;
+                server::connection_ptr con = m_server.get_con_from_hdl(conn.hdl, ec);
+                if (con)
+                {
+                    con->ping(payload, ec);
                 }
             }
+        }
 
-            // done
+        void on_pong(connection_hdl hdl, std::string payload)
+        {
+            websocketpp::lib::error_code ec;
+            server::connection_ptr con = m_server.get_con_from_hdl(hdl, ec);
+            if (!con)
+            {
+                return;
+            }
+
+            int64_t now = _now_us();
+            con->lastSeen = now;
+
+            int64_t sent = std::strtoll(payload.c_str(), nullptr, 10);
+            if (sent > 0)
+            {
+                con->rtt = now - sent;
+            }
+        }
+
+        // snapshot of all open connections
+        void connection_stats(std::vector<ConnectionInfo>& out)
+        {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+            con_list_ptr connections = connections_snapshot();
+            out.reserve(out.size() + connections->size());
+
+            for (const con_entry& conn : *connections)
+            {
+                websocketpp::lib::error_code ec;
+                server::connection_ptr con = m_server.get_con_from_hdl(conn.hdl, ec);
+                if (!con)
+                {
+                    continue;
+                }
+
+                ConnectionInfo info;
+                info.address = con->get_remote_endpoint();
+                int64_t rtt = con->rtt;
+                info.rtt = rtt < 0 ? -1 : rtt / 1000.0;
+                info.bytesIn = con->bytesIn;
+                info.bytesOut = con->bytesOut;
+                info.messagesIn = con->messagesIn;
+                info.messagesOut = con->messagesOut;
+                info.buffered = con->get_buffered_amount();
+                info.connected = std::chrono::duration<double>(now - con->openTime).count();
+
+                out.push_back(info);
+            }
         }
 
     protected:
-        typedef std::set<connection_hdl, std::owner_less<connection_hdl> > con_list;
+        struct con_entry {
+            connection_hdl hdl;
+            // raw connection pointer - the client id
+            void* id;
+        };
+
+        typedef std::vector<con_entry> con_list;
+        typedef std::shared_ptr<const con_list> con_list_ptr;
+
+        // snapshot of open connections - iterate without locking.
+        // membership changes publish a new list, a snapshot never changes.
+        con_list_ptr connections_snapshot() const
+        {
+            return std::atomic_load(&m_connections);
+        }
+
+        // accept or refuse a connection before the upgrade completes.
+        // set a http status on the connection when refusing
+        virtual bool validate(connection_hdl /*hdl*/) { return true; }
+        // validated, but the handshake did not complete
+        virtual void handshake_failed(connection_hdl /*hdl*/) {}
 
-        con_list m_connections;
         server m_server;
         uint16_t m_port;
 
     private:
+        void _dispatch(const action& a)
+        {
+            // NOTE: no lock when polled - events run on the main thread
+            // which may dispose us from within handle_action (Poller::release)
+            unique_lock<mutex> guard(m_dispatch_lock, std::defer_lock);
+            if (!m_polled)
+            {
+                guard.lock();
+            }
+
+            if (m_detached)
+            {
+                return;
+            }
+
+            handle_action(a);
+        }
+
+        void _socketerror(const char* reason)
+        {
+            unique_lock<mutex> guard(m_dispatch_lock, std::defer_lock);
+            if (!m_polled)
+            {
+                guard.lock();
+            }
+
+            if (!m_detached)
+            {
+                socketerror(reason);
+            }
+        }
+
+        // token bucket per remote address
+        bool _admit_rate(server::connection_ptr con)
+        {
+            lock_guard<mutex> guard(m_admission_lock);
+
+            if (m_connect_rate <= 0)
+            {
+                return true;
+            }
+
+            websocketpp::lib::error_code ec;
+            asio::ip::tcp::endpoint remote = con->get_raw_socket().remote_endpoint(ec);
+            if (ec)
+            {
+                return false;
+            }
+
+            int64_t now = _now_us();
+            double burst = m_connect_rate < 1 ? 1 : m_connect_rate;
+
+            if (m_buckets.size() > 1024)
+            {
+                // forget addresses with a full bucket again
+                for (auto it = m_buckets.begin(); it != m_buckets.end();)
+                {
+                    double tokens = it->second.tokens + (now - it->second.time) / 1000000.0 * m_connect_rate;
+                    it = tokens >= burst ? m_buckets.erase(it) : std::next(it);
+                }
+            }
+
+            auto result = m_buckets.emplace(remote.address().to_string(), bucket{burst, now});
+            bucket& b = result.first->second;
+
+            b.tokens = std::min(burst, b.tokens + (now - b.time) / 1000000.0 * m_connect_rate);
+            b.time = now;
+
+            if (b.tokens < 1)
+            {
+                return false;
+            }
+
+            b.tokens -= 1;
+            return true;
+        }
+
+        // NOTE: validate may run on several io threads at once
+        bool _reserve_slot()
+        {
+            uint32_t max_clients = m_max_clients;
+            uint32_t admitted = m_admitted;
+
+            do
+            {
+                if (max_clients > 0 &&
+                        admitted >= max_clients)
+                {
+                    return false;
+                }
+            } while (!m_admitted.compare_exchange_weak(admitted, admitted + 1));
+
+            return true;
+        }
+
+        void _release(connection_hdl hdl)
+        {
+            websocketpp::lib::error_code ec;
+            server::connection_ptr con = m_server.get_con_from_hdl(hdl, ec);
+            if (con &&
+                    con->admitted.exchange(false))
+            {
+                m_admitted--;
+            }
+        }
+
+        void _keepalive_schedule()
+        {
+            lock_guard<mutex> guard(m_keepalive_lock);
+
+            if (m_keepalive_timer)
+            {
+                m_keepalive_timer->cancel();
+                m_keepalive_timer.reset();
+            }
+
+            uint32_t interval = m_keepalive_interval;
+            if (interval > 0 &&
+                    !m_server.stopped())
+            {
+                m_keepalive_timer = m_server.set_timer(interval, bind(&websocketServer::_keepalive, this, ::_1));
+            }
+        }
+
+        void _keepalive(const websocketpp::lib::error_code& ec)
+        {
+            if (ec ||
+                    m_keepalive_interval == 0)
+            {
+                // cancelled or switched off
+                return;
+            }
+
+            // the timer runs on any io thread - check each connection
+            // on its own strand (on_interrupt)
+            con_list_ptr connections = connections_snapshot();
+            for (const con_entry& conn : *connections)
+            {
+                websocketpp::lib::error_code e;
+                server::connection_ptr con = m_server.get_con_from_hdl(conn.hdl, e);
+                if (con)
+                {
+                    con->interrupt();
+                }
+            }
+
+            _keepalive_schedule();
+        }
+
+        // connection strand - never concurrent with other handlers of this connection
+        void on_interrupt(connection_hdl hdl)
+        {
+            if (m_keepalive_interval == 0)
+            {
+                return;
+            }
+
+            websocketpp::lib::error_code e;
+            server::connection_ptr con = m_server.get_con_from_hdl(hdl, e);
+            if (!con)
+            {
+                return;
+            }
+
+            int64_t now = _now_us();
+            int64_t interval = int64_t(m_keepalive_interval) * 1000;
+            int64_t timeout = int64_t(m_keepalive_timeout) * 1000;
+            int64_t silent = now - con->lastSeen;
+
+            if (con->get_state() == websocketpp::session::state::closing)
+            {
+                if (silent > 2 * interval + timeout)
+                {
+                    // closing handshake stuck behind a full send buffer
+                    con->get_raw_socket().close(e);
+                }
+            }
+            else if (con->get_state() == websocketpp::session::state::open)
+            {
+                if (silent > interval + timeout)
+                {
+                    // vanished peer - on_close unsubscribes it
+                    con->close(websocketpp::close::status::going_away, "ping timeout", e);
+                }
+                else if (silent >= interval)
+                {
+                    // idle - everything received counts as alive
+                    con->ping(std::to_string(now), e);
+                }
+            }
+        }
+
+        static int64_t _now_us()
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        bool _dispatch_direct() const
+        {
+            // no service thread
+            return m_polled || m_direct;
+        }
+
+        void _publish_add(connection_hdl hdl)
+        {
+            // writers are serialized, readers never block
+            lock_guard<mutex> guard(m_connection_lock);
+
+            con_list_ptr current = std::atomic_load(&m_connections);
+
+            std::shared_ptr<con_list> list = std::make_shared<con_list>(*current);
+            list->push_back(con_entry{hdl, hdl.lock().get()});
+
+            std::atomic_store(&m_connections, con_list_ptr(list));
+        }
+
+        void _publish_remove(connection_hdl hdl)
+        {
+            lock_guard<mutex> guard(m_connection_lock);
+
+            con_list_ptr current = std::atomic_load(&m_connections);
+
+            std::shared_ptr<con_list> list = std::make_shared<con_list>();
+            list->reserve(current->size());
+
+            std::owner_less<connection_hdl> less;
+            for (const con_entry& entry : *current)
+            {
+                if (less(entry.hdl, hdl) || less(hdl, entry.hdl))
+                {
+                    list->push_back(entry);
+                }
+            }
+
+            std::atomic_store(&m_connections, con_list_ptr(list));
+        }
+
+    private:
+        con_list_ptr m_connections;
+
         std::queue<action> m_actions;
 
         mutex m_action_lock;
         mutex m_connection_lock;
+        mutex m_dispatch_lock;
+        bool m_detached{false};
+        mutex m_socket_lock;
+        SocketOptions m_socket_options;
+        // milliseconds
+        std::atomic<uint32_t> m_keepalive_interval{0};
+        std::atomic<uint32_t> m_keepalive_timeout{0};
+        mutex m_keepalive_lock;
+        server::timer_ptr m_keepalive_timer;
+
+        // admission control
+        struct bucket {
+            double tokens;
+            int64_t time;
+        };
+
+        std::atomic<uint32_t> m_max_clients{0};
+        std::atomic<uint32_t> m_admitted{0};
+        std::atomic<uint64_t> m_rejected_full{0};
+        std::atomic<uint64_t> m_rejected_limited{0};
+        mutex m_admission_lock;
+        float m_connect_rate{0};
+        std::map<std::string, bucket> m_buckets;
         condition_variable m_action_cond;
 
         websocketpp::lib::thread *ws_thread;
         websocketpp::lib::thread *server_thread;
+        std::vector<websocketpp::lib::thread*> m_io_threads;
+        unsigned m_threads{1};
         std::atomic_bool m_run;
+        bool m_polled;
+        bool m_direct{false};
+
+        PrioritySender<server> m_sender;
     };
 
 }
@@ -0,0 +1,167 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+/*
+ * per message latency from the client's send to the server's received()
+ * (websocketServer::setDirect)
+ *
+ * a client sends an 11 byte UPDATEVALUE every millisecond carrying its
+ * send time.
+ * queued: on_message queues the event and wakes the service thread.
+ * direct: on_message hands it to received() on the io thread.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// NOTE: needed to figure out ASIO_STANDALONE before including websocketpp
+#include <asio.hpp>
+
+#include <websocketpp/client.hpp>
+
+#include "websocketServer.h"
+#include "TestUtil.h"
+
+using namespace rcp;
+
+typedef websocketpp::client<rcp::config::asio_client> client;
+
+static const int MESSAGES = 2000;
+static const int TICK_US = 1000;
+
+class LatencyServer : public websocketServer
+{
+public:
+    std::atomic<int> clients{0};
+    std::vector<double> latencies;
+    std::mutex latency_lock;
+
+    void connected(void*) override { clients++; }
+    void disconnected(void*) override { clients--; }
+
+    void received(char* data, size_t size, void*) override
+    {
+        if (size != 11)
+        {
+            return;
+        }
+
+        int64_t sent;
+        std::memcpy(&sent, data + 3, sizeof(sent));
+
+        std::lock_guard<std::mutex> guard(latency_lock);
+        latencies.push_back((test::nowUs() - sent) / 1000.0);
+    }
+};
+
+static uint16_t freePort()
+{
+    asio::io_service io;
+    asio::ip::tcp::acceptor acceptor(io, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    return acceptor.local_endpoint().port();
+}
+
+static std::vector<double> run(bool direct)
+{
+    LatencyServer srv;
+    srv.setDirect(direct);
+
+    uint16_t port = freePort();
+    srv.run(port);
+
+    client cl;
+    cl.init_asio();
+
+    // the listener comes up on its own thread
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    websocketpp::lib::error_code ec;
+    client::connection_ptr con = cl.get_connection("ws://127.0.0.1:" + std::to_string(port), ec);
+    test::check(!ec, "client connection: " + ec.message());
+    cl.connect(con);
+    websocketpp::connection_hdl hdl = con->get_handle();
+    std::thread client_thread([&]() { cl.run(); });
+
+    for (int i=0; i<500 && srv.clients == 0; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    test::check(srv.clients == 1, "client did not connect");
+
+    char msg[11];
+    msg[0] = COMMAND_UPDATEVALUE;
+    msg[1] = 0;
+    msg[2] = 1;
+
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+    for (int i=0; i<MESSAGES; i++)
+    {
+        int64_t now = test::nowUs();
+        std::memcpy(msg + 3, &now, sizeof(now));
+
+        cl.send(hdl, msg, sizeof(msg), websocketpp::frame::opcode::binary, ec);
+
+        next += std::chrono::microseconds(TICK_US);
+        std::this_thread::sleep_until(next);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    cl.stop();
+    client_thread.join();
+    srv.stop();
+
+    std::lock_guard<std::mutex> guard(srv.latency_lock);
+    return srv.latencies;
+}
+
+int main()
+{
+    std::vector<double> queued = run(false);
+    std::vector<double> direct = run(true);
+
+    test::report("queued (service thread)", queued, "ms");
+    test::report("direct (io thread)", direct, "ms");
+
+    test::check(queued.size() == (size_t)MESSAGES, "messages lost in queued mode");
+    test::check(direct.size() == (size_t)MESSAGES, "messages lost in direct mode");
+
+    return 0;
+}
@@ -0,0 +1,262 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+/*
+ * latency of small packets while a bulk transfer runs (PrioritySender)
+ *
+ * the server streams 32KB UPDATE packets faster than the client drains them
+ * (the client emulates a slow link by sleeping per received byte) and sends
+ * an 11 byte UPDATEVALUE every 2ms carrying its send time.
+ * fifo: everything goes straight to websocketpp and queues behind the bulk
+ * backlog. priority: bulk is paced, small packets overtake it.
+ *
+ * the bulk stream updates another parameter. one bulk UPDATE of the small
+ * packets' parameter is queued first: the small packets must not overtake it.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+// NOTE: needed to figure out ASIO_STANDALONE before including websocketpp
+#include <asio.hpp>
+
+#include <websocketpp/server.hpp>
+#include <websocketpp/client.hpp>
+
+#include "WebsocketConfig.h"
+#include "PrioritySender.h"
+#include "TestUtil.h"
+
+using namespace rcp;
+
+typedef websocketpp::server<rcp::config::asio> server;
+typedef websocketpp::client<rcp::config::asio_client> client;
+
+// emulated link speed of the client in bytes per second
+static const double LINK_RATE = 8 * 1024 * 1024;
+static const size_t BULK_SIZE = 32 * 1024;
+// socket buffers - keep the kernel from hiding the backlog
+static const int SOCKET_BUFFER = 16 * 1024;
+static const int RUN_MS = 2000;
+static const int TICK_MS = 2;
+
+static const int16_t SMALL_ID = 1;
+static const int16_t BULK_ID = 1000;
+
+// [UPDATE][PACKET_OPTIONS_DATA][id][id][type][send time]...
+static std::string bulkUpdate(int16_t id, size_t size)
+{
+    std::string bulk(size, 'x');
+    bulk[0] = COMMAND_UPDATE;
+    bulk[1] = PACKET_OPTIONS_DATA;
+    bulk[2] = (char)((uint16_t)id >> 8);
+    bulk[3] = (char)(id & 0xff);
+    bulk[4] = DATATYPE_STRING;
+    bulk[size - 1] = RCP_TERMINATOR;
+    return bulk;
+}
+
+// send time of our packets: small ones carry it at 3, bulk ones at 5
+static int64_t sendTime(const std::string& payload)
+{
+    int64_t sent;
+    std::memcpy(&sent, payload.data() + (payload[0] == COMMAND_UPDATE ? 5 : 3), sizeof(sent));
+    return sent;
+}
+
+static std::vector<double> run(bool prioritized)
+{
+    server srv;
+    client cl;
+    PrioritySender<server> sender(srv);
+
+    std::atomic<bool> open{false};
+    websocketpp::connection_hdl server_hdl;
+    std::vector<double> latencies;
+    std::mutex latency_lock;
+    int64_t lastSmallIdTime = 0;
+    int reordered = 0;
+
+    srv.init_asio();
+    srv.set_reuse_addr(true);
+    srv.set_socket_init_handler([](websocketpp::connection_hdl, asio::ip::tcp::socket& s) {
+        s.set_option(asio::socket_base::send_buffer_size(SOCKET_BUFFER));
+        s.set_option(asio::ip::tcp::no_delay(true));
+    });
+    srv.set_open_handler([&](websocketpp::connection_hdl hdl) {
+        server_hdl = hdl;
+        open = true;
+    });
+    srv.listen(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    srv.start_accept();
+
+    asio::error_code aec;
+    uint16_t port = srv.get_local_endpoint(aec).port();
+    std::thread server_thread([&]() { srv.run(); });
+
+    cl.init_asio();
+    cl.set_socket_init_handler([](websocketpp::connection_hdl, asio::ip::tcp::socket& s) {
+        s.set_option(asio::socket_base::receive_buffer_size(SOCKET_BUFFER));
+    });
+    cl.set_message_handler([&](websocketpp::connection_hdl, client::message_ptr msg) {
+        const std::string& payload = msg->get_payload();
+
+        if (PrioritySender<server>::parameterId(payload.data(), payload.size()) == SMALL_ID)
+        {
+            int64_t sent = sendTime(payload);
+
+            std::lock_guard<std::mutex> guard(latency_lock);
+
+            // packets of one parameter arrive in send order
+            if (sent < lastSmallIdTime)
+            {
+                reordered++;
+            }
+            lastSmallIdTime = sent;
+
+            if (payload.size() == 11)
+            {
+                latencies.push_back((test::nowUs() - sent) / 1000.0);
+            }
+        }
+
+        // slow link
+        std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(payload.size() / LINK_RATE * 1000000)));
+    });
+
+    websocketpp::lib::error_code ec;
+    client::connection_ptr con = cl.get_connection("ws://127.0.0.1:" + std::to_string(port), ec);
+    test::check(!ec, "client connection: " + ec.message());
+    cl.connect(con);
+    std::thread client_thread([&]() { cl.run(); });
+
+    for (int i=0; i<500 && !open; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    test::check(open, "connection did not open");
+
+    std::string bulk = bulkUpdate(BULK_ID, BULK_SIZE);
+    std::string sameIdBulk = bulkUpdate(SMALL_ID, BULK_SIZE);
+
+    char small[11];
+    small[0] = COMMAND_UPDATEVALUE;
+    small[1] = (char)((uint16_t)SMALL_ID >> 8);
+    small[2] = (char)(SMALL_ID & 0xff);
+
+    auto sendBulk = [&](const std::string& data) {
+        if (prioritized)
+        {
+            sender.send(server_hdl, data.data(), data.size());
+        }
+        else
+        {
+            sender.send(server_hdl, data.data(), data.size(), PrioritySender<server>::PRIORITY_HIGH);
+        }
+    };
+
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+    for (int t=0; t<RUN_MS; t+=TICK_MS)
+    {
+        // 16MB/s of bulk data against an 8MB/s link
+        sendBulk(bulk);
+
+        int64_t now = test::nowUs();
+
+        if (t == 0)
+        {
+            // queued behind the first bulk packet - the small ones must wait for it
+            std::memcpy(&sameIdBulk[5], &now, sizeof(now));
+            sendBulk(sameIdBulk);
+        }
+
+        std::memcpy(small + 3, &now, sizeof(now));
+        sender.send(server_hdl, small, sizeof(small));
+
+        next += std::chrono::milliseconds(TICK_MS);
+        std::this_thread::sleep_until(next);
+    }
+
+    // let the last small packets arrive - the fifo backlog is not waited for
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    sender.clear();
+    cl.stop();
+    srv.stop();
+    client_thread.join();
+    server_thread.join();
+
+    std::lock_guard<std::mutex> guard(latency_lock);
+    test::check(reordered == 0, std::to_string(reordered) + " packets overtook an earlier packet of their parameter");
+    return latencies;
+}
+
+int main()
+{
+    // ids behind the packet options
+    {
+        const char update[] = {COMMAND_UPDATE, PACKET_OPTIONS_DATA, 0x03, (char)0xe8, DATATYPE_INT32};
+        test::check(PrioritySender<server>::parameterId(update, sizeof(update)) == 1000, "update id");
+
+        const char timestamped[] = {COMMAND_REMOVE, PACKET_OPTIONS_TIMESTAMP, 0, 0, 0, 0, 0, 0, 0, 1, PACKET_OPTIONS_DATA, 0x00, 0x07};
+        test::check(PrioritySender<server>::parameterId(timestamped, sizeof(timestamped)) == 7, "timestamped remove id");
+
+        const char truncated[] = {COMMAND_UPDATE, PACKET_OPTIONS_TIMESTAMP, 0, 0};
+        test::check(PrioritySender<server>::parameterId(truncated, sizeof(truncated)) == -1, "truncated update");
+
+        const char value[] = {COMMAND_UPDATEVALUE, 0x00, 0x01, DATATYPE_FLOAT32, 0, 0, 0, 0};
+        test::check(PrioritySender<server>::parameterId(value, sizeof(value)) == 1, "updatevalue id");
+    }
+
+    std::vector<double> fifo = run(false);
+    std::vector<double> prio = run(true);
+
+    test::report("fifo (one lane)", fifo, "ms");
+    test::report("priority lanes", prio, "ms");
+
+    test::check(prio.size() > (size_t)(RUN_MS / TICK_MS) * 9 / 10, "small packets lost in priority mode");
+
+    // fifo packets stuck behind the backlog never arrive - count them as worst case
+    double fifo_p99 = fifo.size() < prio.size() ? 1e9 : test::percentile(fifo, 0.99);
+    double prio_p99 = test::percentile(prio, 0.99);
+
+    test::check(prio_p99 * 4 < fifo_p99, "p99 latency did not improve");
+
+    return 0;
+}
@@ -0,0 +1,266 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+/*
+ * shared memory channel between a server and a client in one process (ShmChannel)
+ *
+ * order: frames of all sizes arrive complete and in order, also across the
+ * end of the ring.
+ * full ring: while the reader is stuck, send() returns right away. the
+ * client is dropped instead of losing packets: both sides see the disconnect,
+ * nothing is sent until the client connected again.
+ * corrupt frame: a size header larger than what was published resets the
+ * ring instead of reading past it, later frames get through.
+ *
+ * the segment layout is private to ShmChannel.cpp - it is compiled in here.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../sources/ShmChannel.cpp"
+#include "TestUtil.h"
+
+using namespace rcp;
+
+struct Received
+{
+    std::mutex lock;
+    std::condition_variable cond;
+    std::vector<std::string> frames;
+
+    void add(const char* data, size_t size)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        frames.push_back(std::string(data, size));
+        cond.notify_all();
+    }
+
+    bool waitFor(size_t count)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        return cond.wait_for(guard, std::chrono::seconds(5), [&]() { return frames.size() >= count; });
+    }
+};
+
+static std::string frame(int n, size_t size)
+{
+    std::string s(size, (char)('a' + n % 26));
+    std::memcpy(&s[0], &n, std::min(sizeof(n), size));
+    return s;
+}
+
+static void testOrder(const std::string& name)
+{
+    ShmChannel server(ShmChannel::SERVER);
+    ShmChannel client(ShmChannel::CLIENT);
+    Received received;
+
+    server.setReceiveHandler([&](const char* data, size_t size) { received.add(data, size); });
+
+    test::check(server.open(name), "server open");
+    test::check(client.open(name), "client open");
+
+    // more than the ring holds in total - frames wrap around its end
+    std::vector<std::string> sent;
+    size_t total = 0;
+    for (int i=0; total < 3 * RCP_SHM_RING_SIZE; i++)
+    {
+        std::string f = frame(i, 4 + (i * 7919) % 5000);
+        while (!client.send(f.data(), f.size()))
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        sent.push_back(f);
+        total += f.size();
+    }
+
+    test::check(received.waitFor(sent.size()), "frames missing");
+
+    std::lock_guard<std::mutex> guard(received.lock);
+    test::check(received.frames == sent, "frames differ");
+}
+
+static void testFullRing(const std::string& name)
+{
+    ShmChannel server(ShmChannel::SERVER);
+    ShmChannel client(ShmChannel::CLIENT);
+
+    std::mutex stuck;
+    std::unique_lock<std::mutex> stuck_guard(stuck);
+    std::atomic<int> received{0};
+    std::atomic<int> server_connects{0};
+    std::atomic<int> server_disconnects{0};
+    std::atomic<int> client_disconnects{0};
+
+    server.setReceiveHandler([&](const char*, size_t) {
+        std::lock_guard<std::mutex> guard(stuck);
+        received++;
+    });
+    server.setStateHandler([&](bool connected) {
+        if (connected) server_connects++;
+        else server_disconnects++;
+    });
+    client.setStateHandler([&](bool connected) {
+        if (!connected) client_disconnects++;
+    });
+
+    test::check(server.open(name), "server open");
+    test::check(client.open(name), "client open");
+
+    std::string f = frame(1, 60000);
+    int accepted = 0;
+    int dropped = 0;
+    std::vector<double> times;
+
+    for (int i=0; i<200; i++)
+    {
+        int64_t start = test::nowUs();
+        bool ok = client.send(f.data(), f.size());
+        times.push_back((test::nowUs() - start) / 1000.0);
+
+        if (ok) accepted++;
+        else dropped++;
+    }
+
+    stuck_guard.unlock();
+
+    test::report("send into a full ring", times, "ms");
+
+    test::check(dropped > 0, "ring never filled up");
+    test::check(test::percentile(times, 1.0) < 5, "send blocked on a full ring");
+
+    for (int i=0; i<500 && received < accepted; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    test::check(received == accepted, "accepted frames missing");
+
+    // the client lost a packet: no gap, it is out
+    for (int i=0; i<500 && (server_disconnects == 0 || client_disconnects == 0); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    test::check(server_disconnects == 1, "server did not see the client go");
+    test::check(client_disconnects == 1, "client did not see it was dropped");
+    test::check(!client.send(f.data(), f.size()), "send after overflow");
+
+    // connect again and everything goes through
+    int connects = server_connects;
+    test::check(client.open(name), "client reopen");
+    for (int i=0; i<500 && server_connects == connects; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    test::check(server_connects == connects + 1, "server did not see the client again");
+
+    int before = received;
+    test::check(client.send(f.data(), f.size()), "send after reconnect");
+    for (int i=0; i<500 && received == before; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    test::check(received == before + 1, "frame after reconnect missing");
+}
+
+static void testCorruptFrame(const std::string& name)
+{
+    ShmChannel server(ShmChannel::SERVER);
+    ShmChannel client(ShmChannel::CLIENT);
+    Received received;
+
+    server.setReceiveHandler([&](const char* data, size_t size) { received.add(data, size); });
+
+    test::check(server.open(name), "server open");
+    test::check(client.open(name), "client open");
+
+    // a misbehaving peer: map the segment and publish a bogus size header
+    int fd = shm_open(("/rcp-" + name).c_str(), O_RDWR, 0600);
+    test::check(fd >= 0, "shm_open");
+    size_t size = sizeof(ShmSegment) + 2 * RCP_SHM_RING_SIZE;
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    test::check(p != MAP_FAILED, "mmap");
+    ShmSegment* segment = static_cast<ShmSegment*>(p);
+    ShmRing& ring = segment->toServer;
+    char* data = ringData(segment, false);
+
+    const uint32_t mask = RCP_SHM_RING_SIZE - 1;
+    uint32_t head = ring.head.load();
+    uint32_t bogus = 0x7fffffff;
+    for (size_t i=0; i<sizeof(bogus); i++)
+    {
+        data[(head + i) & mask] = reinterpret_cast<char*>(&bogus)[i];
+    }
+    for (size_t i=sizeof(bogus); i<16; i++)
+    {
+        data[(head + i) & mask] = 0;
+    }
+    ring.head.store(head + 16);
+    ring.wake.fetch_add(1);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&ring.wake), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+
+    for (int i=0; i<500 && ring.tail.load() != ring.head.load(); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    test::check(ring.tail.load() == ring.head.load(), "corrupt frame was not dropped");
+
+    munmap(p, size);
+    ::close(fd);
+
+    std::string f = frame(2, 100);
+    test::check(client.send(f.data(), f.size()), "send after reset");
+    test::check(received.waitFor(1), "frame after reset missing");
+
+    std::lock_guard<std::mutex> guard(received.lock);
+    test::check(received.frames.size() == 1 && received.frames[0] == f, "garbage was delivered");
+}
+
+int main()
+{
+    std::string name = "test-" + std::to_string(getpid());
+
+    testOrder(name);
+    testFullRing(name);
+    testCorruptFrame(name);
+
+    return 0;
+}
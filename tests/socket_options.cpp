@@ -0,0 +1,164 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+/*
+ * socket options on loopback tcp sockets (SocketOptions)
+ *
+ * options: what apply() sets is read back with getsockopt.
+ * nodelay: round trip of a request written in two pieces (header, body)
+ * and a one byte reply. without TCP_NODELAY the second write waits for
+ * the ack of the first one, which the peer delays.
+ */
+
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+#include "SocketOptions.h"
+#include "TestUtil.h"
+
+using namespace rcp;
+
+static const int ROUNDS = 50;
+
+static int getOption(asio::ip::tcp::socket& socket, int level, int name)
+{
+    int value = 0;
+    socklen_t size = sizeof(value);
+    ::getsockopt(socket.native_handle(), level, name, &value, &size);
+    return value;
+}
+
+static void connectPair(asio::io_service& io, asio::ip::tcp::socket& a, asio::ip::tcp::socket& b)
+{
+    asio::ip::tcp::acceptor acceptor(io, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    a.connect(acceptor.local_endpoint());
+    acceptor.accept(b);
+}
+
+static void testOptions()
+{
+    asio::io_service io;
+    asio::ip::tcp::socket a(io);
+    asio::ip::tcp::socket b(io);
+    connectPair(io, a, b);
+
+    SocketOptions options;
+    options.noDelay = true;
+    options.sendBuffer = 64 * 1024;
+    options.receiveBuffer = 96 * 1024;
+    options.tos = 0x10 << 2;
+    options.apply(a);
+
+    test::check(getOption(a, IPPROTO_TCP, TCP_NODELAY) != 0, "TCP_NODELAY not set");
+    // the system may round up (linux doubles the value)
+    test::check(getOption(a, SOL_SOCKET, SO_SNDBUF) >= options.sendBuffer, "SO_SNDBUF not set");
+    test::check(getOption(a, SOL_SOCKET, SO_RCVBUF) >= options.receiveBuffer, "SO_RCVBUF not set");
+    test::check(getOption(a, IPPROTO_IP, IP_TOS) == options.tos, "IP_TOS not set");
+
+    options.noDelay = false;
+    options.apply(a);
+    test::check(getOption(a, IPPROTO_TCP, TCP_NODELAY) == 0, "TCP_NODELAY not cleared");
+
+    // defaults leave the system values alone
+    int sndbuf = getOption(b, SOL_SOCKET, SO_SNDBUF);
+    SocketOptions().apply(b);
+    test::check(getOption(b, SOL_SOCKET, SO_SNDBUF) == sndbuf, "SO_SNDBUF changed by default options");
+    test::check(getOption(b, IPPROTO_TCP, TCP_NODELAY) != 0, "TCP_NODELAY not on by default");
+}
+
+static std::vector<double> roundTrips(bool noDelay)
+{
+    asio::io_service io;
+    asio::ip::tcp::socket a(io);
+    asio::ip::tcp::socket b(io);
+    connectPair(io, a, b);
+
+    SocketOptions options;
+    options.noDelay = noDelay;
+    options.apply(a);
+    options.apply(b);
+
+    std::thread echo([&]() {
+        char request[2];
+        char reply = 'r';
+        asio::error_code ec;
+        for (int i=0; i<ROUNDS; i++)
+        {
+            asio::read(b, asio::buffer(request, sizeof(request)), ec);
+            asio::write(b, asio::buffer(&reply, 1), ec);
+        }
+    });
+
+    std::vector<double> times;
+    char header = 'h';
+    char body = 'b';
+    char reply;
+    for (int i=0; i<ROUNDS; i++)
+    {
+        int64_t start = test::nowUs();
+        asio::write(a, asio::buffer(&header, 1));
+        asio::write(a, asio::buffer(&body, 1));
+        asio::read(a, asio::buffer(&reply, 1));
+        times.push_back((test::nowUs() - start) / 1000.0);
+    }
+
+    echo.join();
+    return times;
+}
+
+int main()
+{
+    testOptions();
+
+    std::vector<double> nagle = roundTrips(false);
+    std::vector<double> nodelay = roundTrips(true);
+
+    test::report("round trip, nagle", nagle, "ms");
+    test::report("round trip, nodelay", nodelay, "ms");
+
+    test::check(test::percentile(nodelay, 0.5) <= test::percentile(nagle, 0.5), "nodelay is slower");
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+/*
+ * helpers shared by the tests and benchmarks
+ */
+
+#ifndef TESTUTIL_H
+#define TESTUTIL_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace rcp
+{
+namespace test
+{
+
+    inline int64_t nowUs()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // p in [0, 1] - samples get sorted
+    inline double percentile(std::vector<double>& samples, double p)
+    {
+        if (samples.empty())
+        {
+            return 0;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        size_t i = (size_t)(p * (samples.size() - 1) + 0.5);
+        return samples[std::min(i, samples.size() - 1)];
+    }
+
+    inline void report(const char* name, std::vector<double>& samples, const char* unit)
+    {
+        std::printf("%-28s n=%-7zu p50=%9.3f p99=%9.3f max=%9.3f %s\n",
+                    name,
+                    samples.size(),
+                    percentile(samples, 0.5),
+                    percentile(samples, 0.99),
+                    percentile(samples, 1.0),
+                    unit);
+    }
+
+    inline void check(bool condition, const std::string& what)
+    {
+        if (!condition)
+        {
+            std::printf("FAILED: %s\n", what.c_str());
+            std::exit(1);
+        }
+    }
+
+}
+}
+
+#endif // TESTUTIL_H
@@ -0,0 +1,172 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+/*
+ * size prefixed tcp frames on loopback (TcpConnection)
+ *
+ * frames: frames written in pieces arrive whole.
+ * slow peer: a peer that never reads gets closed once RCP_TCP_MAX_QUEUE
+ * bytes are pending, instead of growing the queue without bound.
+ */
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+
+#include "TcpConnection.h"
+#include "TestUtil.h"
+
+using namespace rcp;
+
+struct Pair
+{
+    asio::io_service io;
+    std::unique_ptr<asio::io_service::work> work;
+    std::shared_ptr<TcpConnection> connection;
+    asio::ip::tcp::socket peer;
+    std::thread thread;
+
+    Pair()
+        : work(new asio::io_service::work(io))
+        , connection(std::make_shared<TcpConnection>(io))
+        , peer(io)
+    {
+        asio::ip::tcp::acceptor acceptor(io, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+        peer.open(asio::ip::tcp::v4());
+        peer.set_option(asio::socket_base::receive_buffer_size(16 * 1024));
+        peer.connect(acceptor.local_endpoint());
+        acceptor.accept(connection->socket());
+    }
+
+    void run()
+    {
+        thread = std::thread([this]() { io.run(); });
+    }
+
+    ~Pair()
+    {
+        work.reset();
+        io.stop();
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+        connection->abort();
+    }
+};
+
+static void testFrames()
+{
+    Pair p;
+    std::mutex lock;
+    std::vector<std::string> received;
+
+    p.connection->start([&](TcpConnection*, const char* data, size_t size) {
+        std::lock_guard<std::mutex> guard(lock);
+        received.push_back(std::string(data, size));
+    }, [](TcpConnection*) {});
+    p.run();
+
+    // two frames, written byte by byte
+    std::string stream;
+    std::vector<std::string> sent = { std::string(3, 'a'), std::string(20000, 'b') };
+    for (auto& f : sent)
+    {
+        uint32_t size = (uint32_t)f.size();
+        stream += (char)(size >> 24);
+        stream += (char)(size >> 16);
+        stream += (char)(size >> 8);
+        stream += (char)size;
+        stream += f;
+    }
+    for (size_t i=0; i<stream.size(); i+=997)
+    {
+        asio::write(p.peer, asio::buffer(stream.data() + i, std::min<size_t>(997, stream.size() - i)));
+    }
+
+    for (int i=0; i<500; i++)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (received.size() >= sent.size()) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    test::check(received == sent, "frames differ");
+}
+
+static void testSlowPeer()
+{
+    Pair p;
+    std::atomic<bool> closed{false};
+
+    p.connection->start([](TcpConnection*, const char*, size_t) {},
+                        [&](TcpConnection*) { closed = true; });
+    p.run();
+
+    // the peer never reads
+    std::string frame(64 * 1024, 'x');
+    size_t sent = 0;
+    while (!closed &&
+           sent < 4 * (size_t)RCP_TCP_MAX_QUEUE)
+    {
+        p.connection->send(frame.data(), frame.size());
+        sent += frame.size();
+    }
+
+    for (int i=0; i<500 && !closed; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::printf("slow peer: closed after %zu bytes\n", sent);
+    test::check(closed, "connection to a slow peer was not closed");
+}
+
+int main()
+{
+    testFrames();
+    testSlowPeer();
+
+    return 0;
+}
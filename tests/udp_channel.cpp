@@ -0,0 +1,292 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+/*
+ * udp side channel on loopback (UdpChannel)
+ *
+ * reorder: datagrams with explicit sequence numbers arrive out of order,
+ * only newer ones per sender and parameter id get through.
+ * load: a burst of value updates - delivered values never go backwards,
+ * the loss rate is reported.
+ * lifetime: channels are closed and dropped while io threads still
+ * send and receive on them.
+ */
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <asio.hpp>
+
+#include <rcp.h>
+
+#include "UdpChannel.h"
+#include "TestUtil.h"
+
+using namespace rcp;
+
+static const int IO_THREADS = 2;
+static const int BURST = 20000;
+static const int IDS = 4;
+
+struct Received
+{
+    std::mutex lock;
+    std::vector<std::pair<int16_t, int32_t> > values;
+
+    void add(const char* data, size_t size)
+    {
+        // [command][id][id][type][int32]
+        if (size < 8)
+        {
+            return;
+        }
+
+        int16_t id = (int16_t)(((uint8_t)data[1] << 8) | (uint8_t)data[2]);
+        int32_t v = (int32_t)(((uint32_t)(uint8_t)data[4] << 24) |
+                ((uint32_t)(uint8_t)data[5] << 16) |
+                ((uint32_t)(uint8_t)data[6] << 8) |
+                (uint32_t)(uint8_t)data[7]);
+
+        std::lock_guard<std::mutex> guard(lock);
+        values.push_back(std::make_pair(id, v));
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return values.size();
+    }
+
+    std::vector<std::pair<int16_t, int32_t> > take()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::vector<std::pair<int16_t, int32_t> > v;
+        v.swap(values);
+        return v;
+    }
+};
+
+static std::string updateValue(int16_t id, int32_t v)
+{
+    std::string p(8, '\0');
+    p[0] = COMMAND_UPDATEVALUE;
+    p[1] = (char)((id >> 8) & 0xff);
+    p[2] = (char)(id & 0xff);
+    p[3] = DATATYPE_INT32;
+    p[4] = (char)((v >> 24) & 0xff);
+    p[5] = (char)((v >> 16) & 0xff);
+    p[6] = (char)((v >> 8) & 0xff);
+    p[7] = (char)(v & 0xff);
+    return p;
+}
+
+static std::string datagram(uint32_t seq, int16_t id, int32_t v)
+{
+    std::string d(4, '\0');
+    d[0] = (char)((seq >> 24) & 0xff);
+    d[1] = (char)((seq >> 16) & 0xff);
+    d[2] = (char)((seq >> 8) & 0xff);
+    d[3] = (char)(seq & 0xff);
+    return d + updateValue(id, v);
+}
+
+static void waitFor(Received& received, size_t count)
+{
+    for (int i=0; i<200 && received.size() < count; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    // anything late or unexpected
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+}
+
+int main()
+{
+    asio::io_service io;
+    asio::io_service::work work(io);
+
+    std::vector<std::thread> threads;
+    for (int i=0; i<IO_THREADS; i++)
+    {
+        threads.push_back(std::thread([&io]() { io.run(); }));
+    }
+
+    Received received;
+
+    std::shared_ptr<UdpChannel> receiver = std::make_shared<UdpChannel>(io);
+    receiver->setReceiveHandler([&received](const asio::ip::udp::endpoint&, const char* data, size_t size) {
+        received.add(data, size);
+    });
+    test::check(receiver->open(0), "open receiver");
+
+    asio::ip::udp::endpoint target(asio::ip::address_v4::loopback(), receiver->localPort());
+
+    // reorder and duplicates
+    {
+        asio::ip::udp::socket raw(io, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+
+        const uint32_t order[] = { 1, 2, 5, 3, 4, 6, 6 };
+        for (uint32_t seq : order)
+        {
+            raw.send_to(asio::buffer(datagram(seq, 1, (int32_t)seq)), target);
+            // keep the kernel from reordering for us
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        // other parameter - own sequence window
+        raw.send_to(asio::buffer(datagram(3, 2, 3)), target);
+
+        waitFor(received, 5);
+
+        std::vector<std::pair<int16_t, int32_t> > values = received.take();
+        std::vector<int32_t> id1;
+        std::vector<int32_t> id2;
+        for (auto& v : values)
+        {
+            (v.first == 1 ? id1 : id2).push_back(v.second);
+        }
+
+        test::check(id1 == std::vector<int32_t>({ 1, 2, 5, 6 }), "older and duplicate datagrams are dropped");
+        test::check(id2 == std::vector<int32_t>({ 3 }), "sequence window is per parameter");
+
+        // forgotten sender starts over
+        receiver->forget(raw.local_endpoint());
+        raw.send_to(asio::buffer(datagram(1, 1, 100)), target);
+
+        waitFor(received, 1);
+        values = received.take();
+        test::check(values.size() == 1 && values[0].second == 100, "forget resets the sequence window");
+    }
+
+    // burst through a channel
+    {
+        std::shared_ptr<UdpChannel> sender = std::make_shared<UdpChannel>(io);
+        test::check(sender->open(0), "open sender");
+
+        for (int n=1; n<=BURST; n++)
+        {
+            std::string p = updateValue((int16_t)(1 + n % IDS), n);
+            sender->send(target, p.data(), p.size());
+        }
+
+        waitFor(received, BURST);
+        sender->close();
+
+        std::vector<std::pair<int16_t, int32_t> > values = received.take();
+        std::map<int16_t, int32_t> last;
+        for (auto& v : values)
+        {
+            test::check(v.second > last[v.first], "values never go backwards");
+            last[v.first] = v.second;
+        }
+
+        test::check(!values.empty(), "burst received");
+        std::printf("burst: %d sent, %zu received, %.2f%% lost\n",
+                    BURST, values.size(), 100.0 * (BURST - (double)values.size()) / BURST);
+    }
+
+    // close and drop while io threads are busy with the channel
+    {
+        std::atomic<bool> running{true};
+        std::shared_ptr<UdpChannel> current;
+        asio::ip::udp::endpoint current_target;
+        std::mutex current_lock;
+
+        std::thread writer([&]() {
+            std::string p = updateValue(1, 1);
+            while (running)
+            {
+                std::shared_ptr<UdpChannel> c;
+                asio::ip::udp::endpoint to;
+                {
+                    std::lock_guard<std::mutex> guard(current_lock);
+                    c = current;
+                    to = current_target;
+                }
+                if (c)
+                {
+                    // sends to itself
+                    c->send(to, p.data(), p.size());
+                }
+            }
+        });
+
+        for (int i=0; i<200; i++)
+        {
+            std::shared_ptr<UdpChannel> c = std::make_shared<UdpChannel>(io);
+            c->setReceiveHandler([](const asio::ip::udp::endpoint&, const char*, size_t) {});
+            test::check(c->open(0), "open channel");
+
+            asio::ip::udp::endpoint to(asio::ip::address_v4::loopback(), c->localPort());
+
+            std::shared_ptr<UdpChannel> old;
+            {
+                std::lock_guard<std::mutex> guard(current_lock);
+                old = current;
+                current = c;
+                current_target = to;
+            }
+
+            if (old)
+            {
+                old->close();
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        running = false;
+        writer.join();
+
+        std::lock_guard<std::mutex> guard(current_lock);
+        current->close();
+        current.reset();
+    }
+
+    receiver->close();
+    receiver.reset();
+
+    io.stop();
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+
+    return 0;
+}
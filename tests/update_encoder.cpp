@@ -0,0 +1,282 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+/*
+ * background encoder for async value updates (UpdateEncoder)
+ *
+ * sets values from one thread like pd does and checks what reaches the sink:
+ * the UPDATEVALUE layout, the latest value per parameter arriving last,
+ * no bang getting lost and flush() delivering everything snapshotted before.
+ * with a transporter that filters like WebsocketServerTransporter, every
+ * value goes out once even though rcp_server_update finds it dirty.
+ */
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <rcp.h>
+#include <rcp_endian.h>
+#include <rcp_parameter.h>
+#include <rcp_server.h>
+#include <rcp_server_transporter.h>
+
+#include "UpdateEncoder.h"
+#include "TestUtil.h"
+
+using namespace rcp;
+
+static const int UPDATES = 100000;
+static const int SERVER_UPDATES = 100;
+
+// what reaches the clients: the encoder sink plus rcp_server_update
+struct Wire
+{
+    UpdateEncoder* encoder{nullptr};
+    std::vector<std::string> packets;
+    std::mutex lock;
+};
+
+static void wire_sendToOne(rcp_server_transporter*, char*, size_t, void*)
+{
+}
+
+static void wire_sendToAll(rcp_server_transporter* transporter, char* data, size_t size, void* excludeId)
+{
+    Wire* wire = (Wire*)transporter->user;
+
+    if (excludeId == NULL &&
+            wire->encoder &&
+            wire->encoder->alreadySent(data, size))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(wire->lock);
+    wire->packets.push_back(std::string(data, size));
+}
+
+static size_t countValues(Wire& wire, int16_t id)
+{
+    std::lock_guard<std::mutex> guard(wire.lock);
+
+    size_t count = 0;
+    for (const std::string& p : wire.packets)
+    {
+        if ((uint8_t)p[0] == COMMAND_UPDATEVALUE &&
+                (int16_t)(((uint8_t)p[1] << 8) | (uint8_t)p[2]) == id)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+static int16_t packetId(const std::string& packet)
+{
+    return (int16_t)(((uint8_t)packet[1] << 8) | (uint8_t)packet[2]);
+}
+
+static int32_t packetInt(const std::string& packet)
+{
+    return (int32_t)(((uint32_t)(uint8_t)packet[4] << 24) |
+            ((uint32_t)(uint8_t)packet[5] << 16) |
+            ((uint32_t)(uint8_t)packet[6] << 8) |
+            (uint32_t)(uint8_t)packet[7]);
+}
+
+int main()
+{
+    rcp_server* server = rcp_server_create(NULL);
+    test::check(server != NULL, "rcp_server_create");
+
+    rcp_parameter* f = RCP_PARAMETER(rcp_server_expose_f32(server, "f", NULL));
+    rcp_parameter* i = RCP_PARAMETER(rcp_server_expose_i32(server, "i", NULL));
+    rcp_parameter* s = RCP_PARAMETER(rcp_server_expose_string(server, "s", NULL));
+    rcp_parameter* b = RCP_PARAMETER(rcp_server_expose_bang(server, "b", NULL));
+
+    std::vector<std::string> packets;
+    std::mutex lock;
+
+    std::vector<double> snapshot_us;
+    snapshot_us.reserve(UPDATES);
+
+    {
+        UpdateEncoder encoder([&](const char* data, size_t size) {
+            std::lock_guard<std::mutex> guard(lock);
+            packets.push_back(std::string(data, size));
+        });
+
+        // layout: [command][id][id][type][value...]
+        rcp_parameter_set_value_float(RCP_VALUE_PARAMETER(f), 1.5f);
+        encoder.snapshot(f);
+        encoder.flush();
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            test::check(packets.size() == 1, "one packet after flush");
+
+            const std::string& p = packets[0];
+            test::check(p.size() == 8, "float packet size");
+            test::check((uint8_t)p[0] == COMMAND_UPDATEVALUE, "command");
+            test::check(packetId(p) == rcp_parameter_get_id(f), "id");
+            test::check((uint8_t)p[3] == DATATYPE_FLOAT32, "type");
+
+            int32_t bits = packetInt(p);
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            test::check(value == 1.5f, "float value");
+
+            packets.clear();
+        }
+
+        // like a fast slider: every value once, some bangs in between
+        int bangs = 0;
+        for (int n=1; n<=UPDATES; n++)
+        {
+            int64_t start = test::nowUs();
+
+            rcp_parameter_set_value_int32(RCP_VALUE_PARAMETER(i), n);
+            encoder.snapshot(i);
+
+            snapshot_us.push_back((double)(test::nowUs() - start));
+
+            if (n % 1000 == 0)
+            {
+                std::string text = std::to_string(n);
+                rcp_parameter_set_value_string(RCP_VALUE_PARAMETER(s), text.c_str());
+                encoder.snapshot(s);
+
+                encoder.snapshot(b);
+                bangs++;
+            }
+        }
+
+        encoder.flush();
+
+        std::lock_guard<std::mutex> guard(lock);
+
+        int32_t last_int = 0;
+        std::string last_string;
+        int received_bangs = 0;
+
+        for (const std::string& p : packets)
+        {
+            int16_t id = packetId(p);
+
+            if (id == rcp_parameter_get_id(i))
+            {
+                test::check(p.size() == 8, "int packet size");
+                int32_t v = packetInt(p);
+                test::check(v > last_int, "int values arrive in order");
+                last_int = v;
+            }
+            else if (id == rcp_parameter_get_id(s))
+            {
+                // long string: 4 byte size prefix
+                test::check(p.size() == 8 + (size_t)packetInt(p), "string packet size");
+                last_string = p.substr(8);
+            }
+            else if (id == rcp_parameter_get_id(b))
+            {
+                test::check(p.size() == 4, "bang packet size");
+                received_bangs++;
+            }
+        }
+
+        test::check(last_int == UPDATES, "latest int arrives last");
+        test::check(last_string == std::to_string(UPDATES), "latest string arrives last");
+        test::check(received_bangs == bangs, "bangs are not coalesced");
+
+        std::printf("%d int updates -> %zu packets\n", UPDATES, packets.size());
+    }
+
+    test::report("snapshot (pd thread)", snapshot_us, "us");
+
+    // packets per update: snapshot, flush, rcp_server_update - like async pd
+    {
+        Wire wire;
+
+        rcp_server_transporter transporter;
+        std::memset(&transporter, 0, sizeof(transporter));
+        rcp_server_transporter_setup(&transporter, wire_sendToOne, wire_sendToAll);
+        transporter.user = &wire;
+        rcp_server_add_transporter(server, &transporter);
+
+        UpdateEncoder encoder([&](const char* data, size_t size) {
+            std::lock_guard<std::mutex> guard(wire.lock);
+            wire.packets.push_back(std::string(data, size));
+        });
+        wire.encoder = &encoder;
+
+        // everything exposed so far
+        rcp_server_update(server);
+        {
+            std::lock_guard<std::mutex> guard(wire.lock);
+            wire.packets.clear();
+        }
+
+        for (int n=1; n<=SERVER_UPDATES; n++)
+        {
+            rcp_parameter_set_value_int32(RCP_VALUE_PARAMETER(i), -n);
+            encoder.snapshot(i);
+            encoder.flush();
+            rcp_server_update(server);
+        }
+
+        test::check(countValues(wire, rcp_parameter_get_id(i)) == SERVER_UPDATES,
+                    "one packet per update");
+
+        // not snapshotted - rcp_server_update still sends it
+        rcp_parameter_set_value_float(RCP_VALUE_PARAMETER(f), 2.5f);
+        rcp_server_update(server);
+
+        test::check(countValues(wire, rcp_parameter_get_id(f)) == 1,
+                    "dirty value without snapshot is sent");
+
+        std::printf("%d server updates -> %zu packets\n", SERVER_UPDATES, wire.packets.size());
+
+        wire.encoder = nullptr;
+        rcp_server_remove_transporter(server, &transporter);
+    }
+
+    rcp_server_free(server);
+
+    return 0;
+}
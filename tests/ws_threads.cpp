@@ -0,0 +1,183 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+/*
+ * inbound message throughput over the number of io threads
+ * (websocketServer::set_threads)
+ *
+ * CLIENTS connections send MESSAGES each as fast as they can, the server
+ * counts them in received() (direct mode). the time runs until the last
+ * one arrived. clients run on their own io threads.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// NOTE: needed to figure out ASIO_STANDALONE before including websocketpp
+#include <asio.hpp>
+
+#include <websocketpp/client.hpp>
+
+#include "websocketServer.h"
+#include "TestUtil.h"
+
+using namespace rcp;
+
+typedef websocketpp::client<rcp::config::asio_client> client;
+
+static const int CLIENTS = 8;
+static const int CLIENT_THREADS = 4;
+static const int MESSAGES = 20000;
+static const size_t MESSAGE_SIZE = 256;
+
+class CountingServer : public websocketServer
+{
+public:
+    std::atomic<int> clients{0};
+    std::atomic<int> messages{0};
+
+    void connected(void*) override { clients++; }
+    void disconnected(void*) override { clients--; }
+    void received(char*, size_t, void*) override { messages++; }
+};
+
+static uint16_t freePort()
+{
+    asio::io_service io;
+    asio::ip::tcp::acceptor acceptor(io, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    return acceptor.local_endpoint().port();
+}
+
+static double run(unsigned threads)
+{
+    CountingServer srv;
+    srv.setDirect(true);
+    srv.set_threads(threads);
+
+    uint16_t port = freePort();
+    srv.run(port);
+
+    // the listener comes up on its own thread
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    client cl;
+    cl.init_asio();
+
+    std::vector<websocketpp::connection_hdl> hdls;
+    for (int i=0; i<CLIENTS; i++)
+    {
+        websocketpp::lib::error_code ec;
+        client::connection_ptr con = cl.get_connection("ws://127.0.0.1:" + std::to_string(port), ec);
+        test::check(!ec, "client connection: " + ec.message());
+        cl.connect(con);
+        hdls.push_back(con->get_handle());
+    }
+
+    std::vector<std::thread> client_threads;
+    for (int i=0; i<CLIENT_THREADS; i++)
+    {
+        client_threads.push_back(std::thread([&]() { cl.run(); }));
+    }
+
+    for (int i=0; i<500 && srv.clients < CLIENTS; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    test::check(srv.clients == CLIENTS, "clients did not connect");
+
+    std::string msg(MESSAGE_SIZE, 'x');
+    msg[0] = COMMAND_UPDATEVALUE;
+
+    int64_t start = test::nowUs();
+
+    // one sender per connection
+    std::vector<std::thread> senders;
+    for (int c=0; c<CLIENTS; c++)
+    {
+        senders.push_back(std::thread([&, c]() {
+            websocketpp::lib::error_code ec;
+            for (int i=0; i<MESSAGES; i++)
+            {
+                cl.send(hdls[c], msg.data(), msg.size(), websocketpp::frame::opcode::binary, ec);
+            }
+        }));
+    }
+    for (std::thread& t : senders)
+    {
+        t.join();
+    }
+
+    for (int i=0; i<3000 && srv.messages < CLIENTS * MESSAGES; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    double seconds = (test::nowUs() - start) / 1000000.0;
+
+    test::check(srv.messages == CLIENTS * MESSAGES, "messages lost");
+
+    cl.stop();
+    for (std::thread& t : client_threads)
+    {
+        t.join();
+    }
+    srv.stop();
+
+    return CLIENTS * MESSAGES / seconds;
+}
+
+int main()
+{
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned threads : { 1u, 2u, 4u })
+    {
+        if (threads > 1 &&
+                threads > cores)
+        {
+            break;
+        }
+
+        std::printf("%u io thread(s) %10.0f msg/s\n", threads, run(threads));
+    }
+
+    return 0;
+}
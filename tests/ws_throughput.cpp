@@ -0,0 +1,167 @@
+/*
+********************************************************************
+* rabbitcontrol - a protocol and data-format for remote control.
+*
+* https://rabbitcontrol.cc
+* https://github.com/rabbitcontrol/rcp-flext
+*
+* This file is part of rabbitcontrol for Pd and Max.
+*
+* Written by Ingo Randolf, 2021 - 2022
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, version 3.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*********************************************************************
+*/
+
+/*
+ * message throughput of the websocketpp configs (WebsocketConfig.h)
+ *
+ * built twice from this file: ws_throughput with the lean rcp configs and
+ * ws_throughput_stock with RCP_WEBSOCKET_STOCK_CONFIG.
+ * one connection on loopback, small UPDATEVALUE sized messages are sent
+ * as fast as possible in each direction. the time runs until the last one
+ * arrived.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+// NOTE: needed to figure out ASIO_STANDALONE before including websocketpp
+#include <asio.hpp>
+
+#include <websocketpp/server.hpp>
+#include <websocketpp/client.hpp>
+
+#include "WebsocketConfig.h"
+#include "TestUtil.h"
+
+using namespace rcp;
+
+typedef websocketpp::server<rcp::config::asio> server;
+typedef websocketpp::client<rcp::config::asio_client> client;
+
+#ifdef RCP_WEBSOCKET_STOCK_CONFIG
+static const char* CONFIG = "stock";
+#else
+static const char* CONFIG = "lean";
+#endif
+
+static const int MESSAGES = 200000;
+static const size_t MESSAGE_SIZE = 11;
+
+static void waitFor(std::atomic<int>& counter, int count)
+{
+    for (int i=0; i<3000 && counter < count; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+int main()
+{
+    server srv;
+    client cl;
+
+    std::atomic<bool> open{false};
+    std::atomic<int> server_received{0};
+    std::atomic<int> client_received{0};
+    websocketpp::connection_hdl server_hdl;
+
+    // what the endpoints did before the lean configs - a no-op there
+    srv.clear_access_channels(websocketpp::log::alevel::all);
+    srv.clear_error_channels(websocketpp::log::elevel::all);
+    cl.clear_access_channels(websocketpp::log::alevel::all);
+    cl.clear_error_channels(websocketpp::log::elevel::all);
+
+    srv.init_asio();
+    srv.set_reuse_addr(true);
+    srv.set_open_handler([&](websocketpp::connection_hdl hdl) {
+        server_hdl = hdl;
+        open = true;
+    });
+    srv.set_message_handler([&](websocketpp::connection_hdl, server::message_ptr) {
+        server_received++;
+    });
+    srv.listen(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    srv.start_accept();
+
+    asio::error_code aec;
+    uint16_t port = srv.get_local_endpoint(aec).port();
+    std::thread server_thread([&]() { srv.run(); });
+
+    cl.init_asio();
+    cl.set_message_handler([&](websocketpp::connection_hdl, client::message_ptr) {
+        client_received++;
+    });
+
+    websocketpp::lib::error_code ec;
+    client::connection_ptr con = cl.get_connection("ws://127.0.0.1:" + std::to_string(port), ec);
+    test::check(!ec, "client connection: " + ec.message());
+    cl.connect(con);
+    websocketpp::connection_hdl client_hdl = con->get_handle();
+    std::thread client_thread([&]() { cl.run(); });
+
+    for (int i=0; i<500 && !open; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    test::check(open, "connection did not open");
+
+    std::string msg(MESSAGE_SIZE, '\0');
+    msg[0] = COMMAND_UPDATEVALUE;
+
+    // server to client
+    int64_t start = test::nowUs();
+    for (int i=0; i<MESSAGES; i++)
+    {
+        srv.send(server_hdl, msg.data(), msg.size(), websocketpp::frame::opcode::binary, ec);
+    }
+    waitFor(client_received, MESSAGES);
+    double down = (test::nowUs() - start) / 1000000.0;
+
+    // client to server
+    start = test::nowUs();
+    for (int i=0; i<MESSAGES; i++)
+    {
+        cl.send(client_hdl, msg.data(), msg.size(), websocketpp::frame::opcode::binary, ec);
+    }
+    waitFor(server_received, MESSAGES);
+    double up = (test::nowUs() - start) / 1000000.0;
+
+    cl.stop();
+    srv.stop();
+    client_thread.join();
+    server_thread.join();
+
+    std::printf("%-6s server -> client %10.0f msg/s\n", CONFIG, MESSAGES / down);
+    std::printf("%-6s client -> server %10.0f msg/s\n", CONFIG, MESSAGES / up);
+
+    test::check(client_received == MESSAGES, "messages to the client lost");
+    test::check(server_received == MESSAGES, "messages to the server lost");
+
+    return 0;
+}